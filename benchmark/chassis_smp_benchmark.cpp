@@ -0,0 +1,725 @@
+/**
+ * Benchmark of the multi-chassis SMP aggregator.
+ *
+ * Starts a private dbus-daemon and, for each chassis count, a simulator
+ * process providing N stand-in chassis services along with the inventory,
+ * ObjectMapper and systemd calls the aggregator depends on. A ChassisSMP
+ * in this process is then driven through a scripted power sequence,
+ * measuring for each transition:
+ *  - total_ms:       from the request to the aggregate reaching the state
+ *  - aggregation_ms: from the last chassis signal to the aggregate update
+ *  - calls:          D-Bus calls made by the aggregator, counted by reply
+ *  - signals:        D-Bus signals delivered to the aggregator
+ *  - cpu_ms:         CPU time of this process
+ */
+
+#include "config.h"
+
+#include "chassis_smp_common.hpp"
+#include "chassis_state_manager_smp.hpp"
+
+#include <getopt.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <sdbusplus/bus.hpp>
+#include <sdbusplus/server/interface.hpp>
+#include <sdbusplus/server/manager.hpp>
+#include <sdbusplus/server/object.hpp>
+#include <sdbusplus/vtable.hpp>
+#include <sdeventplus/clock.hpp>
+#include <sdeventplus/event.hpp>
+#include <sdeventplus/utility/timer.hpp>
+#include <xyz/openbmc_project/Inventory/Item/server.hpp>
+#include <xyz/openbmc_project/ObjectMapper/client.hpp>
+#include <xyz/openbmc_project/State/Chassis/server.hpp>
+
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <format>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+namespace phosphor::state::manager::benchmark
+{
+
+using namespace std::chrono_literals;
+using std::chrono::milliseconds;
+using std::chrono::steady_clock;
+
+using ChassisState = sdbusplus::server::xyz::openbmc_project::state::Chassis;
+using ChassisObject = sdbusplus::server::object_t<ChassisState>;
+using InventoryItem = sdbusplus::server::xyz::openbmc_project::inventory::Item;
+using ObjectMapper = sdbusplus::client::xyz::openbmc_project::ObjectMapper<>;
+
+constexpr auto INVENTORY_SERVICE = "xyz.openbmc_project.Inventory.Manager";
+constexpr auto SYSTEMD_SERVICE = "org.freedesktop.systemd1";
+constexpr auto SYSTEMD_OBJ_PATH = "/org/freedesktop/systemd1";
+constexpr auto SYSTEMD_INTERFACE = "org.freedesktop.systemd1.Manager";
+constexpr auto CHASSIS_SERVICE = "xyz.openbmc_project.State.Chassis{}";
+
+/** @brief Longest time for the simulator to start or a transition to end */
+constexpr auto timeout = 30s;
+
+/** @class SimulatedChassis
+ *  @brief Stand-in chassis state object
+ *  @details Moves to the transitioning state as soon as a transition is
+ *  requested and reaches the requested state after a fixed delay.
+ */
+class SimulatedChassis : public ChassisObject
+{
+  public:
+    SimulatedChassis(sdbusplus::bus_t& bus, const sdeventplus::Event& event,
+                     size_t chassisId, milliseconds delay) :
+        ChassisObject(bus,
+                      std::format("{}{}", CHASSIS_STATE_PATH_PREFIX, chassisId)
+                          .c_str(),
+                      ChassisObject::action::defer_emit),
+        delay(delay),
+        timer(event, [this](auto&) { ChassisState::currentPowerState(target); })
+    {
+        ChassisState::currentPowerState(PowerState::Off, true);
+        ChassisState::currentPowerStatus(PowerStatus::Good, true);
+        ChassisState::requestedPowerTransition(Transition::Off, true);
+        emit_object_added();
+    }
+
+    Transition requestedPowerTransition(Transition value) override
+    {
+        if (value == Transition::Off)
+        {
+            target = PowerState::Off;
+            ChassisState::currentPowerState(PowerState::TransitioningToOff);
+        }
+        else
+        {
+            target = PowerState::On;
+            ChassisState::currentPowerState(PowerState::TransitioningToOn);
+        }
+        timer.restartOnce(delay);
+        return ChassisState::requestedPowerTransition(value);
+    }
+
+  private:
+    /** @brief Time to reach the requested state */
+    const milliseconds delay;
+
+    /** @brief The requested state */
+    PowerState target = PowerState::Off;
+
+    /** @brief Reaches the requested state */
+    sdeventplus::utility::Timer<sdeventplus::ClockId::Monotonic> timer;
+};
+
+/** @brief Connection of its own for each chassis, like the real services */
+struct ChassisService
+{
+    ChassisService(const sdeventplus::Event& event, size_t chassisId,
+                   milliseconds delay) :
+        bus(sdbusplus::bus::new_user()), chassis(bus, event, chassisId, delay)
+    {
+        bus.attach_event(event.get(), SD_EVENT_PRIORITY_NORMAL);
+        bus.request_name(std::format(CHASSIS_SERVICE, chassisId).c_str());
+    }
+
+    sdbusplus::bus_t bus;
+    SimulatedChassis chassis;
+};
+
+/** @class Infrastructure
+ *  @brief The inventory, ObjectMapper and systemd calls of the aggregator
+ */
+class Infrastructure
+{
+  public:
+    Infrastructure(const sdeventplus::Event& event, size_t numChassis) :
+        bus(sdbusplus::bus::new_user()), numChassis(numChassis),
+        objManager(bus, INVENTORY_ROOT),
+        mapper(bus, ObjectMapper::instance_path, ObjectMapper::interface,
+               mapperVtable, this),
+        systemd(bus, SYSTEMD_OBJ_PATH, SYSTEMD_INTERFACE, systemdVtable, this)
+    {
+        for (size_t i = 1; i <= numChassis; ++i)
+        {
+            auto path = std::format("{}{}", CHASSIS_INVENTORY_PATH_PREFIX, i);
+            auto& item = items.emplace_back(
+                std::make_unique<sdbusplus::server::object_t<InventoryItem>>(
+                    bus, path.c_str(),
+                    sdbusplus::server::object_t<
+                        InventoryItem>::action::defer_emit));
+            item->present(true, true);
+            item->emit_object_added();
+        }
+
+        bus.attach_event(event.get(), SD_EVENT_PRIORITY_NORMAL);
+        bus.request_name(INVENTORY_SERVICE);
+        bus.request_name(SYSTEMD_SERVICE);
+        // Owned last, the benchmark waits for it
+        bus.request_name(ObjectMapper::default_service);
+    }
+
+  private:
+    /** @brief ObjectMapper GetObject, for the chassis objects */
+    static int getObject(sd_bus_message* m, void* context,
+                         sd_bus_error* error);
+
+    /** @brief ObjectMapper GetSubTree, for the chassis inventory items */
+    static int getSubTree(sd_bus_message* m, void* context,
+                          sd_bus_error* error);
+
+    /** @brief Systemd StartUnit, accepting any unit */
+    static int startUnit(sd_bus_message* m, void* context,
+                         sd_bus_error* error);
+
+    static const sdbusplus::vtable_t mapperVtable[];
+    static const sdbusplus::vtable_t systemdVtable[];
+
+    sdbusplus::bus_t bus;
+    const size_t numChassis;
+    sdbusplus::server::manager_t objManager;
+    sdbusplus::server::interface_t mapper;
+    sdbusplus::server::interface_t systemd;
+    std::vector<std::unique_ptr<sdbusplus::server::object_t<InventoryItem>>>
+        items;
+};
+
+const sdbusplus::vtable_t Infrastructure::mapperVtable[] = {
+    sdbusplus::vtable::start(),
+    sdbusplus::vtable::method("GetObject", "sas", "a{sas}",
+                              Infrastructure::getObject),
+    sdbusplus::vtable::method("GetSubTree", "sias", "a{sa{sas}}",
+                              Infrastructure::getSubTree),
+    sdbusplus::vtable::end()};
+
+const sdbusplus::vtable_t Infrastructure::systemdVtable[] = {
+    sdbusplus::vtable::start(),
+    sdbusplus::vtable::method("StartUnit", "ss", "o",
+                              Infrastructure::startUnit),
+    sdbusplus::vtable::end()};
+
+int Infrastructure::getObject(sd_bus_message* m, void* context,
+                              sd_bus_error* error)
+{
+    const auto* self = static_cast<Infrastructure*>(context);
+    try
+    {
+        sdbusplus::message_t msg{m};
+        auto [path, interfaces] =
+            msg.unpack<std::string, std::vector<std::string>>();
+
+        std::map<std::string, std::vector<std::string>> services;
+        if (chassisIdFromPath(path, CHASSIS_INVENTORY_PATH_PREFIX,
+                              self->numChassis))
+        {
+            services.emplace(
+                INVENTORY_SERVICE,
+                std::vector<std::string>{InventoryItem::interface});
+        }
+        else if (auto chassisId = chassisIdFromPath(
+                     path, CHASSIS_STATE_PATH_PREFIX, self->numChassis))
+        {
+            services.emplace(std::format(CHASSIS_SERVICE, *chassisId),
+                             std::vector<std::string>{ChassisState::interface});
+        }
+        else
+        {
+            return sd_bus_error_set(
+                error, "xyz.openbmc_project.Common.Error.ResourceNotFound",
+                path.c_str());
+        }
+
+        auto reply = msg.new_method_return();
+        reply.append(services);
+        reply.method_return();
+        return 1;
+    }
+    catch (const std::exception& e)
+    {
+        return sd_bus_error_set(error, SD_BUS_ERROR_INVALID_ARGS, e.what());
+    }
+}
+
+int Infrastructure::getSubTree(sd_bus_message* m, void* context,
+                               sd_bus_error* error)
+{
+    const auto* self = static_cast<Infrastructure*>(context);
+    try
+    {
+        sdbusplus::message_t msg{m};
+        auto [subtree, depth, interfaces] =
+            msg.unpack<std::string, int32_t, std::vector<std::string>>();
+
+        std::map<std::string, std::map<std::string, std::vector<std::string>>>
+            objects;
+        if (std::string_view{CHASSIS_INVENTORY_PATH_PREFIX}.starts_with(
+                subtree))
+        {
+            for (size_t i = 1; i <= self->numChassis; ++i)
+            {
+                objects[std::format("{}{}", CHASSIS_INVENTORY_PATH_PREFIX, i)]
+                    .emplace(INVENTORY_SERVICE, std::vector<std::string>{
+                                                    InventoryItem::interface});
+            }
+        }
+
+        auto reply = msg.new_method_return();
+        reply.append(objects);
+        reply.method_return();
+        return 1;
+    }
+    catch (const std::exception& e)
+    {
+        return sd_bus_error_set(error, SD_BUS_ERROR_INVALID_ARGS, e.what());
+    }
+}
+
+int Infrastructure::startUnit(sd_bus_message* m, void*, sd_bus_error* error)
+{
+    try
+    {
+        sdbusplus::message_t msg{m};
+        auto reply = msg.new_method_return();
+        reply.append(sdbusplus::object_path{"/org/freedesktop/systemd1/job/1"});
+        reply.method_return();
+        return 1;
+    }
+    catch (const std::exception& e)
+    {
+        return sd_bus_error_set(error, SD_BUS_ERROR_INVALID_ARGS, e.what());
+    }
+}
+
+/** @brief Run the simulated services until killed */
+int simulate(size_t numChassis, milliseconds delay)
+{
+    auto event = sdeventplus::Event::get_default();
+
+    std::vector<std::unique_ptr<ChassisService>> chassis;
+    for (size_t i = 1; i <= numChassis; ++i)
+    {
+        chassis.emplace_back(
+            std::make_unique<ChassisService>(event, i, delay));
+    }
+    Infrastructure infrastructure{event, numChassis};
+
+    return event.loop();
+}
+
+/** @class MessageCounter
+ *  @brief Counts the messages delivered to a connection
+ */
+class MessageCounter
+{
+  public:
+    explicit MessageCounter(sdbusplus::bus_t& bus)
+    {
+        sd_bus_add_filter(bus.get(), &slot, filter, this);
+    }
+
+    ~MessageCounter()
+    {
+        sd_bus_slot_unref(slot);
+    }
+
+    MessageCounter(const MessageCounter&) = delete;
+    MessageCounter& operator=(const MessageCounter&) = delete;
+
+    void reset()
+    {
+        replies = 0;
+        signals = 0;
+        lastSignal = steady_clock::now();
+    }
+
+    uint64_t replies = 0;
+    uint64_t signals = 0;
+    steady_clock::time_point lastSignal;
+
+  private:
+    static int filter(sd_bus_message* m, void* context, sd_bus_error*)
+    {
+        auto* self = static_cast<MessageCounter*>(context);
+        uint8_t type = 0;
+        sd_bus_message_get_type(m, &type);
+        if (type == SD_BUS_MESSAGE_SIGNAL)
+        {
+            ++self->signals;
+            self->lastSignal = steady_clock::now();
+        }
+        else if ((type == SD_BUS_MESSAGE_METHOD_RETURN) ||
+                 (type == SD_BUS_MESSAGE_METHOD_ERROR))
+        {
+            ++self->replies;
+        }
+        // Let the message be processed as usual
+        return 0;
+    }
+
+    sd_bus_slot* slot = nullptr;
+};
+
+/** @brief Measurements summed over the iterations */
+struct Result
+{
+    size_t runs = 0;
+    double totalMs = 0;
+    double aggregationMs = 0;
+    double calls = 0;
+    double signals = 0;
+    double cpuMs = 0;
+};
+
+double cpuMs()
+{
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    auto ms = [](const timeval& tv) {
+        return (tv.tv_sec * 1000.0) + (tv.tv_usec / 1000.0);
+    };
+    return ms(usage.ru_utime) + ms(usage.ru_stime);
+}
+
+double elapsedMs(steady_clock::time_point from, steady_clock::time_point to)
+{
+    return std::chrono::duration<double, std::milli>(to - from).count();
+}
+
+/** @brief Run the event loop until a condition holds
+ *
+ * @return false if it didn't hold before the timeout
+ */
+bool runUntil(const sdeventplus::Event& event,
+              const std::function<bool()>& done)
+{
+    auto deadline = steady_clock::now() + timeout;
+    while (!done())
+    {
+        auto now = steady_clock::now();
+        if (now >= deadline)
+        {
+            return false;
+        }
+        event.run(std::chrono::duration_cast<std::chrono::microseconds>(
+            deadline - now));
+    }
+    return true;
+}
+
+/** @brief Start a process, returning its PID */
+pid_t spawn(const std::vector<std::string>& args)
+{
+    auto pid = fork();
+    if (pid == 0)
+    {
+        std::vector<char*> argv;
+        for (const auto& arg : args)
+        {
+            argv.push_back(const_cast<char*>(arg.c_str()));
+        }
+        argv.push_back(nullptr);
+        execvp(argv[0], argv.data());
+        _exit(127);
+    }
+    if (pid < 0)
+    {
+        throw std::system_error(errno, std::generic_category(), "fork");
+    }
+    return pid;
+}
+
+void stop(pid_t pid)
+{
+    kill(pid, SIGTERM);
+    waitpid(pid, nullptr, 0);
+}
+
+/** @brief Start the private bus, making it the session bus */
+pid_t startBus()
+{
+    int fds[2];
+    if (pipe(fds) != 0)
+    {
+        throw std::system_error(errno, std::generic_category(), "pipe");
+    }
+
+    auto pid = spawn({"dbus-daemon", "--session", "--nofork",
+                      std::format("--print-address={}", fds[1])});
+    close(fds[1]);
+
+    std::string address;
+    char c = 0;
+    while ((read(fds[0], &c, 1) == 1) && (c != '\n'))
+    {
+        address += c;
+    }
+    close(fds[0]);
+
+    if (address.empty())
+    {
+        stop(pid);
+        throw std::runtime_error("dbus-daemon didn't start");
+    }
+    setenv("DBUS_SESSION_BUS_ADDRESS", address.c_str(), 1);
+    return pid;
+}
+
+bool hasOwner(sdbusplus::bus_t& bus, const std::string& name)
+{
+    auto method = bus.new_method_call("org.freedesktop.DBus",
+                                      "/org/freedesktop/DBus",
+                                      "org.freedesktop.DBus", "NameHasOwner");
+    method.append(name);
+    return bus.call(method).unpack<bool>();
+}
+
+/** @brief Benchmark the aggregation of a number of chassis
+ *
+ * @param[in] numChassis - Number of simulated chassis
+ * @param[in] delay      - Time a chassis takes to reach a state
+ * @param[in] iterations - Number of runs of the sequence
+ * @param[in] sequence   - The transitions of the sequence
+ *
+ * @return The startup and per transition results, by name
+ */
+std::map<std::string, Result> benchmark(
+    size_t numChassis, milliseconds delay, size_t iterations,
+    const std::vector<ChassisState::Transition>& sequence)
+{
+    auto simulator =
+        spawn({"/proc/self/exe", "--simulate", std::to_string(numChassis),
+               "--chassis-delay-ms", std::to_string(delay.count())});
+
+    std::map<std::string, Result> results;
+    try
+    {
+        auto event = sdeventplus::Event::get_default();
+        auto bus = sdbusplus::bus::new_user();
+        bus.attach_event(event.get(), SD_EVENT_PRIORITY_NORMAL);
+
+        auto deadline = steady_clock::now() + timeout;
+        while (!hasOwner(bus, ObjectMapper::default_service))
+        {
+            if (steady_clock::now() >= deadline)
+            {
+                throw std::runtime_error("Simulator didn't start");
+            }
+            std::this_thread::sleep_for(10ms);
+        }
+
+        MessageCounter counter{bus};
+        counter.reset();
+        auto cpuStart = cpuMs();
+        auto start = steady_clock::now();
+
+        ChassisSMP smp{bus,
+                       sdbusplus::object_path{
+                           std::format("{}0", CHASSIS_STATE_PATH_PREFIX)},
+                       numChassis};
+
+        auto& startup = results["startup"];
+        startup.runs = 1;
+        startup.totalMs = elapsedMs(start, steady_clock::now());
+        startup.calls = counter.replies;
+        startup.cpuMs = cpuMs() - cpuStart;
+
+        for (size_t i = 0; i < iterations; ++i)
+        {
+            for (auto transition : sequence)
+            {
+                auto target = (transition == ChassisState::Transition::Off)
+                                  ? ChassisState::PowerState::Off
+                                  : ChassisState::PowerState::On;
+
+                counter.reset();
+                cpuStart = cpuMs();
+                start = steady_clock::now();
+
+                smp.requestedPowerTransition(transition);
+                if (!runUntil(event, [&smp, target]() {
+                        return smp.ChassisInherit::currentPowerState() ==
+                               target;
+                    }))
+                {
+                    throw std::runtime_error(std::format(
+                        "Transition to {} timed out",
+                        ChassisState::convertTransitionToString(transition)));
+                }
+
+                auto end = steady_clock::now();
+                auto& result = results[ChassisState::convertTransitionToString(
+                    transition)];
+                ++result.runs;
+                result.totalMs += elapsedMs(start, end);
+                result.aggregationMs += elapsedMs(counter.lastSignal, end);
+                result.calls += counter.replies;
+                result.signals += counter.signals;
+                result.cpuMs += cpuMs() - cpuStart;
+            }
+        }
+    }
+    catch (...)
+    {
+        stop(simulator);
+        throw;
+    }
+
+    stop(simulator);
+    return results;
+}
+
+std::vector<size_t> parseList(const std::string& list)
+{
+    std::vector<size_t> values;
+    std::istringstream stream{list};
+    std::string value;
+    while (std::getline(stream, value, ','))
+    {
+        values.push_back(std::stoul(value));
+    }
+    return values;
+}
+
+std::vector<ChassisState::Transition> parseSequence(const std::string& list)
+{
+    std::vector<ChassisState::Transition> sequence;
+    std::istringstream stream{list};
+    std::string value;
+    while (std::getline(stream, value, ','))
+    {
+        if (value == "on")
+        {
+            sequence.push_back(ChassisState::Transition::On);
+        }
+        else if (value == "off")
+        {
+            sequence.push_back(ChassisState::Transition::Off);
+        }
+        else
+        {
+            throw std::invalid_argument("Unknown transition " + value);
+        }
+    }
+    return sequence;
+}
+
+} // namespace phosphor::state::manager::benchmark
+
+int main(int argc, char** argv)
+{
+    using namespace phosphor::state::manager;
+    using namespace phosphor::state::manager::benchmark;
+
+    std::string chassisCounts = "2,4,8,16,32,64";
+    std::string sequenceList = "on,off";
+    size_t iterations = 5;
+    milliseconds delay{10};
+    std::optional<size_t> simulateChassis;
+
+    int arg;
+    int optIndex = 0;
+    static struct option longOpts[] = {
+        {"chassis", required_argument, nullptr, 'n'},
+        {"sequence", required_argument, nullptr, 's'},
+        {"iterations", required_argument, nullptr, 'i'},
+        {"chassis-delay-ms", required_argument, nullptr, 'd'},
+        {"simulate", required_argument, nullptr, 'S'},
+        {nullptr, 0, nullptr, 0}};
+
+    try
+    {
+        while ((arg = getopt_long(argc, argv, "n:s:i:d:S:", longOpts,
+                                  &optIndex)) != -1)
+        {
+            switch (arg)
+            {
+                case 'n':
+                    chassisCounts = optarg;
+                    break;
+                case 's':
+                    sequenceList = optarg;
+                    break;
+                case 'i':
+                    iterations = std::stoul(optarg);
+                    break;
+                case 'd':
+                    delay = milliseconds{std::stoul(optarg)};
+                    break;
+                case 'S':
+                    simulateChassis = std::stoul(optarg);
+                    break;
+                default:
+                    return EXIT_FAILURE;
+            }
+        }
+
+        if (simulateChassis)
+        {
+            return simulate(*simulateChassis, delay);
+        }
+
+        auto sequence = parseSequence(sequenceList);
+        auto bus = startBus();
+
+        std::cout << std::format("{:>7} {:>10} {:>5} {:>10} {:>14} {:>8} "
+                                 "{:>8} {:>8}\n",
+                                 "chassis", "transition", "runs", "total_ms",
+                                 "aggregation_ms", "calls", "signals",
+                                 "cpu_ms");
+
+        int status = EXIT_SUCCESS;
+        for (auto numChassis : parseList(chassisCounts))
+        {
+            if ((numChassis == 0) || (numChassis > smpMaxChassis))
+            {
+                std::cerr << std::format(
+                    "Skipping {} chassis, the build supports 1-{}, see "
+                    "num-chassis-smp\n",
+                    numChassis, smpMaxChassis);
+                continue;
+            }
+
+            try
+            {
+                auto results =
+                    benchmark(numChassis, delay, iterations, sequence);
+                for (const auto& [name, result] : results)
+                {
+                    auto runs = static_cast<double>(result.runs);
+                    std::cout << std::format(
+                        "{:>7} {:>10} {:>5} {:>10.2f} {:>14.2f} {:>8.1f} "
+                        "{:>8.1f} {:>8.2f}\n",
+                        numChassis, name.substr(name.rfind('.') + 1),
+                        result.runs, result.totalMs / runs,
+                        result.aggregationMs / runs, result.calls / runs,
+                        result.signals / runs, result.cpuMs / runs);
+                }
+            }
+            catch (const std::exception& e)
+            {
+                std::cerr << std::format("{} chassis failed: {}\n",
+                                         numChassis, e.what());
+                status = EXIT_FAILURE;
+            }
+        }
+
+        stop(bus);
+        return status;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+}
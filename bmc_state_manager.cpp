@@ -4,8 +4,6 @@
 
 #include "utils.hpp"
 
-#include <gpiod.h>
-
 #include <phosphor-logging/commit.hpp>
 #include <phosphor-logging/elog-errors.hpp>
 #include <phosphor-logging/lg2.hpp>
@@ -62,57 +60,14 @@ void BMC::bmcIsQuiesced()
     this->stateSignal.reset();
 }
 
-std::string BMC::getUnitState(const std::string& unitToCheck)
-{
-    std::variant<std::string> currentState;
-    sdbusplus::object_path unitTargetPath;
-
-    auto method =
-        this->bus.new_method_call(SYSTEMD_SERVICE, SYSTEMD_OBJ_PATH,
-                                  SYSTEMD_MANAGER_INTERFACE, "GetUnit");
-
-    method.append(unitToCheck);
-
-    try
-    {
-        auto result = this->bus.call(method);
-        result.read(unitTargetPath);
-    }
-    catch (const sdbusplus::exception_t& e)
-    {
-        // Not all input units will have been loaded yet so just return an
-        // empty string if an exception is caught in this path
-        debug("Unit {UNIT} not found: {ERROR}", "UNIT", unitToCheck, "ERROR",
-              e);
-        return std::string{};
-    }
-
-    method = this->bus.new_method_call(
-        SYSTEMD_SERVICE,
-        static_cast<const std::string&>(unitTargetPath).c_str(),
-        PROPERTY_INTERFACE, "Get");
-
-    method.append(SYSTEMD_UNIT_INTERFACE, "ActiveState");
-
-    try
-    {
-        auto result = this->bus.call(method);
-
-        // Is input target active or inactive?
-        result.read(currentState);
-    }
-    catch (const sdbusplus::exception_t& e)
-    {
-        info("Error in ActiveState Get: {ERROR}", "ERROR", e);
-        return std::string{};
-    }
-    return (std::get<std::string>(currentState));
-}
-
 void BMC::discoverInitialState()
 {
+    // Only have the bus deliver job signals for the BMC state targets
+    stateSignal->watch(obmcQuiesceTarget);
+    stateSignal->watch(obmcStandbyTarget);
+
     // First look to see if the BMC quiesce target is active
-    auto currentStateStr = getUnitState(obmcQuiesceTarget);
+    auto currentStateStr = unitStates.activeState(obmcQuiesceTarget);
     if (currentStateStr == activeState)
     {
         info("Setting the BMCState field to BMC_QUIESCED");
@@ -121,7 +76,7 @@ void BMC::discoverInitialState()
     }
 
     // If not quiesced, then check standby target
-    currentStateStr = getUnitState(obmcStandbyTarget);
+    currentStateStr = unitStates.activeState(obmcStandbyTarget);
     if (currentStateStr == activeState)
     {
         info("Setting the BMCState field to BMC_READY");
@@ -204,7 +159,7 @@ void BMC::executeTransition(const Transition tranReq)
     return;
 }
 
-int BMC::bmcStateChange(sdbusplus::message_t& msg)
+bool BMC::bmcStateChange(sdbusplus::message_t& msg)
 {
     uint32_t newStateID{};
     sdbusplus::object_path newStateObjPath;
@@ -215,22 +170,23 @@ int BMC::bmcStateChange(sdbusplus::message_t& msg)
     msg.read(newStateID, newStateObjPath, newStateUnit, newStateResult);
 
     if ((newStateUnit == obmcQuiesceTarget) && (newStateResult == signalDone) &&
-        (getUnitState(newStateUnit) == activeState))
+        (unitStates.activeState(newStateUnit) == activeState))
     {
         error("BMC has entered BMC_QUIESCED state");
         bmcIsQuiesced();
-        return 0;
+        return true;
     }
 
     // Caught the signal that indicates the BMC is now BMC_READY
     if ((newStateUnit == obmcStandbyTarget) && (newStateResult == signalDone) &&
-        (getUnitState(newStateUnit) == activeState))
+        (unitStates.activeState(newStateUnit) == activeState))
     {
         info("BMC_READY");
         this->currentBMCState(BMCState::Ready);
+        return true;
     }
 
-    return 0;
+    return false;
 }
 
 BMC::Transition BMC::requestedBMCTransition(Transition value)
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "statistics.hpp"
 #include "utils.hpp"
 #include "xyz/openbmc_project/State/BMC/server.hpp"
 
@@ -34,12 +35,10 @@ class BMC : public BMCInherit
      */
     BMC(sdbusplus::bus_t& bus, const sdbusplus::object_path& objPath) :
         BMCInherit(bus, objPath, BMCInherit::action::defer_emit), bus(bus),
+        unitStates(bus),
         stateSignal(std::make_unique<decltype(stateSignal)::element_type>(
-            bus,
-            sdbusRule::type::signal() + sdbusRule::member("JobRemoved") +
-                sdbusRule::path(SYSTEMD_OBJ_PATH) +
-                sdbusRule::interface(SYSTEMD_MANAGER_INTERFACE),
-            [this](sdbusplus::message_t& m) { bmcStateChange(m); })),
+            bus, "JobRemoved",
+            [this](sdbusplus::message_t& m) { return bmcStateChange(m); })),
 
         timeSyncSignal(std::make_unique<decltype(timeSyncSignal)::element_type>(
             bus,
@@ -65,9 +64,17 @@ class BMC : public BMCInherit
             }))
     {
         utils::subscribeToSystemdSignals(bus);
-        discoverInitialState();
-        discoverLastRebootCause();
-        updateLastRebootTime();
+
+        auto& startup = utils::StartupTimer::instance();
+        {
+            auto phase = startup.phase("initial_state");
+            discoverInitialState();
+        }
+        {
+            auto phase = startup.phase("reboot_cause");
+            discoverLastRebootCause();
+            updateLastRebootTime();
+        }
 
         this->emit_object_added();
     };
@@ -97,10 +104,6 @@ class BMC : public BMCInherit
      **/
     void bmcIsQuiesced();
 
-    /**
-     * @brief Retrieve input systemd unit state
-     **/
-    std::string getUnitState(const std::string& unitToCheck);
     /**
      * @brief discover the state of the bmc
      **/
@@ -119,14 +122,18 @@ class BMC : public BMCInherit
      *
      * @param[in]  msg       - Data associated with subscribed signal
      *
+     * @return true if the BMC state was updated
      */
-    int bmcStateChange(sdbusplus::message_t& msg);
+    bool bmcStateChange(sdbusplus::message_t& msg);
 
     /** @brief Persistent sdbusplus DBus bus connection. **/
     sdbusplus::bus_t& bus;
 
+    /** @brief ActiveState of the systemd targets this object watches **/
+    utils::UnitStateCache unitStates;
+
     /** @brief Used to subscribe to dbus system state changes **/
-    std::unique_ptr<sdbusplus::match> stateSignal;
+    std::unique_ptr<utils::SystemdJobSignals> stateSignal;
 
     /** @brief Used to subscribe to timesync **/
     std::unique_ptr<sdbusplus::match> timeSyncSignal;
@@ -1,6 +1,7 @@
 #include "config.h"
 
 #include "bmc_state_manager.hpp"
+#include "statistics.hpp"
 
 #include <sdbusplus/bus.hpp>
 
@@ -8,6 +9,9 @@ using BMCState = sdbusplus::server::xyz::openbmc_project::state::BMC;
 
 int main()
 {
+    // Start-up timing is relative to this
+    phosphor::state::manager::utils::StartupTimer::instance();
+
     auto bus = sdbusplus::bus::new_default();
 
     // For now, we only have one instance of the BMC
@@ -22,6 +26,8 @@ int main()
     phosphor::state::manager::BMC manager(bus, objPathInst);
 
     bus.request_name(BMCState::interface);
+    auto startupStatistics =
+        phosphor::state::manager::utils::publishStartup(bus, objPathInst.str);
 
     while (true)
     {
@@ -0,0 +1,45 @@
+#include "chassis_smp_coalescer.hpp"
+
+#include <systemd/sd-event.h>
+
+#include <utility>
+
+namespace phosphor::state::manager
+{
+
+ChangeCoalescer::ChangeCoalescer(const sdeventplus::Event& event,
+                                 std::chrono::milliseconds delay,
+                                 Callback callback) :
+    delay(delay), callback(std::move(callback)),
+    idle(event, [this](auto&) { run(); }),
+    timer(event, [this](auto&) { run(); })
+{
+    // Below the bus and every other source, so the messages already queued
+    // are all handled before the callback runs
+    idle.set_priority(SD_EVENT_PRIORITY_IDLE);
+    idle.set_enabled(sdeventplus::source::Enabled::Off);
+}
+
+void ChangeCoalescer::changed()
+{
+    ++changes;
+
+    if (delay.count() == 0)
+    {
+        idle.set_enabled(sdeventplus::source::Enabled::OneShot);
+        return;
+    }
+
+    // The delay starts at the first change of the burst
+    if (!timer.isEnabled())
+    {
+        timer.restartOnce(delay);
+    }
+}
+
+void ChangeCoalescer::run()
+{
+    callback(std::exchange(changes, 0));
+}
+
+} // namespace phosphor::state::manager
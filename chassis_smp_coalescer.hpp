@@ -0,0 +1,74 @@
+#pragma once
+
+#include <sdeventplus/clock.hpp>
+#include <sdeventplus/event.hpp>
+#include <sdeventplus/source/event.hpp>
+#include <sdeventplus/utility/timer.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+
+namespace phosphor::state::manager
+{
+
+/** @class ChangeCoalescer
+ *  @brief Runs a callback once for a burst of changes
+ *  @details Without a delay the callback runs from an idle priority defer
+ *  source, so only once the event loop has nothing else to dispatch, such
+ *  as the bus messages already queued. With a delay it runs when the delay
+ *  from the first change of the burst expires, so a steady stream of
+ *  changes can't hold it off forever.
+ */
+class ChangeCoalescer
+{
+  public:
+    /** @brief Called with the number of changes of the burst */
+    using Callback = std::function<void(size_t)>;
+
+    ChangeCoalescer() = delete;
+    ChangeCoalescer(const ChangeCoalescer&) = delete;
+    ChangeCoalescer& operator=(const ChangeCoalescer&) = delete;
+    ChangeCoalescer(ChangeCoalescer&&) = delete;
+    ChangeCoalescer& operator=(ChangeCoalescer&&) = delete;
+    ~ChangeCoalescer() = default;
+
+    /** @brief Constructs the coalescer, idle until the first change
+     *
+     * @param[in] event    - The event loop running the callback
+     * @param[in] delay    - Longest time to collect changes, 0 for none
+     * @param[in] callback - Called once for each burst of changes
+     */
+    ChangeCoalescer(const sdeventplus::Event& event,
+                    std::chrono::milliseconds delay, Callback callback);
+
+    /** @brief Record a change, scheduling the callback if needed */
+    void changed();
+
+    /** @brief Changes recorded since the callback last ran */
+    size_t pending() const
+    {
+        return changes;
+    }
+
+  private:
+    /** @brief Run the callback with the changes collected */
+    void run();
+
+    /** @brief Longest time to collect changes */
+    const std::chrono::milliseconds delay;
+
+    /** @brief Called once for each burst of changes */
+    Callback callback;
+
+    /** @brief Changes recorded since the callback last ran */
+    size_t changes = 0;
+
+    /** @brief Runs the callback once the event loop is idle */
+    sdeventplus::source::Defer idle;
+
+    /** @brief Runs the callback after the delay */
+    sdeventplus::utility::Timer<sdeventplus::ClockId::Monotonic> timer;
+};
+
+} // namespace phosphor::state::manager
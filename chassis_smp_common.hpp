@@ -0,0 +1,237 @@
+#pragma once
+
+#include "config.h"
+
+#include <algorithm>
+#include <array>
+#include <bitset>
+#include <charconv>
+#include <cstddef>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace phosphor::state::manager
+{
+
+/** @brief Chassis slots in the SMP tables, chassis IDs run from 1 to this.
+ *  At least 1 so the tables stay valid when SMP support is disabled.
+ */
+constexpr size_t smpMaxChassis = (NUM_CHASSIS_SMP > 0) ? NUM_CHASSIS_SMP : 1;
+
+/** @brief Namespace of the chassis state objects */
+constexpr auto CHASSIS_STATE_NAMESPACE = "/xyz/openbmc_project/state";
+
+/** @brief Path of a chassis state object, without its chassis ID */
+constexpr auto CHASSIS_STATE_PATH_PREFIX = "/xyz/openbmc_project/state/chassis";
+
+/** @brief Path of the aggregator of an SMP partition, without its host ID */
+constexpr auto PARTITION_STATE_PATH_PREFIX =
+    "/xyz/openbmc_project/state/partition";
+
+/** @brief Root of the inventory, where its services' ObjectManager is */
+constexpr auto INVENTORY_ROOT = "/xyz/openbmc_project/inventory";
+
+/** @brief Namespace of the chassis inventory items */
+constexpr auto CHASSIS_INVENTORY_NAMESPACE =
+    "/xyz/openbmc_project/inventory/system";
+
+/** @brief Path of a chassis inventory item, without its chassis ID */
+constexpr auto CHASSIS_INVENTORY_PATH_PREFIX =
+    "/xyz/openbmc_project/inventory/system/chassis";
+
+/** @brief Decode the chassis ID at the end of an object path
+ *
+ * Lets a single namespace wide match serve every chassis.
+ *
+ * @param[in] path       - The object path, such as from a signal
+ * @param[in] prefix     - The path without the chassis ID
+ * @param[in] numChassis - Highest chassis ID accepted
+ *
+ * @return The chassis ID, std::nullopt if the path isn't the prefix
+ *         followed by a chassis ID from 1 to numChassis
+ */
+inline std::optional<size_t> chassisIdFromPath(
+    std::string_view path, std::string_view prefix, size_t numChassis)
+{
+    if (!path.starts_with(prefix))
+    {
+        return std::nullopt;
+    }
+
+    auto digits = path.substr(prefix.size());
+    size_t chassisId = 0;
+    auto [end, ec] = std::from_chars(digits.data(),
+                                     digits.data() + digits.size(), chassisId);
+    if ((ec != std::errc{}) || (end != digits.data() + digits.size()) ||
+        digits.starts_with('0') || (chassisId > numChassis))
+    {
+        return std::nullopt;
+    }
+    return chassisId;
+}
+
+/** @brief Set of chassis IDs, bit N is chassis N and bit 0 is unused */
+template <size_t Capacity = smpMaxChassis>
+using ChassisSet = std::bitset<Capacity + 1>;
+
+/** @brief Check a chassis ID fits a table
+ *
+ * @param[in] chassisId - The chassis ID
+ * @param[in] capacity  - Highest chassis ID of the table
+ *
+ * @throw std::out_of_range if the ID is 0 or above the capacity
+ */
+inline void checkChassisId(size_t chassisId, size_t capacity)
+{
+    if ((chassisId == 0) || (chassisId > capacity))
+    {
+        throw std::out_of_range("Chassis ID " + std::to_string(chassisId) +
+                                " outside 1-" + std::to_string(capacity));
+    }
+}
+
+/** @brief The set of chassis IDs 1 to numChassis
+ *
+ * @param[in] numChassis - Number of chassis, up to Capacity
+ */
+template <size_t Capacity = smpMaxChassis>
+ChassisSet<Capacity> chassisRange(size_t numChassis)
+{
+    ChassisSet<Capacity> range;
+    for (size_t i = 1; i <= numChassis; ++i)
+    {
+        range.set(i);
+    }
+    return range;
+}
+
+/** @brief Call a function for each chassis ID of a set
+ *
+ * Stops after the highest chassis of the set, so the cost follows the
+ * chassis actually in the set rather than its capacity.
+ *
+ * @param[in] chassis - The set of chassis
+ * @param[in] func    - Called with each chassis ID, in ascending order
+ */
+template <size_t Bits, typename Func>
+void forEachChassis(const std::bitset<Bits>& chassis, Func&& func)
+{
+    // Bit 0 is no chassis, so it isn't visited
+    auto remaining = chassis.count() - (chassis.test(0) ? 1 : 0);
+    for (size_t i = 1; (i < Bits) && (remaining != 0); ++i)
+    {
+        if (chassis.test(i))
+        {
+            --remaining;
+            func(i);
+        }
+    }
+}
+
+/** @brief List the chassis IDs of a set, for logs
+ *
+ * @param[in] chassis - The set of chassis
+ *
+ * @return The chassis IDs in ascending order separated by commas, such as
+ *         "1,3", empty if the set is
+ */
+template <size_t Bits>
+std::string chassisIdList(const std::bitset<Bits>& chassis)
+{
+    std::string list;
+    forEachChassis(chassis, [&list](size_t i) {
+        list += (list.empty() ? "" : ",") + std::to_string(i);
+    });
+    return list;
+}
+
+/** @brief Room a ChassisStateTable needs for the given enum values
+ *
+ *  @tparam Values - Every value of the enum
+ */
+template <auto... Values>
+constexpr size_t enumValueRoom =
+    std::max({static_cast<size_t>(Values)...}) + 1;
+
+/** @class ChassisStateTable
+ *  @brief Fixed capacity table of an enum value per chassis
+ *  @details Values are kept in a contiguous array indexed by chassis ID,
+ *  along with one ChassisSet per enum value. Questions such as "is any
+ *  present chassis in this state" are then a single bitset operation.
+ *
+ *  @tparam Value     - Enum stored, with values from 0 to NumValues - 1
+ *  @tparam NumValues - Room for the values of the enum
+ *  @tparam Capacity  - Highest chassis ID
+ */
+template <typename Value, size_t NumValues, size_t Capacity = smpMaxChassis>
+class ChassisStateTable
+{
+  public:
+    using Set = ChassisSet<Capacity>;
+
+    /** @brief Constructs the table with every chassis at a value
+     *
+     * @param[in] initial - The value of every chassis
+     */
+    explicit ChassisStateTable(Value initial)
+    {
+        values.fill(initial);
+        sets[index(initial)] = chassisRange<Capacity>(Capacity);
+    }
+
+    /** @brief Value of a chassis
+     *
+     * @param[in] chassisId - ID of the chassis, 1 to Capacity
+     */
+    Value get(size_t chassisId) const
+    {
+        checkChassisId(chassisId, Capacity);
+        return values[chassisId];
+    }
+
+    /** @brief Set the value of a chassis
+     *
+     * @param[in] chassisId - ID of the chassis, 1 to Capacity
+     * @param[in] value     - Its value
+     */
+    void set(size_t chassisId, Value value)
+    {
+        checkChassisId(chassisId, Capacity);
+        auto newIndex = index(value);
+        sets[index(values[chassisId])].reset(chassisId);
+        sets[newIndex].set(chassisId);
+        values[chassisId] = value;
+    }
+
+    /** @brief The chassis that have a value
+     *
+     * @param[in] value - The value
+     */
+    const Set& with(Value value) const
+    {
+        return sets[index(value)];
+    }
+
+  private:
+    /** @brief Index of a value in sets */
+    static size_t index(Value value)
+    {
+        auto i = static_cast<size_t>(value);
+        if (i >= NumValues)
+        {
+            throw std::out_of_range("Value " + std::to_string(i) +
+                                    " outside the state table");
+        }
+        return i;
+    }
+
+    /** @brief Value of each chassis, by chassis ID */
+    std::array<Value, Capacity + 1> values{};
+
+    /** @brief Chassis having each value, by value */
+    std::array<Set, NumValues> sets{};
+};
+
+} // namespace phosphor::state::manager
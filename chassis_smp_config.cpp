@@ -0,0 +1,180 @@
+#include "chassis_smp_config.hpp"
+
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+namespace phosphor::state::manager
+{
+
+SMPConfig::SMPConfig(const nlohmann::json& data, size_t maxChassis) :
+    maxChassis(maxChassis)
+{
+    if (maxChassis > smpMaxChassis)
+    {
+        throw std::invalid_argument(std::format(
+            "SMP config supports at most {} chassis", smpMaxChassis));
+    }
+
+    // Group of each chassis that is in a group, loops only go through groups
+    std::array<size_t, smpMaxChassis + 1> parent{};
+
+    // The aggregator of each chassis in a group or partition, for errors
+    std::array<std::string, smpMaxChassis + 1> owner{};
+
+    auto addMembers = [this, &owner](const std::string& name,
+                                     size_t aggregatorId,
+                                     const nlohmann::json& entry) {
+        ChassisSet<> added;
+        for (auto memberId : entry.at("members").get<std::vector<size_t>>())
+        {
+            if ((memberId == 0) || (memberId > this->maxChassis) ||
+                (memberId == aggregatorId))
+            {
+                throw std::invalid_argument(std::format(
+                    "SMP {} has invalid member {}", name, memberId));
+            }
+            if (grouped.test(memberId))
+            {
+                throw std::invalid_argument(
+                    std::format("Chassis {} is a member of SMP {} and {}",
+                                memberId, owner[memberId], name));
+            }
+            grouped.set(memberId);
+            added.set(memberId);
+            owner[memberId] = name;
+        }
+        return added;
+    };
+
+    for (const auto& group : data.value("groups", nlohmann::json::array()))
+    {
+        auto groupId = group.at("chassis").get<size_t>();
+        if ((groupId == 0) || (groupId > maxChassis))
+        {
+            throw std::invalid_argument(
+                std::format("SMP group chassis {} outside 1-{}", groupId,
+                            maxChassis));
+        }
+        if (isGroup(groupId))
+        {
+            throw std::invalid_argument(
+                std::format("SMP group {} defined twice", groupId));
+        }
+        groups.set(groupId);
+
+        members[groupId] =
+            addMembers(std::format("group {}", groupId), groupId, group);
+        forEachChassis(members[groupId],
+                       [&parent, groupId](size_t id) { parent[id] = groupId; });
+    }
+
+    for (const auto& partition :
+         data.value("partitions", nlohmann::json::array()))
+    {
+        // The aggregator is keyed by host, not by one of the chassis
+        if (partition.contains("chassis"))
+        {
+            throw std::invalid_argument(
+                "SMP partitions are keyed by host, they have no chassis");
+        }
+
+        auto hostId = partition.at("host").get<size_t>();
+        if (hasPartition(hostId))
+        {
+            throw std::invalid_argument(
+                std::format("Host {} has two SMP partitions", hostId));
+        }
+
+        auto partitionMembers =
+            addMembers(std::format("partition {}", hostId), 0, partition);
+        if (partitionMembers.none())
+        {
+            throw std::invalid_argument(
+                std::format("SMP partition {} has no members", hostId));
+        }
+        partitions.emplace(hostId, partitionMembers);
+    }
+
+    // Every chassis has at most one parent, so a loop shows as a walk up
+    // from a group that doesn't reach the top within the number of groups.
+    forEachChassis(groups, [this, &parent](size_t groupId) {
+        auto id = groupId;
+        for (size_t steps = 0; parent[id] != 0; ++steps)
+        {
+            if (steps == groups.count())
+            {
+                throw std::invalid_argument(
+                    std::format("SMP group {} is part of a loop", groupId));
+            }
+            id = parent[id];
+        }
+    });
+}
+
+ChassisSet<> SMPConfig::membersOf(const SMPAggregator& aggregator) const
+{
+    if (aggregator.isPartition())
+    {
+        auto partition = partitions.find(aggregator.id);
+        return (partition != partitions.end()) ? partition->second
+                                               : ChassisSet<>{};
+    }
+    if (aggregator.id == 0)
+    {
+        // Everything that isn't in a group or partition
+        return chassisRange(maxChassis) & ~grouped;
+    }
+    if (!isGroup(aggregator.id))
+    {
+        return {};
+    }
+    return members[aggregator.id];
+}
+
+ChassisSet<> SMPConfig::leavesOf(const SMPAggregator& aggregator) const
+{
+    return membersOf(aggregator) & ~groups;
+}
+
+ChassisSet<> SMPConfig::subGroupsOf(const SMPAggregator& aggregator) const
+{
+    return membersOf(aggregator) & groups;
+}
+
+ChassisSet<> SMPConfig::chassisOf(const SMPAggregator& aggregator) const
+{
+    auto chassis = leavesOf(aggregator);
+    forEachChassis(subGroupsOf(aggregator), [this, &chassis](size_t id) {
+        chassis |= chassisOf(id);
+    });
+    return chassis;
+}
+
+ChassisSet<> SMPConfig::chassisOfHost(size_t hostId) const
+{
+    if (hasPartition(hostId))
+    {
+        return chassisOf(SMPAggregator::partition(hostId));
+    }
+    if (hostId == 0)
+    {
+        return chassisOf(0);
+    }
+    return {};
+}
+
+SMPConfig loadSMPConfig(const std::string& path, size_t maxChassis)
+{
+    if (!std::filesystem::exists(path))
+    {
+        return {};
+    }
+
+    std::ifstream file{path};
+    return {nlohmann::json::parse(file), maxChassis};
+}
+
+} // namespace phosphor::state::manager
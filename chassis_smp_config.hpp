@@ -0,0 +1,186 @@
+#pragma once
+
+#include "chassis_smp_common.hpp"
+
+#include <nlohmann/json.hpp>
+
+#include <array>
+#include <cstddef>
+#include <map>
+#include <string>
+
+namespace phosphor::state::manager
+{
+
+/** @brief An SMP aggregator
+ *  @details Chassis 0 and the groups are keyed by chassis ID, the aggregator
+ *  of the partition of a host by host ID. A chassis ID converts to the
+ *  aggregator of that chassis.
+ */
+struct SMPAggregator
+{
+    /** @brief The ID space of an aggregator */
+    enum class Kind
+    {
+        Chassis,
+        Partition
+    };
+
+    constexpr SMPAggregator(size_t chassisId = 0) : id(chassisId) {}
+
+    /** @brief The aggregator of the partition of a host
+     *
+     * @param[in] hostId - The host ID
+     */
+    static constexpr SMPAggregator partition(size_t hostId)
+    {
+        SMPAggregator aggregator{hostId};
+        aggregator.kind = Kind::Partition;
+        return aggregator;
+    }
+
+    /** @brief Whether this is the aggregator of a partition */
+    constexpr bool isPartition() const
+    {
+        return kind == Kind::Partition;
+    }
+
+    /** @brief The ID space of id */
+    Kind kind = Kind::Chassis;
+
+    /** @brief Chassis ID, or host ID of a partition */
+    size_t id = 0;
+};
+
+/** @class SMPConfig
+ *  @brief Arrangement of the SMP aggregators
+ *  @details Without groups chassis 0 aggregates every chassis directly.
+ *  A group is an intermediate aggregator, a chassis instance that publishes
+ *  the aggregate of its members. Chassis 0 then aggregates the top level
+ *  groups and the chassis that aren't in any group, so the signals reaching
+ *  each aggregator are bounded by the size of its group. Groups take their
+ *  IDs from the chassis IDs, so num-chassis-smp has to cover the physical
+ *  chassis and the groups.
+ *
+ *  A partition is a set of chassis and groups that runs a host of its own.
+ *  It isn't aggregated by chassis 0, so each partition powers on and off
+ *  independently. Partitions are keyed by host ID, separately from the
+ *  chassis IDs: the partition of host N is aggregated by partition N, with
+ *  targets of its own, whichever chassis it is made of.
+ *
+ *  The groups and partitions come from a JSON file such as:
+ *  @code
+ *  {
+ *      "groups": [
+ *          { "chassis": 13, "members": [1, 2, 3, 4] },
+ *          { "chassis": 14, "members": [5, 6, 7, 8] }
+ *      ],
+ *      "partitions": [
+ *          { "host": 0, "members": [13, 14] },
+ *          { "host": 1, "members": [9, 10, 11, 12] }
+ *      ]
+ *  }
+ *  @endcode
+ */
+class SMPConfig
+{
+  public:
+    /** @brief Constructs the flat arrangement, without groups */
+    SMPConfig() = default;
+
+    /** @brief Constructs the arrangement from its JSON description
+     *
+     * @param[in] data       - The parsed JSON
+     * @param[in] maxChassis - Highest chassis ID
+     *
+     * @throw std::invalid_argument if a group is invalid, such as a chassis
+     *        ID out of range, a chassis in two groups, a loop of groups,
+     *        a host with two partitions or a partition without members
+     * @throw nlohmann::json::exception if the JSON doesn't have the format
+     */
+    SMPConfig(const nlohmann::json& data, size_t maxChassis);
+
+    /** @brief Whether a chassis ID is an intermediate aggregator
+     *
+     * @param[in] chassisId - The chassis ID
+     */
+    bool isGroup(size_t chassisId) const
+    {
+        return (chassisId < groups.size()) && groups.test(chassisId);
+    }
+
+    /** @brief Whether a host runs on a partition of its own
+     *
+     * @param[in] hostId - The host ID
+     */
+    bool hasPartition(size_t hostId) const
+    {
+        return partitions.contains(hostId);
+    }
+
+    /** @brief Whether there are any groups or partitions */
+    bool hierarchical() const
+    {
+        return groups.any() || !partitions.empty();
+    }
+
+    /** @brief The physical chassis an aggregator aggregates directly
+     *
+     * @param[in] aggregator - Chassis 0, a group or a partition
+     */
+    ChassisSet<> leavesOf(const SMPAggregator& aggregator) const;
+
+    /** @brief The groups an aggregator aggregates
+     *
+     * @param[in] aggregator - Chassis 0, a group or a partition
+     */
+    ChassisSet<> subGroupsOf(const SMPAggregator& aggregator) const;
+
+    /** @brief The physical chassis below an aggregator, through its groups
+     *
+     * @param[in] aggregator - Chassis 0, a group or a partition
+     */
+    ChassisSet<> chassisOf(const SMPAggregator& aggregator) const;
+
+    /** @brief The physical chassis a host runs on
+     *
+     * Without a partition of its own host 0 runs on the chassis of chassis 0.
+     *
+     * @param[in] hostId - The host ID
+     *
+     * @return The chassis of the host, empty if it has none
+     */
+    ChassisSet<> chassisOfHost(size_t hostId) const;
+
+  private:
+    /** @brief The members of an aggregator, empty if it doesn't exist */
+    ChassisSet<> membersOf(const SMPAggregator& aggregator) const;
+
+    /** @brief Highest chassis ID */
+    size_t maxChassis = smpMaxChassis;
+
+    /** @brief Chassis IDs of the groups */
+    ChassisSet<> groups;
+
+    /** @brief Chassis that are a member of a group or partition */
+    ChassisSet<> grouped;
+
+    /** @brief Members of each group, by group chassis ID */
+    std::array<ChassisSet<>, smpMaxChassis + 1> members{};
+
+    /** @brief Members of each partition, by host ID */
+    std::map<size_t, ChassisSet<>> partitions;
+};
+
+/** @brief Load the SMP arrangement from a JSON file
+ *
+ * @param[in] path       - Path of the file
+ * @param[in] maxChassis - Highest chassis ID
+ *
+ * @return The arrangement, flat when the file doesn't exist
+ *
+ * @throw std::exception if the file can't be parsed or is invalid
+ */
+SMPConfig loadSMPConfig(const std::string& path, size_t maxChassis);
+
+} // namespace phosphor::state::manager
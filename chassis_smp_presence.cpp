@@ -0,0 +1,259 @@
+#include "chassis_smp_presence.hpp"
+
+#include "utils.hpp"
+
+#include <phosphor-logging/lg2.hpp>
+#include <sdbusplus/exception.hpp>
+#include <xyz/openbmc_project/Inventory/Item/common.hpp>
+#include <xyz/openbmc_project/ObjectMapper/client.hpp>
+
+#include <format>
+#include <map>
+#include <optional>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace phosphor::state::manager
+{
+
+PHOSPHOR_LOG2_USING;
+
+using InventoryItem = sdbusplus::common::xyz::openbmc_project::inventory::Item;
+using ObjectMapper = sdbusplus::client::xyz::openbmc_project::ObjectMapper<>;
+
+constexpr auto PROPERTY_INTERFACE = "org.freedesktop.DBus.Properties";
+constexpr auto OBJECT_MANAGER_INTERFACE = "org.freedesktop.DBus.ObjectManager";
+
+bool readChassisPresent(sdbusplus::bus_t& bus, size_t chassisId)
+{
+    sdbusplus::object_path inventoryPath =
+        std::format("{}{}", CHASSIS_INVENTORY_PATH_PREFIX, chassisId);
+
+    try
+    {
+        auto inventoryBusName =
+            utils::getService(bus, inventoryPath.str, InventoryItem::interface);
+
+        auto method = bus.new_method_call(
+            inventoryBusName.c_str(), inventoryPath, PROPERTY_INTERFACE, "Get");
+        method.append(InventoryItem::interface,
+                      InventoryItem::property_names::present);
+
+        auto response = bus.call(method);
+        std::variant<bool> value;
+        response.read(value);
+
+        bool present = std::get<bool>(value);
+        debug("Chassis {CHASSIS_ID} present status: {PRESENT}", "CHASSIS_ID",
+              chassisId, "PRESENT", present);
+        return present;
+    }
+    catch (const std::exception& e)
+    {
+        debug("Could not read Present property for chassis {CHASSIS_ID}: "
+              "{ERROR}",
+              "CHASSIS_ID", chassisId, "ERROR", e.what());
+        return false;
+    }
+}
+
+/** @brief Read the Present property from the interfaces of an object
+ *
+ * Decodes an a{sa{sv}} of interfaces and their properties. Only the Item
+ * Present property is decoded, every other property is skipped whatever
+ * its type.
+ *
+ * @param[in] bus       - The Dbus bus object the message is on
+ * @param[in] msg       - The message, at the interfaces
+ * @param[out] hasItem  - Set when the Item interface is among them
+ *
+ * @return The Present property, std::nullopt if it isn't among them
+ */
+static std::optional<bool> readItemPresent(
+    sdbusplus::bus_t& bus, sdbusplus::message_t& msg, bool& hasItem)
+{
+    auto* intf = bus.getInterface();
+    std::optional<bool> present;
+
+    msg.enter_container('a', "{sa{sv}}");
+    while (!msg.at_end(false))
+    {
+        msg.enter_container('e', "sa{sv}");
+        std::string interface;
+        msg.read(interface);
+        bool isItem = (interface == InventoryItem::interface);
+        hasItem = hasItem || isItem;
+
+        msg.enter_container('a', "{sv}");
+        while (!msg.at_end(false))
+        {
+            msg.enter_container('e', "sv");
+            std::string property;
+            msg.read(property);
+
+            if (isItem &&
+                (property == InventoryItem::property_names::present) &&
+                (intf->sd_bus_message_verify_type(msg.get(), 'v', "b") > 0))
+            {
+                std::variant<bool> value;
+                msg.read(value);
+                present = std::get<bool>(value);
+            }
+            else
+            {
+                intf->sd_bus_message_skip(msg.get(), "v");
+            }
+            msg.exit_container();
+        }
+        msg.exit_container();
+        msg.exit_container();
+    }
+    msg.exit_container();
+
+    return present;
+}
+
+/** @brief Read the Present property of the inventory items of a service
+ *
+ * @param[in] bus       - The Dbus bus object
+ * @param[in] service   - The inventory service
+ *
+ * @return The presence by object path, empty if it couldn't be read
+ */
+static InventoryPresence readServicePresence(sdbusplus::bus_t& bus,
+                                             const std::string& service)
+{
+    InventoryPresence presence;
+    try
+    {
+        auto method = bus.new_method_call(service.c_str(), INVENTORY_ROOT,
+                                          OBJECT_MANAGER_INTERFACE,
+                                          "GetManagedObjects");
+        auto reply = bus.call(method);
+
+        reply.enter_container('a', "{oa{sa{sv}}}");
+        while (!reply.at_end(false))
+        {
+            reply.enter_container('e', "oa{sa{sv}}");
+            sdbusplus::object_path path;
+            reply.read(path);
+
+            bool hasItem = false;
+            if (auto present = readItemPresent(bus, reply, hasItem))
+            {
+                presence.insert_or_assign(path.str, *present);
+            }
+            reply.exit_container();
+        }
+        reply.exit_container();
+    }
+    catch (const std::exception& e)
+    {
+        debug("Could not get the inventory objects of {SERVICE}, reading "
+              "each chassis: {ERROR}",
+              "SERVICE", service, "ERROR", e.what());
+        presence.clear();
+    }
+    return presence;
+}
+
+std::optional<std::pair<std::string, bool>>
+    readAddedItem(sdbusplus::bus_t& bus, sdbusplus::message_t& msg)
+{
+    sdbusplus::object_path path;
+    msg.read(path);
+
+    bool hasItem = false;
+    auto present = readItemPresent(bus, msg, hasItem);
+    if (!hasItem)
+    {
+        return std::nullopt;
+    }
+
+    // An unset property has its default value
+    return std::make_pair(path.str, present.value_or(false));
+}
+
+ChassisInventory collectChassisInventory(
+    const InventorySubTree& subTree, size_t maxChassis,
+    const std::function<InventoryPresence(const std::string&)>& readService,
+    const std::function<bool(size_t)>& readChassis)
+{
+    ChassisInventory inventory;
+
+    // Chassis IDs by the service owning their inventory item, a chassis
+    // without an inventory item isn't a member
+    std::map<std::string, std::vector<size_t>> chassisByService;
+    for (const auto& [path, services] : subTree)
+    {
+        auto chassisId =
+            chassisIdFromPath(path, CHASSIS_INVENTORY_PATH_PREFIX, maxChassis);
+        if (chassisId && !services.empty())
+        {
+            inventory.members.set(*chassisId);
+            chassisByService[services.begin()->first].push_back(*chassisId);
+        }
+    }
+
+    for (const auto& [service, chassisIds] : chassisByService)
+    {
+        auto presence = readService(service);
+        for (auto chassisId : chassisIds)
+        {
+            auto path =
+                std::format("{}{}", CHASSIS_INVENTORY_PATH_PREFIX, chassisId);
+            auto present = presence.find(path);
+            inventory.present.set(chassisId, (present != presence.end())
+                                                 ? present->second
+                                                 : readChassis(chassisId));
+        }
+    }
+
+    return inventory;
+}
+
+ChassisInventory readChassisInventory(sdbusplus::bus_t& bus,
+                                      size_t maxChassis)
+{
+    ChassisInventory inventory;
+    try
+    {
+        auto mapper = bus.new_method_call(
+            ObjectMapper::default_service, ObjectMapper::instance_path,
+            ObjectMapper::interface, ObjectMapper::method_names::get_sub_tree);
+        mapper.append(CHASSIS_INVENTORY_NAMESPACE, 1,
+                      std::vector<std::string>({InventoryItem::interface}));
+
+        auto reply = bus.call(mapper);
+        inventory = collectChassisInventory(
+            reply.unpack<InventorySubTree>(), maxChassis,
+            [&bus](const std::string& service) {
+                return readServicePresence(bus, service);
+            },
+            [&bus](size_t chassisId) {
+                return readChassisPresent(bus, chassisId);
+            });
+    }
+    catch (const std::exception& e)
+    {
+        warning("Could not list the chassis inventory items, reading each "
+                "chassis: {ERROR}",
+                "ERROR", e.what());
+        inventory.members = chassisRange(maxChassis);
+        for (size_t i = 1; i <= maxChassis; ++i)
+        {
+            inventory.present.set(i, readChassisPresent(bus, i));
+        }
+        return inventory;
+    }
+
+    info("Found {NUM_PRESENT} present chassis out of {NUM_MEMBERS} in the "
+         "inventory",
+         "NUM_PRESENT", inventory.present.count(), "NUM_MEMBERS",
+         inventory.members.count());
+    return inventory;
+}
+
+} // namespace phosphor::state::manager
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "chassis_smp_common.hpp"
+
+#include <sdbusplus/bus.hpp>
+
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace phosphor::state::manager
+{
+
+/** @brief Read the inventory Present property of one chassis
+ *
+ * Resolves the inventory service with the mapper, then reads the property.
+ *
+ * @param[in] bus       - The Dbus bus object
+ * @param[in] chassisId - ID of the chassis to check
+ *
+ * @return true if the chassis is present, false if it isn't or the
+ *         property couldn't be read
+ */
+bool readChassisPresent(sdbusplus::bus_t& bus, size_t chassisId);
+
+/** @brief Decode the inventory item an InterfacesAdded signal adds
+ *
+ * Properties of any type are accepted, only Present is decoded.
+ *
+ * @param[in] bus       - The Dbus bus object
+ * @param[in] msg       - The InterfacesAdded signal
+ *
+ * @return The object path and its Present property, std::nullopt if the
+ *         Item interface isn't among the added interfaces
+ */
+std::optional<std::pair<std::string, bool>>
+    readAddedItem(sdbusplus::bus_t& bus, sdbusplus::message_t& msg);
+
+/** @brief The chassis found in the inventory */
+struct ChassisInventory
+{
+    /** @brief Chassis having an inventory item */
+    ChassisSet<> members;
+
+    /** @brief Members whose inventory item is present */
+    ChassisSet<> present;
+};
+
+/** @brief Inventory items by object path, then by owning service, with
+ *  their interfaces, as returned by the mapper GetSubTree */
+using InventorySubTree =
+    std::map<std::string, std::map<std::string, std::vector<std::string>>>;
+
+/** @brief Present property of inventory items, by object path */
+using InventoryPresence = std::map<std::string, bool>;
+
+/** @brief Assemble the chassis found in the inventory
+ *
+ * Reads the presence of all the chassis of a service at once, and only
+ * reads a chassis on its own when that didn't resolve it.
+ *
+ * @param[in] subTree      - The chassis inventory items
+ * @param[in] maxChassis   - Highest chassis ID to accept
+ * @param[in] readService  - Reads the presence of all the inventory items
+ *                           of a service, empty if it can't
+ * @param[in] readChassis  - Reads the presence of one chassis
+ *
+ * @return The members and the present chassis
+ */
+ChassisInventory collectChassisInventory(
+    const InventorySubTree& subTree, size_t maxChassis,
+    const std::function<InventoryPresence(const std::string&)>& readService,
+    const std::function<bool(size_t)>& readChassis);
+
+/** @brief Discover the chassis from the inventory
+ *
+ * Finds the chassis inventory items with a single mapper GetSubTree, then
+ * reads them with one GetManagedObjects per owning service. Falls back to
+ * readChassisPresent() for the chassis this doesn't resolve, so the cost
+ * stays flat as the number of chassis grows. When the inventory can't be
+ * listed every chassis up to maxChassis is a member.
+ *
+ * @param[in] bus        - The Dbus bus object
+ * @param[in] maxChassis - Highest chassis ID to accept
+ *
+ * @return The members and the present chassis
+ */
+ChassisInventory readChassisInventory(sdbusplus::bus_t& bus,
+                                      size_t maxChassis);
+
+} // namespace phosphor::state::manager
@@ -0,0 +1,178 @@
+#include "chassis_smp_timeline.hpp"
+
+#include <algorithm>
+#include <format>
+
+namespace phosphor::state::manager
+{
+
+using std::chrono::duration_cast;
+using std::chrono::milliseconds;
+
+TransitionTimelines::TransitionTimelines(size_t depth) :
+    ring(std::max<size_t>(depth, 1))
+{}
+
+TransitionTimelines::Timeline* TransitionTimelines::current()
+{
+    return (count == 0) ? nullptr : &ring[head];
+}
+
+void TransitionTimelines::start(uint64_t transition,
+                                const ChassisSet<>& chassis,
+                                Clock::time_point now,
+                                WallClock::time_point wallNow)
+{
+    if (count != 0)
+    {
+        head = (head + 1) % ring.size();
+    }
+    count = std::min(count + 1, ring.size());
+
+    ring[head] = Timeline{.transition = transition,
+                          .start = now,
+                          .wallStart = wallNow,
+                          .chassis = chassis,
+                          .reached = {},
+                          .failed = {},
+                          .members = {}};
+}
+
+void TransitionTimelines::transitioning(size_t chassisId, Clock::time_point now)
+{
+    auto* timeline = current();
+    if (!timeline || !timeline->chassis.test(chassisId))
+    {
+        return;
+    }
+
+    auto& member = timeline->members[chassisId];
+    if (!member.transitioning)
+    {
+        member.transitioning =
+            duration_cast<milliseconds>(now - timeline->start);
+    }
+}
+
+bool TransitionTimelines::reached(size_t chassisId, Clock::time_point now)
+{
+    auto* timeline = current();
+    if (!timeline || !timeline->chassis.test(chassisId) ||
+        timeline->reached.test(chassisId) || timeline->complete())
+    {
+        return false;
+    }
+
+    timeline->members[chassisId].reached =
+        duration_cast<milliseconds>(now - timeline->start);
+    timeline->reached.set(chassisId);
+    return timeline->complete();
+}
+
+bool TransitionTimelines::failed(size_t chassisId, Clock::time_point now)
+{
+    auto* timeline = current();
+    if (!timeline || !timeline->chassis.test(chassisId) ||
+        timeline->failed.test(chassisId) || timeline->complete())
+    {
+        return false;
+    }
+
+    timeline->members[chassisId].failed =
+        duration_cast<milliseconds>(now - timeline->start);
+    timeline->failed.set(chassisId);
+    return timeline->complete();
+}
+
+std::optional<size_t> TransitionTimelines::slowest(const Timeline& timeline)
+{
+    std::optional<size_t> slowestId;
+    forEachChassis(timeline.reached, [&timeline, &slowestId](size_t id) {
+        if (!slowestId || (*timeline.members[id].reached >
+                           *timeline.members[*slowestId].reached))
+        {
+            slowestId = id;
+        }
+    });
+    return slowestId;
+}
+
+milliseconds TransitionTimelines::spread(const Timeline& timeline)
+{
+    std::optional<milliseconds> first;
+    std::optional<milliseconds> last;
+    forEachChassis(timeline.reached, [&](size_t id) {
+        auto reached = *timeline.members[id].reached;
+        first = std::min(first.value_or(reached), reached);
+        last = std::max(last.value_or(reached), reached);
+    });
+    return (first && last) ? (*last - *first) : milliseconds{0};
+}
+
+std::optional<size_t> TransitionTimelines::slowest() const
+{
+    return (count == 0) ? std::nullopt : slowest(ring[head]);
+}
+
+milliseconds TransitionTimelines::slowestTime() const
+{
+    auto slowestId = slowest();
+    return slowestId ? *ring[head].members[*slowestId].reached
+                     : milliseconds{0};
+}
+
+milliseconds TransitionTimelines::spread() const
+{
+    return (count == 0) ? milliseconds{0} : spread(ring[head]);
+}
+
+TransitionTimelines::Values TransitionTimelines::values() const
+{
+    Values values;
+    for (size_t n = 0; n < count; ++n)
+    {
+        const auto& timeline = ring[(head + ring.size() - n) % ring.size()];
+        auto prefix = std::format("timeline{}.", n);
+
+        values.emplace(prefix + "transition", timeline.transition);
+        values.emplace(
+            prefix + "start_ms",
+            duration_cast<milliseconds>(timeline.wallStart.time_since_epoch())
+                .count());
+        values.emplace(prefix + "chassis", timeline.chassis.count());
+        values.emplace(prefix + "reached", timeline.reached.count());
+        values.emplace(prefix + "failed", timeline.failed.count());
+        values.emplace(prefix + "complete", timeline.complete() ? 1 : 0);
+
+        if (auto slowestId = slowest(timeline))
+        {
+            values.emplace(prefix + "slowest_chassis", *slowestId);
+            values.emplace(prefix + "slowest_ms",
+                           timeline.members[*slowestId].reached->count());
+            values.emplace(prefix + "spread_ms", spread(timeline).count());
+        }
+
+        forEachChassis(timeline.chassis, [&](size_t id) {
+            const auto& member = timeline.members[id];
+            auto memberPrefix = std::format("{}chassis{}.", prefix, id);
+            if (member.transitioning)
+            {
+                values.emplace(memberPrefix + "transitioning_ms",
+                               member.transitioning->count());
+            }
+            if (member.reached)
+            {
+                values.emplace(memberPrefix + "reached_ms",
+                               member.reached->count());
+            }
+            if (member.failed)
+            {
+                values.emplace(memberPrefix + "failed_ms",
+                               member.failed->count());
+            }
+        });
+    }
+    return values;
+}
+
+} // namespace phosphor::state::manager
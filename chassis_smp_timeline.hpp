@@ -0,0 +1,149 @@
+#pragma once
+
+#include "chassis_smp_common.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace phosphor::state::manager
+{
+
+/** @class TransitionTimelines
+ *  @brief When each chassis reached the last coordinated transitions
+ *  @details Keeps the timeline of the last few transitions forwarded to the
+ *  chassis in a ring buffer allocated up front. A timeline records for each
+ *  chassis when it started transitioning, when it reached the requested
+ *  state and when it failed, so a slow power on can be tied to the chassis
+ *  that held it up.
+ */
+class TransitionTimelines
+{
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    /** @brief Clock of the published start of a timeline */
+    using WallClock = std::chrono::system_clock;
+
+    /** @brief Statistics keyed by name, as published on D-Bus */
+    using Values = std::map<std::string, uint64_t>;
+
+    /** @brief Constructs the ring buffer
+     *
+     * @param[in] depth - Number of timelines kept, at least 1
+     */
+    explicit TransitionTimelines(size_t depth);
+
+    /** @brief Start the timeline of a new transition, dropping the oldest
+     *
+     * @param[in] transition - The transition, as its enum value
+     * @param[in] chassis    - The chassis the transition is forwarded to
+     * @param[in] now        - When the transition started
+     * @param[in] wallNow    - When it started, by the wall clock
+     */
+    void start(uint64_t transition, const ChassisSet<>& chassis,
+               Clock::time_point now = Clock::now(),
+               WallClock::time_point wallNow = WallClock::now());
+
+    /** @brief Record a chassis starting to transition
+     *
+     * @param[in] chassisId - ID of the chassis
+     * @param[in] now       - When it started
+     */
+    void transitioning(size_t chassisId, Clock::time_point now = Clock::now());
+
+    /** @brief Record a chassis reaching the requested state
+     *
+     * @param[in] chassisId - ID of the chassis
+     * @param[in] now       - When it did
+     *
+     * @return true if this completed the timeline
+     */
+    bool reached(size_t chassisId, Clock::time_point now = Clock::now());
+
+    /** @brief Record a chassis failing the transition
+     *
+     * @param[in] chassisId - ID of the chassis
+     * @param[in] now       - When it failed
+     *
+     * @return true if this completed the timeline
+     */
+    bool failed(size_t chassisId, Clock::time_point now = Clock::now());
+
+    /** @brief The chassis of the current timeline that reached the state
+     *  last, std::nullopt if none has */
+    std::optional<size_t> slowest() const;
+
+    /** @brief Time from the start of the current timeline to its slowest
+     *  chassis reaching the state */
+    std::chrono::milliseconds slowestTime() const;
+
+    /** @brief Time between the first and the last chassis of the current
+     *  timeline reaching the state */
+    std::chrono::milliseconds spread() const;
+
+    /** @brief The timelines for a StatisticsInterface
+     *
+     *  Timeline 0 is the most recent. Each timeline N has:
+     *  - timelineN.transition, timelineN.start_ms and timelineN.chassis
+     *  - timelineN.reached, timelineN.failed, timelineN.complete
+     *  - timelineN.slowest_chassis, timelineN.slowest_ms and
+     *    timelineN.spread_ms once a chassis reached the state
+     *  - timelineN.chassisM.transitioning_ms, .reached_ms and .failed_ms
+     *    for each chassis M that got there, from the start of the timeline
+     *
+     *  start_ms is the wall clock time in milliseconds since the Unix epoch,
+     *  the other times are measured on the monotonic clock.
+     */
+    Values values() const;
+
+  private:
+    /** @brief Times of a chassis, from the start of the timeline */
+    struct Member
+    {
+        std::optional<std::chrono::milliseconds> transitioning;
+        std::optional<std::chrono::milliseconds> reached;
+        std::optional<std::chrono::milliseconds> failed;
+    };
+
+    /** @brief A coordinated transition */
+    struct Timeline
+    {
+        uint64_t transition = 0;
+        Clock::time_point start;
+        WallClock::time_point wallStart;
+        ChassisSet<> chassis;
+        ChassisSet<> reached;
+        ChassisSet<> failed;
+        std::array<Member, smpMaxChassis + 1> members{};
+
+        /** @brief Whether every chassis reached the state or failed */
+        bool complete() const
+        {
+            return (chassis & ~(reached | failed)).none();
+        }
+    };
+
+    /** @brief The current timeline, nullptr before the first one */
+    Timeline* current();
+
+    /** @brief Slowest chassis and spread of a timeline */
+    static std::optional<size_t> slowest(const Timeline& timeline);
+    static std::chrono::milliseconds spread(const Timeline& timeline);
+
+    /** @brief The timelines, reused in turn */
+    std::vector<Timeline> ring;
+
+    /** @brief Index of the current timeline in the ring */
+    size_t head = 0;
+
+    /** @brief Number of timelines recorded, up to the ring size */
+    size_t count = 0;
+};
+
+} // namespace phosphor::state::manager
@@ -18,9 +18,14 @@
 #include <xyz/openbmc_project/State/Chassis/error.hpp>
 #include <xyz/openbmc_project/State/Decorator/PowerSystemInputs/server.hpp>
 
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
 #include <filesystem>
 #include <format>
 #include <fstream>
+#include <stdexcept>
+#include <string_view>
 
 namespace phosphor::state::manager
 {
@@ -37,6 +42,7 @@ using UPowerDevice = sdbusplus::client::org::freedesktop::u_power::Device<>;
 
 using namespace phosphor::logging;
 using sdbusplus::xyz::openbmc_project::Common::Error::InternalFailure;
+using sdbusplus::xyz::openbmc_project::Common::Error::ResourceNotFound;
 using sdbusplus::xyz::openbmc_project::State::Shutdown::Power::Error::Blackout;
 using sdbusplus::xyz::openbmc_project::State::Shutdown::Power::Error::Regulator;
 constexpr auto CHASSIS_STATE_POWEROFF_TGT_FMT =
@@ -50,11 +56,6 @@ constexpr auto CHASSIS_STATE_POWERCYCLE_TGT_FMT =
 constexpr auto AUTO_POWER_RESTORE_SVC_FMT =
     "phosphor-discover-system-state@{}.service";
 
-// Details at https://upower.freedesktop.org/docs/Device.html
-constexpr uint TYPE_UPS = 3;
-constexpr uint STATE_FULLY_CHARGED = 4;
-constexpr uint BATTERY_LVL_FULL = 8;
-
 void Chassis::createSystemdTargetTable()
 {
     systemdTargetTable = {
@@ -63,6 +64,17 @@ void Chassis::createSystemdTargetTable()
         {Transition::On, std::format(CHASSIS_STATE_POWERON_TGT_FMT, id)},
         {Transition::PowerCycle,
          std::format(CHASSIS_STATE_POWERCYCLE_TGT_FMT, id)}};
+
+    // Track the targets checked when their jobs complete
+    unitStates.track(std::format(CHASSIS_STATE_POWEROFF_TGT_FMT, id));
+    unitStates.track(systemdTargetTable[Transition::On]);
+
+    // Only have the bus deliver job signals for this chassis' targets
+    systemdSignals.watch(std::format(CHASSIS_STATE_POWEROFF_TGT_FMT, id));
+    for (const auto& [transition, target] : systemdTargetTable)
+    {
+        systemdSignals.watch(target);
+    }
 }
 
 // TODO - Will be rewritten once sdbusplus client bindings are in place
@@ -70,389 +82,404 @@ void Chassis::createSystemdTargetTable()
 //        has read property function
 void Chassis::determineInitialState()
 {
-    // Monitor for any properties changed signals on UPower device path
-    uPowerPropChangeSignal = std::make_unique<sdbusplus::match>(
-        bus,
-        sdbusplus::match_rules::propertiesChangedNamespace(
-            "/org/freedesktop/UPower", UPowerDevice::interface),
-        [this](auto& msg) { this->uPowerChangeEvent(msg); });
-
-    // Monitor for any properties changed signals on PowerSystemInputs
-    powerSysInputsPropChangeSignal = std::make_unique<sdbusplus::match>(
-        bus,
-        sdbusplus::match_rules::propertiesChangedNamespace(
-            std::format(
-                "/xyz/openbmc_project/power/power_supplies/chassis{}/psus", id),
-            decoratorServer::PowerSystemInputs::interface),
-        [this](auto& msg) { this->powerSysInputsChangeEvent(msg); });
+    // Monitor this chassis' power supplies through the matches shared by
+    // the chassis of this process, UPower devices are monitored by the
+    // shared UPowerDevices model
+    powerSupplies->subscribe(
+        id, {[this](auto& msg) { powerSysInputsChangeEvent(msg); },
+             [this](const auto& path, auto& msg) {
+                 powerInputsAddedEvent(path, msg);
+             },
+             [this](const auto& path, auto& msg) {
+                 powerInputsRemovedEvent(path, msg);
+             }});
+
+    // The pgood state and the power input model don't depend on each
+    // other, so query them concurrently. The model is kept up to date by
+    // the signals above from now on.
+    discoveryStart = std::chrono::steady_clock::now();
+    readPgood();
+    loadUPSDevices();
+    loadPSUDevices();
+}
 
+void Chassis::discoveryComplete()
+{
+    auto toMs = [](std::chrono::steady_clock::duration time) {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(time)
+            .count();
+    };
+    info("Chassis{CHASSIS_ID}: Initial state discovery took {TOTAL_MS} ms, "
+         "pgood {PGOOD_MS} ms, UPS {UPS_MS} ms, PSU {PSU_MS} ms",
+         "CHASSIS_ID", id, "TOTAL_MS",
+         toMs(std::chrono::steady_clock::now() - discoveryStart), "PGOOD_MS",
+         toMs(discoveryTimes["pgood"]), "UPS_MS", toMs(discoveryTimes["UPS"]),
+         "PSU_MS", toMs(discoveryTimes["PSU"]));
+
+    if (discoveryFailed)
+    {
+        // The power status can't be determined without the power inputs
+        error("Chassis{CHASSIS_ID}: Error reading power inputs", "CHASSIS_ID",
+              id);
+        if (onDiscoveryFailure)
+        {
+            onDiscoveryFailure();
+        }
+        else
+        {
+            // Have systemd restart the service
+            sdeventplus::Event::get_default().exit(EXIT_FAILURE);
+        }
+        return;
+    }
+
+    discovered = true;
     determineStatusOfPower();
+    setInitialPowerState();
+    initialStatePhase.reset();
 
-    std::variant<int> pgood = -1;
-    sdbusplus::object_path powerControlPath =
-        std::format("/org/openbmc/control/power{}", id);
-    auto method =
-        this->bus.new_method_call("org.openbmc.control.Power", powerControlPath,
-                                  PROPERTY_INTERFACE, "Get");
+    {
+        auto phase = utils::StartupTimer::instance().phase(
+            std::format("chassis{}.restore_poh", id));
+        restorePOHCounter(); // restore POHCounter from persisted file
+    }
 
-    method.append("org.openbmc.control.Power", "pgood");
-    try
+    // We deferred this until we could get our property correct
+    this->emit_object_added();
+
+    // Jobs that finished during discovery change the state from here
+    auto signals = std::move(deferredJobSignals);
+    for (auto& msg : signals)
     {
-        auto reply = this->bus.call(method);
-        reply.read(pgood);
+        sysStateChange(msg);
+    }
 
-        if (std::get<int>(pgood) == 1)
-        {
-            info("Chassis{CHASSIS_ID}: Initial Chassis State will be On",
-                 "CHASSIS_ID", id);
-            server::Chassis::currentPowerState(PowerState::On);
-            server::Chassis::requestedPowerTransition(Transition::On);
-            return;
-        }
-        else
-        {
-            // The system is off.  If we think it should be on then
-            // we probably lost AC while up, so set a new state
-            // change time.
-            uint64_t lastTime;
-            PowerState lastState;
+    // The other chassis sharing the UPower model now see all of it
+    if (upowerLoader)
+    {
+        upower->loadComplete();
+    }
+}
+
+void Chassis::setInitialPowerState()
+{
+    if (initialPgood == 1)
+    {
+        info("Chassis{CHASSIS_ID}: Initial Chassis State will be On",
+             "CHASSIS_ID", id);
+        server::Chassis::currentPowerState(PowerState::On);
+        server::Chassis::requestedPowerTransition(Transition::On);
+        return;
+    }
 
-            if (deserializeStateChangeTime(lastTime, lastState))
+    if (initialPgood)
+    {
+        // The system is off.  If we think it should be on then
+        // we probably lost AC while up, so set a new state
+        // change time.
+        if (lastStateChange)
+        {
+            // If power was on before the BMC reboot and the reboot reason
+            // was not a pinhole reset, log an error
+            if (lastStateChange->second == PowerState::On)
             {
-                // If power was on before the BMC reboot and the reboot reason
-                // was not a pinhole reset, log an error
-                if (lastState == PowerState::On)
-                {
-                    warning(
-                        "Chassis{CHASSIS_ID}: Chassis power was on before the "
+                warning("Chassis{CHASSIS_ID}: Chassis power was on before the "
                         "BMC reboot and it is off now",
                         "CHASSIS_ID", id);
 
-                    // Reset host sensors since system is off now
-                    // Ensure Power Leds are off.
-                    startUnit(std::format(CHASSIS_BLACKOUT_TGT_FMT, id));
-
-                    setStateChangeTime();
-                    // Generate file indicating AC loss occurred
-                    std::string chassisLostPowerFileFmt =
-                        std::format(CHASSIS_LOST_POWER_FILE, id);
-                    fs::create_directories(BASE_FILE_DIR);
-                    fs::path chassisPowerLossFile{chassisLostPowerFileFmt};
-                    std::ofstream outfile(chassisPowerLossFile);
-                    outfile.close();
-
-                    // 0 indicates pinhole reset. 1 is NOT pinhole reset
-                    if (phosphor::state::manager::utils::getGpioValue(
-                            "reset-cause-pinhole") != 0)
+                // Reset host sensors since system is off now
+                // Ensure Power Leds are off.
+                startUnit(std::format(CHASSIS_BLACKOUT_TGT_FMT, id));
+
+                setStateChangeTime();
+                // Generate file indicating AC loss occurred
+                std::string chassisLostPowerFileFmt =
+                    std::format(CHASSIS_LOST_POWER_FILE, id);
+                fs::create_directories(BASE_FILE_DIR);
+                fs::path chassisPowerLossFile{chassisLostPowerFileFmt};
+                std::ofstream outfile(chassisPowerLossFile);
+                outfile.close();
+
+                // 0 indicates pinhole reset. 1 is NOT pinhole reset
+                if (phosphor::state::manager::utils::getGpioValue(
+                        "reset-cause-pinhole") != 0)
+                {
+                    if (standbyVoltageRegulatorFault())
                     {
-                        if (standbyVoltageRegulatorFault())
-                        {
-                            report<Regulator>();
-                        }
-                        else
-                        {
-                            report<Blackout>(Entry::Level::Critical);
-                        }
+                        report<Regulator>();
                     }
                     else
                     {
-                        info("Chassis{CHASSIS_ID}: Pinhole reset", "CHASSIS_ID",
-                             id);
+                        report<Blackout>(Entry::Level::Critical);
                     }
                 }
+                else
+                {
+                    info("Chassis{CHASSIS_ID}: Pinhole reset", "CHASSIS_ID",
+                         id);
+                }
             }
         }
     }
-    catch (const sdbusplus::exception_t& e)
-    {
-        // It's acceptable for the pgood state service to not be available
-        // since it will notify us of the pgood state when it comes up.
-        if (e.name() != nullptr &&
-            strcmp("org.freedesktop.DBus.Error.ServiceUnknown", e.name()) == 0)
-        {
-            goto fail;
-        }
-
-        // Only log for unexpected error types.
-        error(
-            "Chassis{CHASSIS_ID}: Error performing call to get pgood: {ERROR}",
-            "CHASSIS_ID", id, "ERROR", e);
-        goto fail;
-    }
 
-fail:
     info("Chassis{CHASSIS_ID}: Initial Chassis State will be Off", "CHASSIS_ID",
          id);
     server::Chassis::currentPowerState(PowerState::Off);
     server::Chassis::requestedPowerTransition(Transition::Off);
-
-    return;
 }
 
-void Chassis::determineStatusOfPower()
+void Chassis::readPgood()
 {
-    auto initialPowerStatus = server::Chassis::currentPowerStatus();
+    sdbusplus::object_path powerControlPath =
+        std::format("/org/openbmc/control/power{}", id);
+    auto method =
+        this->bus.new_method_call("org.openbmc.control.Power", powerControlPath,
+                                  PROPERTY_INTERFACE, "Get");
 
-    bool powerGood = determineStatusOfUPSPower();
-    if (!powerGood)
-    {
-        return;
-    }
+    method.append("org.openbmc.control.Power", "pgood");
 
-    powerGood = determineStatusOfPSUPower();
-    if (powerGood)
-    {
-        // All checks passed, set power status to good
-        server::Chassis::currentPowerStatus(PowerStatus::Good);
+    discoveryCall("pgood", method, [this](sdbusplus::message_t& reply) {
+        if (reply.is_method_error())
+        {
+            // It's acceptable for the pgood state service to not be
+            // available since it will notify us of the pgood state when it
+            // comes up. Only log for unexpected error types.
+            const auto* e = reply.get_error();
+            if ((e == nullptr) || (e->name == nullptr) ||
+                (strcmp("org.freedesktop.DBus.Error.ServiceUnknown",
+                        e->name) != 0))
+            {
+                error("Chassis{CHASSIS_ID}: Error performing call to get "
+                      "pgood: {ERROR}",
+                      "CHASSIS_ID", id, "ERROR",
+                      (e && e->name) ? e->name : "");
+            }
+            return;
+        }
 
-        // If power status transitioned from bad to good and chassis power is
-        // off then call Auto Power Restart to see if the system should auto
-        // power on now that power status is good
-        if ((initialPowerStatus != PowerStatus::Good) &&
-            (server::Chassis::currentPowerState() == PowerState::Off))
+        try
         {
-            info(
-                "Chassis{CHASSIS_ID}: power status transitioned from "
-                "{START_PWR_STATE} to Good and chassis power is off, calling APR",
-                "CHASSIS_ID", id, "START_PWR_STATE", initialPowerStatus);
-            restartUnit(std::format(AUTO_POWER_RESTORE_SVC_FMT, this->id));
+            initialPgood = std::get<int>(reply.unpack<std::variant<int>>());
         }
-    }
+        catch (const std::exception& e)
+        {
+            error("Chassis{CHASSIS_ID}: Bad pgood reply: {ERROR}",
+                  "CHASSIS_ID", id, "ERROR", e);
+        }
+    });
 }
 
-bool Chassis::determineStatusOfUPSPower()
+void Chassis::determineStatusOfPower()
 {
-    // Find all implementations of the UPower interface
-    auto mapper = bus.new_method_call(
-        ObjectMapper::default_service, ObjectMapper::instance_path,
-        ObjectMapper::interface, ObjectMapper::method_names::get_sub_tree);
-
-    mapper.append("/", 0, std::vector<std::string>({UPowerDevice::interface}));
+    // Power input changes during discovery are picked up when it completes
+    if (!discovered)
+    {
+        return;
+    }
 
-    std::map<std::string, std::map<std::string, std::vector<std::string>>>
-        mapperResponse;
+    auto initialPowerStatus = server::Chassis::currentPowerStatus();
 
-    try
+    if (upower->degradedCount() != 0)
     {
-        auto mapperResponseMsg = bus.call(mapper);
-        mapperResponseMsg.read(mapperResponse);
+        server::Chassis::currentPowerStatus(
+            PowerStatus::UninterruptiblePowerSupply);
+        return;
     }
-    catch (const sdbusplus::exception_t& e)
+
+    if (faultedPSUCount != 0)
     {
-        error("Chassis{CHASSIS_ID}: Error in mapper GetSubTree call for UPS: "
-              "{ERROR}",
-              "CHASSIS_ID", id, "ERROR", e);
-        throw;
+        server::Chassis::currentPowerStatus(PowerStatus::BrownOut);
+        return;
     }
 
-    if (mapperResponse.empty())
+    // All checks passed, set power status to good
+    server::Chassis::currentPowerStatus(PowerStatus::Good);
+
+    // If power status transitioned from bad to good and chassis power is
+    // off then call Auto Power Restart to see if the system should auto
+    // power on now that power status is good
+    if ((initialPowerStatus != PowerStatus::Good) &&
+        (server::Chassis::currentPowerState() == PowerState::Off))
     {
-        debug("Chassis{CHASSIS_ID}: No UPower devices found in system",
-              "CHASSIS_ID", id);
+        info("Chassis{CHASSIS_ID}: power status transitioned from "
+             "{START_PWR_STATE} to Good and chassis power is off, calling APR",
+             "CHASSIS_ID", id, "START_PWR_STATE", initialPowerStatus);
+        restartUnit(std::format(AUTO_POWER_RESTORE_SVC_FMT, this->id));
     }
+}
 
-    // Iterate through all returned Upower interfaces and look for UPS's
-    for (const auto& [path, services] : mapperResponse)
+void Chassis::loadUPSDevices()
+{
+    // The model is shared, only the first chassis of the process loads it
+    if (!upower->claimLoad())
     {
-        for (const auto& serviceIter : services)
-        {
-            const std::string& service = serviceIter.first;
-
-            try
-            {
-                auto method = bus.new_method_call(service.c_str(), path.c_str(),
-                                                  PROPERTY_INTERFACE, "GetAll");
-                method.append(UPowerDevice::interface);
-
-                auto response = bus.call(method);
-                using Property = std::string;
-                using Value = std::variant<bool, uint>;
-                using PropertyMap = std::map<Property, Value>;
-                auto properties = response.unpack<PropertyMap>();
-
-                if (std::get<uint>(properties["Type"]) != TYPE_UPS)
-                {
-                    info(
-                        "Chassis{CHASSIS_ID}: UPower device {OBJ_PATH} is not a "
-                        "UPS device",
-                        "CHASSIS_ID", id, "OBJ_PATH", path);
-                    continue;
-                }
-
-                if (!std::get<bool>(properties["IsPresent"]))
-                {
-                    // There is a UPS detected but it is not officially
-                    // "present" yet. Monitor it for state change.
-                    info("Chassis{CHASSIS_ID}: UPower device {OBJ_PATH} is not "
-                         "present",
-                         "CHASSIS_ID", id, "OBJ_PATH", path);
-                    continue;
-                }
+        return;
+    }
+    upowerLoader = true;
 
-                if (std::get<uint>(properties["State"]) == STATE_FULLY_CHARGED)
-                {
-                    info("Chassis{CHASSIS_ID}: UPS is fully charged",
-                         "CHASSIS_ID", id);
-                }
-                else
-                {
-                    warning("Chassis{CHASSIS_ID}: UPS is not fully charged: "
-                            "{UPS_STATE}",
-                            "CHASSIS_ID", id, "UPS_STATE",
-                            std::get<uint>(properties["State"]));
-                    server::Chassis::currentPowerStatus(
-                        PowerStatus::UninterruptiblePowerSupply);
-                    return false;
-                }
+    loadPowerInputs("UPS", UPOWER_ROOT_PATH, UPowerDevice::interface,
+                    [devices = upower](const std::string& path,
+                                       const PowerInputProperties& properties) {
+                        devices->update(path, properties);
+                    });
+}
 
-                if (std::get<uint>(properties["BatteryLevel"]) ==
-                    BATTERY_LVL_FULL)
-                {
-                    info("Chassis{CHASSIS_ID}: UPS Battery Level is Full",
-                         "CHASSIS_ID", id);
-                    // Only one UPS per system, we've found it and it's all
-                    // good so exit function
-                    return true;
-                }
-                else
-                {
-                    warning("Chassis{CHASSIS_ID}: UPS Battery Level is Low: "
-                            "{UPS_BAT_LEVEL}",
-                            "CHASSIS_ID", id, "UPS_BAT_LEVEL",
-                            std::get<uint>(properties["BatteryLevel"]));
-                    server::Chassis::currentPowerStatus(
-                        PowerStatus::UninterruptiblePowerSupply);
-                    return false;
-                }
-            }
-            catch (const sdbusplus::exception_t& e)
-            {
-                error("Chassis{CHASSIS_ID}: Error reading UPS property, error: "
-                      "{ERROR}, service: {SERVICE} path: {PATH}",
-                      "CHASSIS_ID", id, "ERROR", e, "SERVICE", service, "PATH",
-                      path);
-                throw;
-            }
-        }
-    }
-    return true;
+void Chassis::loadPSUDevices()
+{
+    loadPowerInputs("PSU", std::format(CHASSIS_PSU_ROOT_PATH_FMT, id),
+                    decoratorServer::PowerSystemInputs::interface,
+                    [this](const std::string& path,
+                           const PowerInputProperties& properties) {
+                        updatePSUDevice(path, properties);
+                    });
 }
 
-bool Chassis::determineStatusOfPSUPower()
+void Chassis::loadPowerInputs(
+    const std::string& phase, const std::string& root,
+    const std::string& interface,
+    std::function<void(const std::string&, const PowerInputProperties&)> update)
 {
-    // Find all implementations of the PowerSystemInputs interface
     auto mapper = bus.new_method_call(
         ObjectMapper::default_service, ObjectMapper::instance_path,
         ObjectMapper::interface, ObjectMapper::method_names::get_sub_tree);
 
-    mapper.append("/", 0,
-                  std::vector<std::string>(
-                      {decoratorServer::PowerSystemInputs::interface}));
+    mapper.append(root, 0, std::vector<std::string>({interface}));
 
-    std::map<std::string, std::map<std::string, std::vector<std::string>>>
-        mapperResponse;
+    discoveryCall(phase, mapper, [this, phase, interface,
+                                  update](sdbusplus::message_t& reply) {
+        if (reply.is_method_error())
+        {
+            // The mapper fails the call when the root path doesn't exist,
+            // which just means there are no devices of this type yet
+            const auto* e = reply.get_error();
+            if ((e != nullptr) && (e->name != nullptr) &&
+                (e->name == std::string_view(ResourceNotFound::errName)))
+            {
+                debug("Chassis{CHASSIS_ID}: No {INTERFACE} objects found",
+                      "CHASSIS_ID", id, "INTERFACE", interface);
+                return;
+            }
 
-    try
-    {
-        auto mapperResponseMsg = bus.call(mapper);
-        mapperResponseMsg.read(mapperResponse);
-    }
-    catch (const sdbusplus::exception_t& e)
-    {
-        error("Chassis{CHASSIS_ID}: Error in mapper GetSubTree call for "
-              "PowerSystemInputs: {ERROR}",
-              "CHASSIS_ID", id, "ERROR", e);
-        throw;
-    }
+            error("Chassis{CHASSIS_ID}: Error in mapper GetSubTree call for "
+                  "{INTERFACE}: {ERROR}",
+                  "CHASSIS_ID", id, "INTERFACE", interface, "ERROR",
+                  (e && e->name) ? e->name : "");
+            discoveryFailed = true;
+            return;
+        }
 
-    for (const auto& [path, services] : mapperResponse)
-    {
-        for (const auto& serviceIter : services)
-        {
-            const std::string& service = serviceIter.first;
+        auto mapperResponse = reply.unpack<std::map<
+            std::string, std::map<std::string, std::vector<std::string>>>>();
 
-            try
+        // Read the properties of every object at once
+        for (const auto& [path, services] : mapperResponse)
+        {
+            for (const auto& serviceIter : services)
             {
+                const std::string& service = serviceIter.first;
+
                 auto method = bus.new_method_call(service.c_str(), path.c_str(),
                                                   PROPERTY_INTERFACE, "GetAll");
-                method.append(decoratorServer::PowerSystemInputs::interface);
+                method.append(interface);
 
-                auto response = bus.call(method);
-                using Property = std::string;
-                using Value = std::variant<std::string>;
-                using PropertyMap = std::map<Property, Value>;
-                auto properties = response.unpack<PropertyMap>();
+                discoveryCall(
+                    phase, method,
+                    [this, path, service, interface,
+                     update](sdbusplus::message_t& propsReply) {
+                        if (propsReply.is_method_error())
+                        {
+                            const auto* e = propsReply.get_error();
+                            error("Chassis{CHASSIS_ID}: Error reading "
+                                  "{INTERFACE} properties, error: {ERROR}, "
+                                  "service: {SERVICE} path: {PATH}",
+                                  "CHASSIS_ID", id, "INTERFACE", interface,
+                                  "ERROR", (e && e->name) ? e->name : "",
+                                  "SERVICE", service, "PATH", path);
+                            discoveryFailed = true;
+                            return;
+                        }
+
+                        update(path, propsReply.unpack<PowerInputProperties>());
+                    });
+            }
+        }
+    });
+}
 
-                auto statusStr = std::get<std::string>(properties["Status"]);
-                auto status =
-                    decoratorServer::PowerSystemInputs::convertStatusFromString(
-                        statusStr);
+void Chassis::discoveryCall(
+    const std::string& phase, sdbusplus::message_t& method,
+    std::function<void(sdbusplus::message_t&)> handler)
+{
+    discoveryPending[phase]++;
 
-                if (status == decoratorServer::PowerSystemInputs::Status::Fault)
-                {
-                    warning(
-                        "Chassis{CHASSIS_ID}: Power System Inputs status is in "
-                        "Fault state",
-                        "CHASSIS_ID", id);
-                    server::Chassis::currentPowerStatus(PowerStatus::BrownOut);
-                    return false;
-                }
+    discoveryCalls.call(
+        nextDiscoveryCallId++, method,
+        [this, phase, handler = std::move(handler)](
+            sdbusplus::message_t& reply) {
+            try
+            {
+                handler(reply);
             }
             catch (const sdbusplus::exception_t& e)
             {
-                error(
-                    "Chassis{CHASSIS_ID}: Error reading Power System Inputs "
-                    "property, error: {ERROR}, service: {SERVICE} path: {PATH}",
-                    "CHASSIS_ID", id, "ERROR", e, "SERVICE", service, "PATH",
-                    path);
-                throw;
+                error("Chassis{CHASSIS_ID}: Bad {PHASE} discovery reply: "
+                      "{ERROR}",
+                      "CHASSIS_ID", id, "PHASE", phase, "ERROR", e);
+                discoveryFailed = true;
             }
-        }
-    }
-    return true;
+
+            // The handler may have added more calls to this phase, it is
+            // complete once none are left
+            if (--discoveryPending[phase] == 0)
+            {
+                discoveryTimes[phase] =
+                    std::chrono::steady_clock::now() - discoveryStart;
+            }
+
+            if (discoveryCalls.empty())
+            {
+                discoveryComplete();
+            }
+        });
 }
 
-void Chassis::uPowerChangeEvent(sdbusplus::message_t& msg)
+void Chassis::updatePSUDevice(const std::string& path,
+                              const PowerInputProperties& properties)
 {
-    debug("Chassis{CHASSIS_ID}: UPS Property Change Event Triggered",
-          "CHASSIS_ID", id);
-    std::string statusInterface;
-    std::map<std::string, std::variant<uint, bool>> msgData;
-    msg.read(statusInterface, msgData);
-
-    // If the change is to any of the properties we are interested in, then call
-    // determineStatusOfPower(), which looks at all the power-related
-    // interfaces, to see if a power status change is needed
-    auto propertyMap = msgData.find("IsPresent");
-    if (propertyMap != msgData.end())
+    auto statusIter = properties.find("Status");
+    if (statusIter == properties.end())
     {
-        info("Chassis{CHASSIS_ID}: UPS presence changed to {UPS_PRES_INFO}",
-             "CHASSIS_ID", id, "UPS_PRES_INFO",
-             std::get<bool>(propertyMap->second));
-        determineStatusOfPower();
         return;
     }
 
-    propertyMap = msgData.find("State");
-    if (propertyMap != msgData.end())
+    const auto* statusStr = std::get_if<std::string>(&statusIter->second);
+    if (statusStr == nullptr)
     {
-        info("Chassis{CHASSIS_ID}: UPS State changed to {UPS_STATE}",
-             "CHASSIS_ID", id, "UPS_STATE",
-             std::get<uint>(propertyMap->second));
-        determineStatusOfPower();
         return;
     }
 
-    propertyMap = msgData.find("BatteryLevel");
-    if (propertyMap != msgData.end())
+    const bool fault =
+        (decoratorServer::PowerSystemInputs::convertStatusFromString(
+             *statusStr) == decoratorServer::PowerSystemInputs::Status::Fault);
+
+    auto psu = psuFaults.try_emplace(path, false).first;
+    if (psu->second == fault)
     {
-        info("Chassis{CHASSIS_ID}: UPS BatteryLevel changed to {UPS_BAT_LEVEL}",
-             "CHASSIS_ID", id, "UPS_BAT_LEVEL",
-             std::get<uint>(propertyMap->second));
-        determineStatusOfPower();
         return;
     }
-    return;
+
+    psu->second = fault;
+    if (fault)
+    {
+        warning("Chassis{CHASSIS_ID}: Power System Inputs status of {OBJ_PATH} "
+                "is in Fault state",
+                "CHASSIS_ID", id, "OBJ_PATH", path);
+        ++faultedPSUCount;
+    }
+    else
+    {
+        --faultedPSUCount;
+    }
 }
 
 void Chassis::powerSysInputsChangeEvent(sdbusplus::message_t& msg)
@@ -461,71 +488,173 @@ void Chassis::powerSysInputsChangeEvent(sdbusplus::message_t& msg)
           "Triggered",
           "CHASSIS_ID", id);
     std::string statusInterface;
-    std::map<std::string, std::variant<std::string>> msgData;
+    PowerInputProperties msgData;
     msg.read(statusInterface, msgData);
 
-    // If the change is to any of the properties we are interested in, then call
-    // determineStatusOfPower(), which looks at all the power-related
-    // interfaces, to see if a power status change is needed
     auto propertyMap = msgData.find("Status");
     if (propertyMap != msgData.end())
     {
-        info("Chassis{CHASSIS_ID}: Power System Inputs status changed to "
-             "{POWER_SYS_INPUT_STATUS}",
-             "CHASSIS_ID", id, "POWER_SYS_INPUT_STATUS",
-             std::get<std::string>(propertyMap->second));
+        if (const auto* status =
+                std::get_if<std::string>(&propertyMap->second))
+        {
+            info("Chassis{CHASSIS_ID}: Power System Inputs status changed to "
+                 "{POWER_SYS_INPUT_STATUS}",
+                 "CHASSIS_ID", id, "POWER_SYS_INPUT_STATUS", *status);
+        }
+        updatePSUDevice(msg.get_path(), msgData);
         determineStatusOfPower();
-        return;
     }
-    return;
+}
+
+void Chassis::powerInputsAddedEvent(const std::string& path,
+                                    sdbusplus::message_t& msg)
+{
+    std::map<std::string, PowerInputProperties> interfaces;
+    msg.read(interfaces);
+
+    auto psu = interfaces.find(decoratorServer::PowerSystemInputs::interface);
+    if (psu != interfaces.end())
+    {
+        info("Chassis{CHASSIS_ID}: Power supply {OBJ_PATH} added",
+             "CHASSIS_ID", id, "OBJ_PATH", path);
+        updatePSUDevice(path, psu->second);
+    }
+
+    determineStatusOfPower();
+}
+
+void Chassis::powerInputsRemovedEvent(const std::string& path,
+                                      sdbusplus::message_t& msg)
+{
+    std::vector<std::string> interfaces;
+    msg.read(interfaces);
+
+    for (const auto& interface : interfaces)
+    {
+        if (interface == decoratorServer::PowerSystemInputs::interface)
+        {
+            auto psu = psuFaults.find(path);
+            if (psu != psuFaults.end())
+            {
+                info("Chassis{CHASSIS_ID}: Power supply {OBJ_PATH} removed",
+                     "CHASSIS_ID", id, "OBJ_PATH", path);
+                if (psu->second)
+                {
+                    --faultedPSUCount;
+                }
+                psuFaults.erase(psu);
+            }
+        }
+    }
+
+    determineStatusOfPower();
 }
 
 void Chassis::startUnit(const std::string& sysdUnit)
 {
-    auto method =
-        this->bus.new_method_call(SYSTEMD_SERVICE, SYSTEMD_OBJ_PATH,
-                                  SYSTEMD_MANAGER_INTERFACE, "StartUnit");
+    submitUnitJob("StartUnit", sysdUnit);
+}
+
+void Chassis::restartUnit(const std::string& sysdUnit)
+{
+    submitUnitJob("RestartUnit", sysdUnit);
+}
 
-    method.append(sysdUnit);
-    method.append("replace");
+void Chassis::submitUnitJob(const std::string& method,
+                            const std::string& sysdUnit)
+{
+    auto call = this->bus.new_method_call(SYSTEMD_SERVICE, SYSTEMD_OBJ_PATH,
+                                          SYSTEMD_MANAGER_INTERFACE,
+                                          method.c_str());
+
+    call.append(sysdUnit);
+    call.append("replace");
 
     try
     {
-        this->bus.call_noreply(method);
+        // Don't wait for systemd to queue the job, the reply (job object
+        // path or error) is processed from the event loop
+        pendingUnitCalls.call(nextUnitCallId++, call,
+                              [this, method, sysdUnit](auto& reply) {
+                                  unitJobSubmitted(method, sysdUnit, reply);
+                              });
     }
     catch (const sdbusplus::exception_t& e)
     {
-        error("Failed to start unit {UNIT}, exception:{ERROR}", "UNIT",
-              sysdUnit, "ERROR", e);
+        error("Chassis{CHASSIS_ID}: Failed to send {METHOD} for unit {UNIT}, "
+              "exception:{ERROR}",
+              "CHASSIS_ID", id, "METHOD", method, "UNIT", sysdUnit, "ERROR", e);
         throw;
     }
-    return;
 }
 
-void Chassis::restartUnit(const std::string& sysdUnit)
+void Chassis::unitJobSubmitted(const std::string& method,
+                               const std::string& sysdUnit,
+                               sdbusplus::message_t& reply)
 {
-    auto method =
-        this->bus.new_method_call(SYSTEMD_SERVICE, SYSTEMD_OBJ_PATH,
-                                  SYSTEMD_MANAGER_INTERFACE, "RestartUnit");
-
-    method.append(sysdUnit);
-    method.append("replace");
+    if (reply.is_method_error())
+    {
+        const auto* e = reply.get_error();
+        error("Chassis{CHASSIS_ID}: {METHOD} failed for unit {UNIT}, "
+              "error:{ERROR}, description:{DESCRIPTION}",
+              "CHASSIS_ID", id, "METHOD", method, "UNIT", sysdUnit, "ERROR",
+              (e && e->name) ? e->name : "", "DESCRIPTION",
+              (e && e->message) ? e->message : "");
+        unitJobFailed(sysdUnit, (e && e->name) ? e->name : method);
+        return;
+    }
 
     try
     {
-        this->bus.call_noreply(method);
+        auto job = reply.unpack<sdbusplus::object_path>();
+        debug("Chassis{CHASSIS_ID}: {METHOD} queued job {JOB} for unit "
+              "{UNIT}",
+              "CHASSIS_ID", id, "METHOD", method, "JOB", job.str, "UNIT",
+              sysdUnit);
+        unitJobs.queued(sysdUnit, job.str);
     }
     catch (const sdbusplus::exception_t& e)
     {
-        error("Failed to restart unit {UNIT}, exception:{ERROR}", "UNIT",
-              sysdUnit, "ERROR", e);
-        throw;
+        error("Chassis{CHASSIS_ID}: Bad {METHOD} reply for unit {UNIT}: "
+              "{ERROR}",
+              "CHASSIS_ID", id, "METHOD", method, "UNIT", sysdUnit, "ERROR",
+              e);
+    }
+}
+
+void Chassis::unitJobFailed(const std::string& sysdUnit,
+                            const std::string& reason)
+{
+    auto transition = server::Chassis::requestedPowerTransition();
+    auto target = systemdTargetTable.find(transition);
+    if ((target == systemdTargetTable.end()) || (target->second != sysdUnit))
+    {
+        // Not started for the transition in progress, e.g. a job replaced
+        // by a newer request
+        return;
     }
-    return;
+
+    error("Chassis{CHASSIS_ID}: Chassis power transition {TRANSITION} "
+          "failed: {REASON}",
+          "CHASSIS_ID", id, "TRANSITION", transition, "REASON", reason);
+    transitionLatency.cancel(convertForMessage(transition));
+
+    auto state = server::Chassis::currentPowerState();
+    server::Chassis::requestedPowerTransition(
+        ((state == PowerState::On) || (state == PowerState::TransitioningToOn))
+            ? Transition::On
+            : Transition::Off);
 }
 
-int Chassis::sysStateChange(sdbusplus::message_t& msg)
+bool Chassis::sysStateChange(sdbusplus::message_t& msg)
 {
+    // The initial state isn't known yet, apply the change after it
+    if (!discovered)
+    {
+        deferredJobSignals.emplace_back(msg.get());
+        return false;
+    }
+
     sdbusplus::object_path newStateObjPath;
     std::string newStateUnit{};
     std::string newStateResult{};
@@ -543,25 +672,44 @@ int Chassis::sysStateChange(sdbusplus::message_t& msg)
         error("Chassis{CHASSIS_ID}: Error in state change - bad encoding: "
               "{ERROR} {REPLY_SIG}",
               "CHASSIS_ID", id, "ERROR", e, "REPLY_SIG", msg.get_signature());
-        return 0;
+        return false;
+    }
+
+    if (auto result = unitJobs.removed(newStateUnit, newStateObjPath.str,
+                                       newStateResult))
+    {
+        info("Chassis{CHASSIS_ID}: Job {JOB} for unit {UNIT} finished with "
+             "result {RESULT}",
+             "CHASSIS_ID", id, "JOB", newStateObjPath.str, "UNIT",
+             newStateUnit, "RESULT", *result);
+        if (!utils::UnitJobs::succeeded(*result))
+        {
+            unitJobFailed(newStateUnit, *result);
+            return true;
+        }
     }
 
     if ((newStateUnit == std::format(CHASSIS_STATE_POWEROFF_TGT_FMT, id)) &&
-        (newStateResult == "done") && (utils::stateActive(bus, newStateUnit)))
+        (newStateResult == "done") && (unitStates.stateActive(newStateUnit)))
     {
         info("Chassis{CHASSIS_ID}: Received signal that power OFF is complete",
              "CHASSIS_ID", id);
         this->currentPowerState(server::Chassis::PowerState::Off);
         this->setStateChangeTime();
+        transitionLatency.complete(convertForMessage(Transition::Off));
+        return true;
     }
     else if ((newStateUnit == systemdTargetTable[Transition::On]) &&
              (newStateResult == "done") &&
-             (utils::stateActive(bus, newStateUnit)))
+             (unitStates.stateActive(newStateUnit)))
     {
         info("Chassis{CHASSIS_ID}: Received signal that power ON is complete",
              "CHASSIS_ID", id);
         this->currentPowerState(server::Chassis::PowerState::On);
         this->setStateChangeTime();
+        transitionLatency.complete(convertForMessage(Transition::On));
+        transitionLatency.completeCycle(
+            convertForMessage(Transition::PowerCycle));
 
         // Remove temporary file which is utilized for scenarios where the
         // BMC is rebooted while the chassis power is still on.
@@ -573,9 +721,10 @@ int Chassis::sysStateChange(sdbusplus::message_t& msg)
         {
             std::filesystem::remove(chassisFile);
         }
+        return true;
     }
 
-    return 0;
+    return false;
 }
 
 Chassis::Transition Chassis::requestedPowerTransition(Transition value)
@@ -620,6 +769,7 @@ Chassis::Transition Chassis::requestedPowerTransition(Transition value)
     }
 
     startUnit(iter->second);
+    transitionLatency.start(convertForMessage(value));
     return server::Chassis::requestedPowerTransition(value);
 }
 
@@ -631,10 +781,14 @@ Chassis::PowerState Chassis::currentPowerState(PowerState value)
          "CHASSIS_ID", id, "CUR_POWER_STATE", value);
 
     chassisPowerState = server::Chassis::currentPowerState(value);
-    if (chassisPowerState == PowerState::On)
+    if (chassisPowerState != PowerState::On)
     {
-        pohTimer.resetRemaining();
+        // A power cycle only completes once back on after this
+        transitionLatency.departed();
     }
+
+    // Account the power on time at each transition
+    powerOnTime.powerChanged(chassisPowerState == PowerState::On);
     return chassisPowerState;
 }
 
@@ -642,114 +796,101 @@ uint32_t Chassis::pohCounter(uint32_t value)
 {
     if (value != pohCounter())
     {
-        ChassisInherit::pohCounter(value);
-        serializePOH();
+        powerOnTime.reset(value);
     }
     return pohCounter();
 }
 
-void Chassis::pohCallback()
-{
-    if (ChassisInherit::currentPowerState() == PowerState::On)
-    {
-        pohCounter(pohCounter() + 1);
-    }
-}
-
 void Chassis::restorePOHCounter()
 {
-    uint32_t counter;
-    if (!deserializePOH(counter))
-    {
-        // set to default value
-        pohCounter(0);
-    }
-    else
-    {
-        pohCounter(counter);
-    }
+    powerOnTime.restore(std::format(POH_COUNTER_PERSIST_PATH, id),
+                        ChassisInherit::currentPowerState() == PowerState::On);
 }
 
-fs::path Chassis::serializePOH()
+int Chassis::startPOHCounter()
 {
-    fs::path path{std::format(POH_COUNTER_PERSIST_PATH, id)};
-    std::ofstream os(path.c_str(), std::ios::binary);
-    cereal::JSONOutputArchive oarchive(os);
-    oarchive(pohCounter());
-    return path;
+    return runEventLoop(bus);
 }
 
-bool Chassis::deserializePOH(uint32_t& pohCounter)
+int Chassis::runEventLoop(sdbusplus::bus_t& bus)
 {
-    fs::path path{std::format(POH_COUNTER_PERSIST_PATH, id)};
-    try
-    {
-        if (fs::exists(path))
-        {
-            std::ifstream is(path.c_str(), std::ios::in | std::ios::binary);
-            cereal::JSONInputArchive iarchive(is);
-            iarchive(pohCounter);
-            return true;
-        }
-        return false;
-    }
-    catch (const cereal::Exception& e)
-    {
-        error("Chassis{CHASSIS_ID}: deserialize exception: {ERROR}",
-              "CHASSIS_ID", id, "ERROR", e);
-        fs::remove(path);
-        return false;
-    }
-    catch (const fs::filesystem_error& e)
-    {
-        return false;
-    }
-
-    return false;
-}
-
-void Chassis::startPOHCounter()
-{
-    auto dir = fs::path(POH_COUNTER_PERSIST_PATH).parent_path();
+    auto dir = fs::path(POH_SECONDS_PERSIST_PATH).parent_path();
     fs::create_directories(dir);
 
     try
     {
         auto event = sdeventplus::Event::get_default();
         bus.attach_event(event.get(), SD_EVENT_PRIORITY_NORMAL);
-        event.loop();
+
+        // Exit the loop on a service stop so pending persisted data is
+        // written when the chassis objects are destroyed
+        auto terminate = exitOnTerminate(event);
+        return event.loop();
     }
     catch (const sdeventplus::SdEventError& e)
     {
-        error(
-            "Chassis{CHASSIS_ID}: Error occurred during the sdeventplus loop: "
-            "{ERROR}",
-            "CHASSIS_ID", id, "ERROR", e);
+        error("Error occurred during the sdeventplus loop: {ERROR}", "ERROR",
+              e);
         phosphor::logging::commit<InternalFailure>();
     }
+    return EXIT_FAILURE;
 }
 
 void Chassis::serializeStateChangeTime()
 {
-    fs::path path{std::format(CHASSIS_STATE_CHANGE_PERSIST_PATH, id)};
-    std::ofstream os(path.c_str(), std::ios::binary);
-    cereal::JSONOutputArchive oarchive(os);
+    stateChangeFile.update();
+}
 
-    oarchive(ChassisInherit::lastStateChangeTime(),
-             ChassisInherit::currentPowerState());
+Chassis::StateChangeData Chassis::stateChangeData() const
+{
+    return StateChangeData{
+        ChassisInherit::lastStateChangeTime(),
+        EnumString(convertForMessage(ChassisInherit::currentPowerState()))};
 }
 
 bool Chassis::deserializeStateChangeTime(uint64_t& time, PowerState& state)
 {
+    // Make sure the journal isn't behind a coalesced update
+    stateChangeFile.flush();
+
+    StateChangeData data{};
+    if (stateChangeFile.restore(data))
+    {
+        try
+        {
+            time = data.time;
+            state = convertPowerStateFromString(data.powerState.str());
+            return true;
+        }
+        catch (const std::exception& e)
+        {
+            error("Chassis{CHASSIS_ID}: Invalid persisted power state: "
+                  "{ERROR}",
+                  "CHASSIS_ID", id, "ERROR", e);
+            return false;
+        }
+    }
+
     fs::path path{std::format(CHASSIS_STATE_CHANGE_PERSIST_PATH, id)};
 
     try
     {
         if (fs::exists(path))
         {
-            std::ifstream is(path.c_str(), std::ios::in | std::ios::binary);
-            cereal::JSONInputArchive iarchive(is);
-            iarchive(time, state);
+            {
+                std::ifstream is(path.c_str(),
+                                 std::ios::in | std::ios::binary);
+                cereal::JSONInputArchive iarchive(is);
+                iarchive(time, state);
+            }
+
+            info("Chassis{CHASSIS_ID}: Migrating state change time from "
+                 "{LEGACY} to {PATH}",
+                 "CHASSIS_ID", id, "LEGACY", path, "PATH",
+                 stateChangeFile.path());
+            stateChangeFile.store(StateChangeData{
+                time, EnumString(convertForMessage(state))});
+            fs::remove(path);
             return true;
         }
     }
@@ -770,10 +911,12 @@ void Chassis::restoreChassisStateChangeTime()
 
     if (!deserializeStateChangeTime(time, state))
     {
+        lastStateChange.reset();
         ChassisInherit::lastStateChangeTime(0);
     }
     else
     {
+        lastStateChange.emplace(time, state);
         ChassisInherit::lastStateChangeTime(time);
     }
 }
@@ -781,8 +924,6 @@ void Chassis::restoreChassisStateChangeTime()
 void Chassis::setStateChangeTime()
 {
     using namespace std::chrono;
-    uint64_t lastTime;
-    PowerState lastState;
 
     auto now =
         duration_cast<milliseconds>(system_clock::now().time_since_epoch())
@@ -792,15 +933,14 @@ void Chassis::setStateChangeTime()
     // because sysStateChange() runs.  Since the power state didn't change
     // in this case, neither should the state change time, so check that
     // the power state actually did change here.
-    if (deserializeStateChangeTime(lastTime, lastState))
+    auto state = ChassisInherit::currentPowerState();
+    if (lastStateChange && (lastStateChange->second == state))
     {
-        if (lastState == ChassisInherit::currentPowerState())
-        {
-            return;
-        }
+        return;
     }
 
     ChassisInherit::lastStateChangeTime(now);
+    lastStateChange.emplace(now, state);
     serializeStateChangeTime();
 }
 
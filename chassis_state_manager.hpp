@@ -2,18 +2,30 @@
 
 #include "config.h"
 
+#include "persistent_file.hpp"
+#include "power_on_time.hpp"
+#include "power_supply_signals.hpp"
+#include "statistics.hpp"
+#include "transition_latency.hpp"
+#include "upower_devices.hpp"
 #include "utils.hpp"
 
 #include <cereal/cereal.hpp>
 #include <sdbusplus/bus.hpp>
-#include <sdeventplus/clock.hpp>
 #include <sdeventplus/event.hpp>
-#include <sdeventplus/utility/timer.hpp>
 #include <xyz/openbmc_project/State/Chassis/server.hpp>
 #include <xyz/openbmc_project/State/PowerOnHours/server.hpp>
 
 #include <chrono>
 #include <filesystem>
+#include <format>
+#include <functional>
+#include <map>
+#include <optional>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
 
 namespace phosphor::state::manager
 {
@@ -32,45 +44,85 @@ namespace fs = std::filesystem;
 class Chassis : public ChassisInherit
 {
   public:
+    /** @brief Called when the initial state discovery failed */
+    using DiscoveryFailure = std::function<void()>;
+
     /** @brief Constructs Chassis State Manager
      *
      * @note This constructor passes 'true' to the base class in order to
-     *       defer dbus object registration until we can run
-     *       determineInitialState() and set our properties
+     *       defer dbus object registration until discoveryComplete()
+     *       has set our properties
      *
      * @param[in] bus       - The Dbus bus object
      * @param[in] objPath   - The Dbus object path
      * @param[in] id        - Chassis id
+     * @param[in] onDiscoveryFailure - Called if the initial state can't be
+     *                        discovered, empty to exit the event loop with a
+     *                        failure
      */
     Chassis(sdbusplus::bus_t& bus, const sdbusplus::object_path& objPath,
-            size_t id) :
+            size_t id, DiscoveryFailure onDiscoveryFailure = {}) :
         ChassisInherit(bus, objPath, ChassisInherit::action::defer_emit),
-        bus(bus),
-        systemdSignals(
-            bus,
-            sdbusRule::type::signal() + sdbusRule::member("JobRemoved") +
-                sdbusRule::path(SYSTEMD_OBJ_PATH) +
-                sdbusRule::interface(SYSTEMD_MANAGER_INTERFACE),
-            [this](sdbusplus::message_t& m) { sysStateChange(m); }),
-        id(id),
-        pohTimer(
-            sdeventplus::Event::get_default(), [this](auto&) { pohCallback(); },
-            std::chrono::hours{1}, std::chrono::minutes{1})
+        bus(bus), unitStates(bus),
+        systemdSignals(bus, "JobRemoved",
+                       [this](sdbusplus::message_t& m) {
+                           return sysStateChange(m);
+                       }),
+        upower(UPowerDevices::shared(bus)),
+        powerSupplies(PowerSupplySignals::shared(bus)), id(id),
+        onDiscoveryFailure(std::move(onDiscoveryFailure)),
+        persistStatistics(bus, objPath.str,
+                          utils::PERSIST_STATISTICS_INTERFACE),
+        powerOnTime(
+            sdeventplus::Event::get_default(),
+            std::format(POH_SECONDS_PERSIST_PATH, id),
+            std::chrono::seconds{POH_CHECKPOINT_INTERVAL_S},
+            std::chrono::milliseconds(PERSIST_WRITE_WINDOW_MS),
+            [this](uint32_t hours) { ChassisInherit::pohCounter(hours); }),
+        stateChangeFile(
+            sdeventplus::Event::get_default(),
+            std::format(CHASSIS_STATE_CHANGE_PERSIST_PATH, id) +
+                JOURNAL_FILE_SUFFIX,
+            stateChangePersistVersion,
+            [this]() { return stateChangeData(); },
+            std::chrono::milliseconds(PERSIST_WRITE_WINDOW_MS)),
+        transitionLatency(
+            bus, sdeventplus::Event::get_default(), objPath.str,
+            std::format(CHASSIS_TRANSITION_LATENCY_PERSIST_PATH, id))
     {
         utils::subscribeToSystemdSignals(bus);
 
         createSystemdTargetTable();
 
-        restoreChassisStateChangeTime();
+        powerOnTime.publishWritesTo(persistStatistics);
+        stateChangeFile.publishTo(persistStatistics);
+        transitionLatency.publishWritesTo(persistStatistics);
+
+        // Phases are named per chassis as a process can host several
+        auto& startup = utils::StartupTimer::instance();
+        {
+            auto phase = startup.phase(
+                std::format("chassis{}.restore_state_change", id));
+            restoreChassisStateChangeTime();
+        }
 
         // No default in PDI so start at Good, skip D-Bus signal for now
         currentPowerStatus(PowerStatus::Good, true);
-        determineInitialState();
 
-        restorePOHCounter(); // restore POHCounter from persisted file
+        // The UPS model is kept up to date from now on
+        upower->subscribe(id, [this]() { determineStatusOfPower(); });
+
+        // The replies are handled from the event loop, discoveryComplete()
+        // then sets up the rest of the initial state and adds the object
+        initialStatePhase.emplace(
+            startup, std::format("chassis{}.initial_state", id));
+        determineInitialState();
+    }
 
-        // We deferred this until we could get our property correct
-        this->emit_object_added();
+    ~Chassis() override
+    {
+        upower->unsubscribe(id);
+        powerSupplies->unsubscribe(id);
     }
 
     /** @brief Set value of RequestedPowerTransition */
@@ -82,34 +134,108 @@ class Chassis : public ChassisInherit
     /** @brief Get value of POHCounter */
     using ChassisInherit::pohCounter;
 
-    /** @brief Increment POHCounter if Chassis Power state is ON */
-    void startPOHCounter();
+    /** @brief Run the event loop, which checkpoints the power on time
+     *
+     *  @return The exit code of the event loop
+     */
+    int startPOHCounter();
+
+    /** @brief Run the event loop of all the chassis on a bus
+     *
+     *  Used when several chassis share the process, so the loop doesn't
+     *  depend on any one of them staying alive.
+     *
+     *  @param[in] bus       - The Dbus bus object the chassis are on
+     *
+     *  @return The exit code of the event loop
+     */
+    static int runEventLoop(sdbusplus::bus_t& bus);
 
   private:
     /** @brief Create systemd target instance names and mapping table */
     void createSystemdTargetTable();
 
-    /** @brief Determine initial chassis state and set internally */
+    /** @brief Start determining the initial chassis state
+     *
+     *  Installs the power input signal matches and sends the discovery
+     *  calls. The state is set in discoveryComplete() once every call has
+     *  been replied to.
+     */
     void determineInitialState();
 
-    /** @brief Determine status of power into system by examining all the
-     *        power-related interfaces of interest
+    /** @brief Set the initial chassis state from the discovery replies
+     *
+     *  Sets the power status and state, restores the power on time, adds
+     *  the object to D-Bus and handles the systemd job signals received
+     *  during discovery. Reports a failure through onDiscoveryFailure if the
+     *  power inputs couldn't be read, as the power status can't be
+     *  determined.
+     */
+    void discoveryComplete();
+
+    /** @brief Set the initial power state from the discovered pgood state
+     *
+     *  Handles the power having been lost while the BMC was down.
+     */
+    void setInitialPowerState();
+
+    /** @brief Set CurrentPowerStatus from the power input model
+     *
+     *  Uses the UPS and PSU fault counts kept by the model, so no D-Bus calls
+     *  are made.
      */
     void determineStatusOfPower();
 
-    /** @brief Determine status of power provided by an Uninterruptible Power
-     *         Supply into the system
+    /** @brief Request the pgood state of the chassis power control
      *
-     *  @return True if UPS power is good, false otherwise
+     *  The reply sets initialPgood, which is left empty if it couldn't be
+     *  read.
      */
-    bool determineStatusOfUPSPower();
+    void readPgood();
+
+    /** @brief Request the UPower devices currently on D-Bus for the model */
+    void loadUPSDevices();
 
-    /** @brief Determine status of power provided by the power supply units into
-     *         the system
+    /** @brief Request this chassis' power supplies currently on D-Bus for
+     *         the model
+     */
+    void loadPSUDevices();
+
+    /** @brief Find the objects implementing an interface below a path and
+     *         load their properties into the power input model
+     *
+     *  @param[in] phase      - Discovery phase the calls belong to
+     *  @param[in] root       - Root path of the subtree to search
+     *  @param[in] interface  - Interface to look for
+     *  @param[in] update     - Adds an object's properties to the model
+     */
+    void loadPowerInputs(
+        const std::string& phase, const std::string& root,
+        const std::string& interface,
+        std::function<void(const std::string&, const PowerInputProperties&)>
+            update);
+
+    /** @brief Send a method call of the initial state discovery
+     *
+     *  Calls are sent asynchronously so the independent queries overlap.
+     *  The reply is handled from the event loop, and the last one calls
+     *  discoveryComplete().
      *
-     *  @return True if PSU power is good, false otherwise
+     *  @param[in] phase      - Discovery phase the call belongs to, for
+     *                          timing
+     *  @param[in] method     - The method call
+     *  @param[in] handler    - Handles the reply, including error replies
      */
-    bool determineStatusOfPSUPower();
+    void discoveryCall(const std::string& phase, sdbusplus::message_t& method,
+                       std::function<void(sdbusplus::message_t&)> handler);
+
+    /** @brief Update a power supply in the model
+     *
+     *  @param[in] path       - Object path of the power supply
+     *  @param[in] properties - Properties to update, others are kept
+     */
+    void updatePSUDevice(const std::string& path,
+                         const PowerInputProperties& properties);
 
     /** @brief Start the systemd unit requested
      *
@@ -128,6 +254,43 @@ class Chassis : public ChassisInherit
      */
     void restartUnit(const std::string& sysdUnit);
 
+    /** @brief Submit a systemd job without waiting for systemd to reply
+     *
+     * The method call is sent asynchronously so the event loop keeps running
+     * while systemd queues the job. The reply is handled by
+     * unitJobSubmitted().
+     *
+     * @param[in] method      - Systemd manager method (StartUnit/RestartUnit)
+     * @param[in] sysdUnit    - Systemd unit
+     */
+    void submitUnitJob(const std::string& method, const std::string& sysdUnit);
+
+    /** @brief Handle the reply to an asynchronous systemd job submission
+     *
+     * Records the returned job object path so the matching JobRemoved
+     * signal can be correlated with the request, or fails the transition
+     * the unit was started for.
+     *
+     * @param[in] method      - Systemd manager method that was called
+     * @param[in] sysdUnit    - Systemd unit
+     * @param[in] reply       - Method reply from systemd
+     */
+    void unitJobSubmitted(const std::string& method,
+                          const std::string& sysdUnit,
+                          sdbusplus::message_t& reply);
+
+    /** @brief Handle a systemd job of this object that didn't succeed
+     *
+     * If the unit is the target of the requested power transition, the
+     * transition is abandoned: its latency sample is dropped and
+     * RequestedPowerTransition goes back to the transition matching the
+     * current power state, so clients see the request didn't happen.
+     *
+     * @param[in] sysdUnit    - Systemd unit
+     * @param[in] reason      - The D-Bus error or job result
+     */
+    void unitJobFailed(const std::string& sysdUnit, const std::string& reason);
+
     /** @brief Check if systemd state change is relevant to this object
      *
      * Instance specific interface to handle the detected systemd state
@@ -135,82 +298,113 @@ class Chassis : public ChassisInherit
      *
      * @param[in]  msg       - Data associated with subscribed signal
      *
+     * @return true if the chassis state was updated
      */
-    int sysStateChange(sdbusplus::message_t& msg);
+    bool sysStateChange(sdbusplus::message_t& msg);
 
     /** @brief Persistent sdbusplus DBus connection. */
     sdbusplus::bus_t& bus;
 
-    /** @brief Used to subscribe to dbus systemd signals **/
-    sdbusplus::match systemdSignals;
+    /** @brief ActiveState of the systemd targets this object watches **/
+    utils::UnitStateCache unitStates;
+
+    /** @brief Used to subscribe to dbus systemd JobRemoved signals **/
+    utils::SystemdJobSignals systemdSignals;
+
+    /** @brief UPower device model shared by the chassis of this process **/
+    std::shared_ptr<UPowerDevices> upower;
 
-    /** @brief Watch for any changes to UPS properties **/
-    std::unique_ptr<sdbusplus::match> uPowerPropChangeSignal;
+    /** @brief Power supply signal matches shared by the chassis of this
+     *  process **/
+    std::shared_ptr<PowerSupplySignals> powerSupplies;
 
-    /** @brief Watch for any changes to PowerSystemInputs properties **/
-    std::unique_ptr<sdbusplus::match> powerSysInputsPropChangeSignal;
+    /** @brief Fault state of this chassis' power supplies keyed by object
+     *  path. **/
+    std::map<std::string, bool> psuFaults;
+
+    /** @brief Number of entries in psuFaults that are in fault. **/
+    size_t faultedPSUCount = 0;
 
     /** @brief Chassis id. **/
     const size_t id = 0;
 
-    /** @brief Transition state to systemd target mapping table. **/
-    std::map<Transition, std::string> systemdTargetTable;
+    /** @brief Outstanding asynchronous systemd job submissions. **/
+    utils::PendingCalls<uint64_t> pendingUnitCalls;
 
-    /** @brief Used to Set value of POHCounter */
-    uint32_t pohCounter(uint32_t value) override;
+    /** @brief Key used for the next entry in pendingUnitCalls. **/
+    uint64_t nextUnitCallId = 0;
 
-    /** @brief Used by the timer to update the POHCounter */
-    void pohCallback();
+    /** @brief Outstanding initial state discovery calls. **/
+    utils::PendingCalls<uint64_t> discoveryCalls;
 
-    /** @brief Used to restore POHCounter value from persisted file */
-    void restorePOHCounter();
+    /** @brief Key used for the next entry in discoveryCalls. **/
+    uint64_t nextDiscoveryCallId = 0;
 
-    /** @brief Serialize and persist requested POH counter.
-     *
-     *  @return fs::path - pathname of persisted requested POH counter.
-     */
-    fs::path serializePOH();
+    /** @brief Outstanding discovery calls of each phase. **/
+    std::map<std::string, size_t> discoveryPending;
 
-    /** @brief Deserialize a persisted requested POH counter.
-     *
-     *  @param[in] retCounter - deserialized POH counter value
-     *
-     *  @return bool - true if the deserialization was successful, false
-     *                 otherwise.
-     */
-    bool deserializePOH(uint32_t& retCounter);
+    /** @brief Time from the start of discovery to the last reply of each
+     *  phase. **/
+    std::map<std::string, std::chrono::steady_clock::duration> discoveryTimes;
 
-    /** @brief Sets the LastStateChangeTime property and persists it. */
-    void setStateChangeTime();
+    /** @brief Start of the initial state discovery. **/
+    std::chrono::steady_clock::time_point discoveryStart;
 
-    /** @brief Serialize the last power state change time.
-     *
-     *  Save the time the state changed and the state itself.
-     *  The state needs to be saved as well so that during rediscovery
-     *  on reboots there's a way to know not to update the time again.
-     */
-    void serializeStateChangeTime();
+    /** @brief A discovery reply that the power input model needs failed. **/
+    bool discoveryFailed = false;
 
-    /** @brief Deserialize the last power state change time.
-     *
-     *  @param[out] time - Deserialized time
-     *  @param[out] state - Deserialized power state
+    /** @brief Called if the initial state can't be discovered. **/
+    DiscoveryFailure onDiscoveryFailure;
+
+    /** @brief The discovered pgood state, empty if it couldn't be read. **/
+    std::optional<int> initialPgood;
+
+    /** @brief The initial state is set and the object added to D-Bus. **/
+    bool discovered = false;
+
+    /** @brief This object loads the shared UPower device model. **/
+    bool upowerLoader = false;
+
+    /** @brief Systemd job signals received before discovery completed. **/
+    std::vector<sdbusplus::message_t> deferredJobSignals;
+
+    /** @brief Times the initial state discovery. **/
+    std::optional<utils::StartupTimer::Phase> initialStatePhase;
+
+    /** @brief Systemd jobs of units started by this object. **/
+    utils::UnitJobs unitJobs;
+
+    /** @brief Transition state to systemd target mapping table. **/
+    std::map<Transition, std::string> systemdTargetTable;
+
+    /** @brief Used to Set value of POHCounter
      *
-     *  @return bool - true if successful, false otherwise.
+     *  Resets the power on time to the given number of hours.
      */
-    bool deserializeStateChangeTime(uint64_t& time, PowerState& state);
+    uint32_t pohCounter(uint32_t value) override;
+
+    /** @brief Used to restore the power on time from persisted file */
+    void restorePOHCounter();
 
-    /** @brief Restores the power state change time.
+    /** @brief Last persisted power state change time and power state
      *
-     *  The time is loaded into the LastStateChangeTime D-Bus property.
-     *  On the very first start after this code has been applied but
-     *  before the state has changed, the LastStateChangeTime value
-     *  will be zero.
+     *  Kept in sync with stateChangeFile so a power state change doesn't
+     *  need to read it back. Empty when nothing has been persisted yet.
      */
-    void restoreChassisStateChangeTime();
+    std::optional<std::pair<uint64_t, PowerState>> lastStateChange;
 
-    /** @brief Timer used for tracking power on hours */
-    sdeventplus::utility::Timer<sdeventplus::ClockId::Monotonic> pohTimer;
+    /** @brief Update and write counts of the persisted files, outlives
+     *  them */
+    utils::StatisticsInterface persistStatistics;
+
+    /** @brief Accumulated and persisted power on time */
+    PowerOnTime powerOnTime;
+
+    /** @brief Persisted last power state change time and power state */
+    PersistentFile<StateChangeData> stateChangeFile;
+
+    /** @brief Latency histograms of the chassis power transitions */
+    TransitionLatency transitionLatency;
 
     /** @brief Function to check for a standby voltage regulator fault
      *
@@ -221,25 +415,37 @@ class Chassis : public ChassisInherit
      */
     bool standbyVoltageRegulatorFault();
 
-    /** @brief Process UPS property changes
+    /** @brief Process PowerSystemInputs property changes
      *
-     * Instance specific interface to monitor for changes to the UPS
-     * properties which may impact CurrentPowerStatus
+     * Instance specific interface to monitor for changes to the
+     * PowerSystemInputs properties which may impact CurrentPowerStatus
      *
      * @param[in]  msg              - Data associated with subscribed signal
      *
      */
-    void uPowerChangeEvent(sdbusplus::message_t& msg);
+    void powerSysInputsChangeEvent(sdbusplus::message_t& msg);
 
-    /** @brief Process PowerSystemInputs property changes
+    /** @brief Process InterfacesAdded for power supplies
      *
-     * Instance specific interface to monitor for changes to the
-     * PowerSystemInputs properties which may impact CurrentPowerStatus
+     * Adds the new power supplies to the power input model
      *
-     * @param[in]  msg              - Data associated with subscribed signal
+     * @param[in]  path             - Object path of the power supply
+     * @param[in]  msg              - Signal data following the path
      *
      */
-    void powerSysInputsChangeEvent(sdbusplus::message_t& msg);
+    void powerInputsAddedEvent(const std::string& path,
+                               sdbusplus::message_t& msg);
+
+    /** @brief Process InterfacesRemoved for power supplies
+     *
+     * Drops the removed power supplies from the power input model
+     *
+     * @param[in]  path             - Object path of the power supply
+     * @param[in]  msg              - Signal data following the path
+     *
+     */
+    void powerInputsRemovedEvent(const std::string& path,
+                                 sdbusplus::message_t& msg);
 };
 
 } // namespace phosphor::state::manager
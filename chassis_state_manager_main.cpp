@@ -2,17 +2,24 @@
 
 #include "chassis_state_manager.hpp"
 #include "chassis_state_manager_smp.hpp"
+#include "hosted_instances.hpp"
+#include "statistics.hpp"
 
 #include <getopt.h>
 
 #include <phosphor-logging/lg2.hpp>
 #include <sdbusplus/bus.hpp>
+#include <sdeventplus/event.hpp>
 
 #include <cstdlib>
 #include <exception>
 #include <filesystem>
 #include <format>
 #include <iostream>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
 
 PHOSPHOR_LOG2_USING;
 
@@ -23,75 +30,294 @@ constexpr auto LEGACY_STATE_CHANGE_PERSIST_PATH =
 
 using ChassisState = sdbusplus::server::xyz::openbmc_project::state::Chassis;
 
+namespace fs = std::filesystem;
+
+/** @brief Object path of a chassis instance */
+static sdbusplus::object_path chassisPath(size_t chassisId)
+{
+    auto chassisName = std::string(ChassisState::namespace_path::chassis) +
+                       std::to_string(chassisId);
+    return sdbusplus::object_path(ChassisState::namespace_path::value) /
+           chassisName;
+}
+
+/** @brief Move the persisted files of a single chassis system to chassis0 */
+static void migrateLegacyFiles()
+{
+    // Chassis State Manager was only support single-chassis and there only
+    // two file to store persist values(POH and state change time), to
+    // support multi-chassis state management, each service access new file
+    // paths with prefix 'chassisN', if any legacy persist file is exist,
+    // rename it to the new file format of chassis0.
+
+    fs::path legacyPohPath{LEGACY_POH_COUNTER_PERSIST_PATH};
+    fs::path legacyStateChangePath{LEGACY_STATE_CHANGE_PERSIST_PATH};
+    fs::path newPohPath{std::format(POH_COUNTER_PERSIST_PATH, 0)};
+    fs::path newStateChangePath{
+        std::format(CHASSIS_STATE_CHANGE_PERSIST_PATH, 0)};
+    if (fs::exists(legacyPohPath))
+    {
+        try
+        {
+            fs::rename(legacyPohPath, newPohPath);
+        }
+        catch (const fs::filesystem_error& e)
+        {
+            error("Failed to rename legacy file {LEGACY} to {NEW}: {ERROR}",
+                  "LEGACY", legacyPohPath, "NEW", newPohPath, "ERROR", e);
+        }
+    }
+    if (fs::exists(legacyStateChangePath))
+    {
+        try
+        {
+            fs::rename(legacyStateChangePath, newStateChangePath);
+        }
+        catch (const fs::filesystem_error& e)
+        {
+            error("Failed to rename legacy file {LEGACY} to {NEW}: {ERROR}",
+                  "LEGACY", legacyStateChangePath, "NEW", newStateChangePath,
+                  "ERROR", e);
+        }
+    }
+}
+
+/** @brief Host the chassis of a range of ids in this process
+ *
+ * The instances share the bus connection, the systemd subscription, the
+ * UPower device model, the power supply matches and the event loop. Each one
+ * still only receives the signals of its own systemd units and power
+ * supplies. A chassis that fails to start, or whose initial state can't be
+ * discovered, is left out of the process. The process only fails once no
+ * chassis is left.
+ *
+ * @param[in] first      - First chassis id
+ * @param[in] last       - Last chassis id
+ *
+ * @return The process exit code
+ */
+static int hostChassisRange(size_t first, size_t last)
+{
+    if constexpr (ENABLE_MULTI_CHASSIS_SMP)
+    {
+        if (first == 0)
+        {
+            error("Chassis 0 is the SMP aggregator and can't be part of a "
+                  "chassis range");
+            return EXIT_FAILURE;
+        }
+
+        auto config = phosphor::state::manager::loadSMPConfig(
+            SMP_CONFIG_FILE, NUM_CHASSIS_SMP);
+        for (size_t chassisId = first; chassisId <= last; ++chassisId)
+        {
+            if (config.isGroup(chassisId))
+            {
+                error("Chassis {CHASSIS_ID} is an SMP group aggregator and "
+                      "can't be part of a chassis range",
+                      "CHASSIS_ID", chassisId);
+                return EXIT_FAILURE;
+            }
+        }
+    }
+
+    auto bus = sdbusplus::bus::new_default();
+
+    if (first == 0)
+    {
+        migrateLegacyFiles();
+    }
+
+    // Add sdbusplus ObjectManager.
+    sdbusplus::server::manager_t objManager(
+        bus, ChassisState::namespace_path::value);
+
+    // A chassis that fails later is dropped on its own, its bus name is
+    // released so another process can take it over
+    phosphor::state::manager::HostedInstances<
+        phosphor::state::manager::Chassis>
+        instances(sdeventplus::Event::get_default(), [&bus](size_t chassisId) {
+            error("Chassis{CHASSIS_ID}: Dropped after failing to discover its "
+                  "initial state",
+                  "CHASSIS_ID", chassisId);
+            if (chassisId == 0)
+            {
+                sd_bus_release_name(bus.get(), ChassisState::interface);
+            }
+            auto chassisBusName =
+                ChassisState::interface + std::to_string(chassisId);
+            sd_bus_release_name(bus.get(), chassisBusName.c_str());
+        });
+    for (size_t chassisId = first; chassisId <= last; ++chassisId)
+    {
+        try
+        {
+            instances.add(
+                chassisId,
+                std::make_unique<phosphor::state::manager::Chassis>(
+                    bus, chassisPath(chassisId), chassisId,
+                    [&instances, chassisId]() {
+                        instances.failed(chassisId);
+                    }));
+        }
+        catch (const std::exception& e)
+        {
+            // Don't take the rest of the range down with it
+            error("Chassis{CHASSIS_ID}: Failed to start: {ERROR}",
+                  "CHASSIS_ID", chassisId, "ERROR", e);
+        }
+    }
+
+    if (instances.empty())
+    {
+        error("None of chassis {FIRST} to {LAST} started", "FIRST", first,
+              "LAST", last);
+        return EXIT_FAILURE;
+    }
+
+    auto started = instances.ids();
+    for (auto chassisId : started)
+    {
+        // For backwards compatibility, request a busname without chassis id
+        // for chassis 0.
+        if (chassisId == 0)
+        {
+            bus.request_name(ChassisState::interface);
+        }
+
+        auto chassisBusName =
+            ChassisState::interface + std::to_string(chassisId);
+        bus.request_name(chassisBusName.c_str());
+    }
+
+    info("Hosting chassis {FIRST} to {LAST}", "FIRST", first, "LAST", last);
+    auto startupStatistics = phosphor::state::manager::utils::publishStartup(
+        bus, chassisPath(started.front()).str);
+
+    // All instances use the default event, so this runs the loop for all of
+    // them
+    return phosphor::state::manager::Chassis::runEventLoop(bus);
+}
+
+/** @brief Run the SMP aggregator of the partition of a host
+ *
+ * The aggregator is keyed by the host ID, it is published on its own path
+ * and bus name so it doesn't take the ID of any chassis.
+ *
+ * @param[in] hostId - The host ID
+ *
+ * @return The process exit code
+ */
+static int hostPartition(size_t hostId)
+{
+    if constexpr (!ENABLE_MULTI_CHASSIS_SMP)
+    {
+        error("Partitions need the multi-chassis SMP support");
+        return EXIT_FAILURE;
+    }
+
+    auto config = phosphor::state::manager::loadSMPConfig(SMP_CONFIG_FILE,
+                                                          NUM_CHASSIS_SMP);
+    if (!config.hasPartition(hostId))
+    {
+        error("Host {HOST_ID} has no SMP partition in {CONFIG}", "HOST_ID",
+              hostId, "CONFIG", SMP_CONFIG_FILE);
+        return EXIT_FAILURE;
+    }
+
+    auto bus = sdbusplus::bus::new_default();
+    sdbusplus::object_path objPath{std::format(
+        "{}{}", phosphor::state::manager::PARTITION_STATE_PATH_PREFIX, hostId)};
+
+    // Add sdbusplus ObjectManager.
+    sdbusplus::server::manager_t objManager(
+        bus, ChassisState::namespace_path::value);
+
+    phosphor::state::manager::ChassisSMP manager(
+        bus, objPath, NUM_CHASSIS_SMP,
+        phosphor::state::manager::SMPAggregator::partition(hostId), config);
+
+    auto busName = std::format("xyz.openbmc_project.State.Partition{}", hostId);
+    bus.request_name(busName.c_str());
+    auto startupStatistics =
+        phosphor::state::manager::utils::publishStartup(bus, objPath.str);
+
+    // The event loop runs the periodic state audit
+    auto event = sdeventplus::Event::get_default();
+    bus.attach_event(event.get(), SD_EVENT_PRIORITY_NORMAL);
+    return event.loop();
+}
+
 int main(int argc, char** argv)
 {
+    // Start-up timing is relative to this
+    phosphor::state::manager::utils::StartupTimer::instance();
+
     size_t chassisId = 0;
+    std::optional<std::pair<size_t, size_t>> chassisRange;
+    std::optional<size_t> partitionHost;
     int arg;
     int optIndex = 0;
     static struct option longOpts[] = {
-        {"chassis", required_argument, nullptr, 'c'}, {nullptr, 0, nullptr, 0}};
+        {"chassis", required_argument, nullptr, 'c'},
+        {"chassis-range", required_argument, nullptr, 'r'},
+        {"partition", required_argument, nullptr, 'p'},
+        {nullptr, 0, nullptr, 0}};
 
-    while ((arg = getopt_long(argc, argv, "c:", longOpts, &optIndex)) != -1)
+    while ((arg = getopt_long(argc, argv, "c:r:p:", longOpts, &optIndex)) !=
+           -1)
     {
         switch (arg)
         {
             case 'c':
                 chassisId = std::stoul(optarg);
                 break;
+            case 'r':
+            {
+                // FIRST-LAST, both included
+                std::string range{optarg};
+                auto separator = range.find('-');
+                if (separator == std::string::npos)
+                {
+                    std::cerr << "Invalid chassis range " << range << "\n";
+                    return EXIT_FAILURE;
+                }
+                chassisRange.emplace(std::stoul(range.substr(0, separator)),
+                                     std::stoul(range.substr(separator + 1)));
+                if (chassisRange->first > chassisRange->second)
+                {
+                    std::cerr << "Invalid chassis range " << range << "\n";
+                    return EXIT_FAILURE;
+                }
+                break;
+            }
+            case 'p':
+                partitionHost = std::stoul(optarg);
+                break;
             default:
                 break;
         }
     }
 
-    namespace fs = std::filesystem;
+    if (chassisRange)
+    {
+        return hostChassisRange(chassisRange->first, chassisRange->second);
+    }
+
+    if (partitionHost)
+    {
+        return hostPartition(*partitionHost);
+    }
 
     auto bus = sdbusplus::bus::new_default();
 
     auto chassisBusName = ChassisState::interface + std::to_string(chassisId);
     const auto* objPath = ChassisState::namespace_path::value;
-    auto chassisName = std::string(ChassisState::namespace_path::chassis) +
-                       std::to_string(chassisId);
-    sdbusplus::object_path objPathInst =
-        sdbusplus::object_path(objPath) / chassisName;
+    sdbusplus::object_path objPathInst = chassisPath(chassisId);
 
     if (chassisId == 0)
     {
-        // Chassis State Manager was only support single-chassis and there only
-        // two file to store persist values(POH and state change time), to
-        // support multi-chassis state management, each service access new file
-        // paths with prefix 'chassisN', if any legacy persist file is exist,
-        // rename it to the new file format of chassis0.
-
-        fs::path legacyPohPath{LEGACY_POH_COUNTER_PERSIST_PATH};
-        fs::path legacyStateChangePath{LEGACY_STATE_CHANGE_PERSIST_PATH};
-        fs::path newPohPath{std::format(POH_COUNTER_PERSIST_PATH, chassisId)};
-        fs::path newStateChangePath{
-            std::format(CHASSIS_STATE_CHANGE_PERSIST_PATH, chassisId)};
-        if (fs::exists(legacyPohPath))
-        {
-            try
-            {
-                fs::rename(legacyPohPath, newPohPath);
-            }
-            catch (const fs::filesystem_error& e)
-            {
-                error("Failed to rename legacy file {LEGACY} to {NEW}: {ERROR}",
-                      "LEGACY", legacyPohPath, "NEW", newPohPath, "ERROR", e);
-            }
-        }
-        if (fs::exists(legacyStateChangePath))
-        {
-            try
-            {
-                fs::rename(legacyStateChangePath, newStateChangePath);
-            }
-            catch (const fs::filesystem_error& e)
-            {
-                error("Failed to rename legacy file {LEGACY} to {NEW}: {ERROR}",
-                      "LEGACY", legacyStateChangePath, "NEW",
-                      newStateChangePath, "ERROR", e);
-            }
-        }
+        migrateLegacyFiles();
     }
 
     // Add sdbusplus ObjectManager.
@@ -99,21 +325,29 @@ int main(int argc, char** argv)
 
     if constexpr (ENABLE_MULTI_CHASSIS_SMP)
     {
-        if (chassisId == 0)
+        auto config = phosphor::state::manager::loadSMPConfig(
+            SMP_CONFIG_FILE, NUM_CHASSIS_SMP);
+
+        if ((chassisId == 0) || config.isGroup(chassisId))
         {
-            // Use SMP aggregator for chassis 0
-            phosphor::state::manager::ChassisSMP manager(bus, objPathInst,
-                                                         NUM_CHASSIS_SMP);
+            // Use SMP aggregator for chassis 0 and the group aggregators
+            phosphor::state::manager::ChassisSMP manager(
+                bus, objPathInst, NUM_CHASSIS_SMP, chassisId, config);
 
             // For backwards compatibility, request a busname without chassis id
-            bus.request_name(ChassisState::interface);
-            bus.request_name(chassisBusName.c_str());
-
-            while (true)
+            if (chassisId == 0)
             {
-                bus.process_discard();
-                bus.wait();
+                bus.request_name(ChassisState::interface);
             }
+            bus.request_name(chassisBusName.c_str());
+            auto startupStatistics =
+                phosphor::state::manager::utils::publishStartup(
+                    bus, objPathInst.str);
+
+            // The event loop runs the periodic state audit
+            auto event = sdeventplus::Event::get_default();
+            bus.attach_event(event.get(), SD_EVENT_PRIORITY_NORMAL);
+            return event.loop();
         }
         else
         {
@@ -123,7 +357,10 @@ int main(int argc, char** argv)
                                                       chassisId);
 
             bus.request_name(chassisBusName.c_str());
-            manager.startPOHCounter();
+            auto startupStatistics =
+                phosphor::state::manager::utils::publishStartup(
+                    bus, objPathInst.str);
+            return manager.startPOHCounter();
         }
     }
     else
@@ -139,8 +376,9 @@ int main(int argc, char** argv)
         }
 
         bus.request_name(chassisBusName.c_str());
-        manager.startPOHCounter();
+        auto startupStatistics =
+            phosphor::state::manager::utils::publishStartup(bus,
+                                                            objPathInst.str);
+        return manager.startPOHCounter();
     }
-
-    return 0;
 }
@@ -2,6 +2,8 @@
 
 #include "chassis_state_manager_smp.hpp"
 
+#include "chassis_smp_presence.hpp"
+#include "statistics.hpp"
 #include "utils.hpp"
 
 #include <phosphor-logging/elog-errors.hpp>
@@ -10,11 +12,14 @@
 #include <xyz/openbmc_project/Common/error.hpp>
 #include <xyz/openbmc_project/Inventory/Item/common.hpp>
 
+#include <algorithm>
+#include <chrono>
 #include <format>
-#include <fstream>
-#include <iostream>
 #include <map>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <vector>
 
 namespace phosphor::state::manager
 {
@@ -34,49 +39,100 @@ constexpr auto SYSTEMD_INTERFACE = "org.freedesktop.systemd1.Manager";
 
 constexpr auto PROPERTY_INTERFACE = "org.freedesktop.DBus.Properties";
 
-constexpr auto CHASSIS_POWEROFF_TARGET = "obmc-chassis-poweroff@0.target";
-constexpr auto CHASSIS_POWERON_TARGET = "obmc-chassis-poweron@0.target";
-constexpr auto CHASSIS_POWERCYCLE_TARGET = "obmc-chassis-powercycle@0.target";
+constexpr auto CHASSIS_POWEROFF_TARGET = "obmc-chassis-poweroff@{}.target";
+constexpr auto CHASSIS_POWERON_TARGET = "obmc-chassis-poweron@{}.target";
+constexpr auto CHASSIS_POWERCYCLE_TARGET = "obmc-chassis-powercycle@{}.target";
+constexpr auto PARTITION_POWEROFF_TARGET = "obmc-partition-poweroff@{}.target";
+constexpr auto PARTITION_POWERON_TARGET = "obmc-partition-poweron@{}.target";
+constexpr auto PARTITION_POWERCYCLE_TARGET =
+    "obmc-partition-powercycle@{}.target";
 constexpr auto CHASSIS_OBJ_PATH = "/xyz/openbmc_project/state/chassis{}";
 constexpr auto CHASSIS_SERVICE = "xyz.openbmc_project.State.Chassis{}";
 
+/** @brief Unit name of a target of an aggregator
+ *
+ * @param[in] aggregator    - The aggregator
+ * @param[in] chassisUnit   - Format of the unit, keyed by chassis ID
+ * @param[in] partitionUnit - Format of the unit, keyed by host ID
+ */
+static std::string aggregatorTarget(const SMPAggregator& aggregator,
+                                    std::string_view chassisUnit,
+                                    std::string_view partitionUnit)
+{
+    return std::vformat(aggregator.isPartition() ? partitionUnit : chassisUnit,
+                        std::make_format_args(aggregator.id));
+}
+
 ChassisSMP::ChassisSMP(sdbusplus::bus_t& bus,
                        const sdbusplus::object_path& objPath,
-                       size_t numChassis) :
+                       size_t numChassis, const SMPAggregator& aggregator,
+                       const SMPConfig& config) :
     ChassisInherit(bus, objPath, ChassisInherit::action::defer_emit), bus(bus),
-    numChassis(numChassis),
-    systemdSignalJobNew(
-        bus,
-        sdbusRule::type::signal() + sdbusRule::member("JobNew") +
-            sdbusRule::path("/org/freedesktop/systemd1") +
-            sdbusRule::interface("org.freedesktop.systemd1.Manager"),
-        [this](sdbusplus::message_t& m) { sysStateChangeJobNew(m); })
+    name(std::format("{}{}", aggregator.isPartition() ? "Partition" : "Chassis",
+                     aggregator.id)),
+    poweronTarget(aggregatorTarget(aggregator, CHASSIS_POWERON_TARGET,
+                                   PARTITION_POWERON_TARGET)),
+    poweroffTarget(aggregatorTarget(aggregator, CHASSIS_POWEROFF_TARGET,
+                                    PARTITION_POWEROFF_TARGET)),
+    powercycleTarget(aggregatorTarget(aggregator, CHASSIS_POWERCYCLE_TARGET,
+                                      PARTITION_POWERCYCLE_TARGET)),
+    numChassis(numChassis), leaves(config.leavesOf(aggregator)),
+    subGroups(config.subGroupsOf(aggregator)),
+    perChassisMatches(config.hierarchical()),
+    systemdSignalJobNew(bus, "JobNew",
+                        [this](sdbusplus::message_t& m) {
+                            return sysStateChangeJobNew(m);
+                        }),
+    auditTimer(sdeventplus::Event::get_default(),
+               [this](auto&) { auditChassis(); },
+               std::chrono::seconds{SMP_AUDIT_INTERVAL_S}),
+    aggregation(sdeventplus::Event::get_default(),
+                std::chrono::milliseconds{SMP_AGGREGATION_DELAY_MS},
+                [this](size_t changes) { runAggregation(changes); }),
+    fanOutStatistics(bus, objPath, TRANSITION_FAN_OUT_INTERFACE),
+    timelineStatistics(bus, objPath, TRANSITION_TIMELINE_INTERFACE)
 {
     if (numChassis == 0)
     {
         throw std::invalid_argument(
             "ChassisSMP requires at least 1 chassis to aggregate");
     }
+    if (numChassis > smpMaxChassis)
+    {
+        throw std::invalid_argument(
+            std::format("ChassisSMP aggregates at most {} chassis, "
+                        "NUM_CHASSIS_SMP",
+                        smpMaxChassis));
+    }
 
-    info("Chassis0: Creating SMP aggregator for chassis 0, "
-         "monitoring up to {NUM_CHASSIS} chassis instances",
-         "NUM_CHASSIS", numChassis);
-
-    // Initialize cached states to Off/Good and not present
-    for (size_t i = 1; i <= numChassis; ++i)
+    if (aggregator.isPartition() ? !config.hasPartition(aggregator.id)
+                                 : (aggregator.id != 0) &&
+                                       !config.isGroup(aggregator.id))
     {
-        chassisPowerStates[i] = PowerState::Off;
-        chassisPowerStatus[i] = PowerStatus::Good;
-        chassisPresentStatus[i] = false;
+        throw std::invalid_argument(std::format(
+            "{} is neither chassis 0, an SMP group nor a partition", name));
     }
 
+    info("{AGGREGATOR}: Creating SMP aggregator, monitoring up to "
+         "{NUM_CHASSIS} chassis instances and {NUM_GROUPS} groups",
+         "AGGREGATOR", name, "NUM_CHASSIS", numChassis, "NUM_GROUPS",
+         subGroups.count());
+
+    // Only have the bus deliver job signals for the targets of this
+    // aggregator
+    systemdSignalJobNew.watch(poweronTarget);
+    systemdSignalJobNew.watch(poweroffTarget);
+
     // Set initial aggregated state
     currentPowerState(PowerState::Off);
     currentPowerStatus(PowerStatus::Good);
 
     // Query actual chassis states before emitting object to prevent clients
     // from reading invalid default values
-    startMonitoring();
+    {
+        auto phase = utils::StartupTimer::instance().phase("monitoring");
+        startMonitoring();
+    }
 
     // Now that we have actual state, emit the object
     this->emit_object_added();
@@ -104,122 +160,241 @@ void ChassisSMP::startUnit(const std::string& sysdUnit)
 
 void ChassisSMP::startMonitoring()
 {
-    // Set up property change monitoring for all chassis
-    for (size_t i = 1; i <= numChassis; ++i)
-    {
-        // Always register inventory present property monitor for all chassis
-        // so we can detect when a chassis becomes present later
-        sdbusplus::object_path inventoryPath =
-            std::format("/xyz/openbmc_project/inventory/system/chassis{}", i);
+    // One match for each namespace serves every chassis, the chassis ID is
+    // decoded from the path of the signal. The matches are set up before
+    // reading the current values so no change can be missed in between.
+    inventoryPresentMatch = std::make_unique<sdbusplus::match>(
+        bus,
+        sdbusRule::propertiesChangedNamespace(CHASSIS_INVENTORY_NAMESPACE,
+                                              InventoryItem::interface),
+        [this](sdbusplus::message_t& msg) {
+            auto chassisId = chassisIdFromPath(
+                msg.get_path(), CHASSIS_INVENTORY_PATH_PREFIX, numChassis);
+            if (chassisId && leaves.test(*chassisId))
+            {
+                this->inventoryPresentChanged(msg, *chassisId);
+            }
+        });
 
-        auto inventoryMatch = std::make_unique<sdbusplus::match>(
+    // With groups an aggregator only has a few members, so it matches them
+    // individually rather than receive the signals of every chassis
+    if (!perChassisMatches)
+    {
+        chassisStateMatch = std::make_unique<sdbusplus::match>(
             bus,
-            sdbusRule::propertiesChanged(inventoryPath.string(),
-                                         "xyz.openbmc_project.Inventory.Item"),
-            [this, i](sdbusplus::message_t& msg) {
-                this->inventoryPresentChanged(msg, i);
+            sdbusRule::propertiesChangedNamespace(CHASSIS_STATE_NAMESPACE,
+                                                  server::Chassis::interface),
+            [this](sdbusplus::message_t& msg) {
+                // Only present chassis are monitored
+                auto chassisId = chassisIdFromPath(
+                    msg.get_path(), CHASSIS_STATE_PATH_PREFIX, numChassis);
+                if (chassisId && chassisPresent.test(*chassisId))
+                {
+                    this->chassisPropertyChanged(msg, *chassisId);
+                }
             });
+    }
+
+    // Chassis items can come and go while running, e.g. on a hot plug
+    inventoryAddedMatch = std::make_unique<sdbusplus::match>(
+        bus,
+        sdbusRule::interfacesAdded() +
+            sdbusRule::argNpath(0, std::string(CHASSIS_INVENTORY_NAMESPACE) +
+                                       "/"),
+        [this](sdbusplus::message_t& msg) { this->inventoryItemAdded(msg); });
+
+    inventoryRemovedMatch = std::make_unique<sdbusplus::match>(
+        bus,
+        sdbusRule::interfacesRemoved() +
+            sdbusRule::argNpath(0, std::string(CHASSIS_INVENTORY_NAMESPACE) +
+                                       "/"),
+        [this](sdbusplus::message_t& msg) { this->inventoryItemRemoved(msg); });
+
+    // Discover the member chassis and their present status. Only these are
+    // read and aggregated, numChassis is just the highest ID accepted. The
+    // groups have no inventory item and are always taken as present.
+    auto inventory = readChassisInventory(bus, numChassis);
+    chassisMembers = (inventory.members & leaves) | subGroups;
+    chassisPresent = (inventory.present & leaves) | subGroups;
+    updateStateMatches();
+
+    info("{AGGREGATOR}: Aggregating {NUM_MEMBERS} members, "
+         "{NUM_PRESENT} present",
+         "AGGREGATOR", name, "NUM_MEMBERS", chassisMembers.count(),
+         "NUM_PRESENT", chassisPresent.count());
+
+    // Only monitor chassis state properties for chassis that are present
+    forEachChassis(chassisPresent, [this](size_t chassisId) {
+        // Read the current values once, the signals keep them up to date
+        refreshChassis(chassisId);
+
+        debug("{AGGREGATOR}: Monitoring chassis "
+              "{MONITORED_CHASSIS_ID}",
+              "AGGREGATOR", name, "MONITORED_CHASSIS_ID", chassisId);
+    });
 
-        inventoryPresentMatches.push_back(std::move(inventoryMatch));
+    // Do initial aggregation
+    aggregatePowerState();
+    aggregatePowerStatus();
+}
+
+void ChassisSMP::updateStateMatches()
+{
+    if (!perChassisMatches)
+    {
+        return;
+    }
 
-        // Initialize the present status cache by reading current value
-        chassisPresentStatus[i] = isChassisPresent(i);
+    std::erase_if(chassisStateMatches, [this](const auto& entry) {
+        return !chassisPresent.test(entry.first);
+    });
 
-        // Only monitor chassis state properties for chassis that are present
-        if (!chassisPresentStatus[i])
+    forEachChassis(chassisPresent, [this](size_t chassisId) {
+        if (chassisStateMatches.contains(chassisId))
         {
-            info("Chassis0: Skipping state monitoring for chassis "
-                 "{MONITORED_CHASSIS_ID} because it is not present",
-                 "MONITORED_CHASSIS_ID", i);
-            continue;
+            return;
         }
+        chassisStateMatches.emplace(
+            chassisId,
+            std::make_unique<sdbusplus::match>(
+                bus,
+                sdbusRule::propertiesChanged(
+                    std::format(CHASSIS_OBJ_PATH, chassisId),
+                    server::Chassis::interface),
+                [this, chassisId](sdbusplus::message_t& msg) {
+                    this->chassisPropertyChanged(msg, chassisId);
+                }));
+    });
+}
 
-        sdbusplus::object_path chassisPath = std::format(CHASSIS_OBJ_PATH, i);
+std::optional<ChassisSMP::PowerState> ChassisSMP::readPowerState(
+    size_t chassisId)
+{
+    sdbusplus::object_path chassisPath =
+        std::format(CHASSIS_OBJ_PATH, chassisId);
+    std::string chassisService = std::format(CHASSIS_SERVICE, chassisId);
+    try
+    {
+        auto method = bus.new_method_call(
+            chassisService.c_str(), chassisPath, PROPERTY_INTERFACE, "Get");
+        method.append(server::Chassis::interface,
+                      server::Chassis::property_names::current_power_state);
 
-        auto match = std::make_unique<sdbusplus::match>(
-            bus,
-            sdbusRule::propertiesChanged(chassisPath.string(),
-                                         server::Chassis::interface),
-            [this, i](sdbusplus::message_t& msg) {
-                this->chassisPropertyChanged(msg, i);
-            });
+        auto reply = bus.call(method);
+        auto propertyValue = reply.unpack<std::variant<PowerState>>();
+        return std::get<PowerState>(propertyValue);
+    }
+    catch (const sdbusplus::exception_t& e)
+    {
+        error("{AGGREGATOR}: Failed to get power state for chassis "
+              "{TARGET_CHASSIS_ID}: {ERROR}",
+              "AGGREGATOR", name, "TARGET_CHASSIS_ID", chassisId, "ERROR", e);
+        return std::nullopt;
+    }
+}
 
-        chassisMatches[i] = std::move(match);
+std::optional<ChassisSMP::PowerStatus> ChassisSMP::readPowerStatus(
+    size_t chassisId)
+{
+    sdbusplus::object_path chassisPath =
+        std::format(CHASSIS_OBJ_PATH, chassisId);
+    std::string chassisService = std::format(CHASSIS_SERVICE, chassisId);
+    try
+    {
+        auto method = bus.new_method_call(
+            chassisService.c_str(), chassisPath, PROPERTY_INTERFACE, "Get");
+        method.append(server::Chassis::interface,
+                      server::Chassis::property_names::current_power_status);
 
-        debug("Chassis0: Monitoring chassis {MONITORED_CHASSIS_ID}",
-              "MONITORED_CHASSIS_ID", i);
+        auto reply = bus.call(method);
+        auto propertyValue = reply.unpack<std::variant<PowerStatus>>();
+        return std::get<PowerStatus>(propertyValue);
+    }
+    catch (const sdbusplus::exception_t& e)
+    {
+        error("{AGGREGATOR}: Failed to get power status for chassis "
+              "{TARGET_CHASSIS_ID}: {ERROR}",
+              "AGGREGATOR", name, "TARGET_CHASSIS_ID", chassisId, "ERROR", e);
+        return std::nullopt;
     }
-
-    // Do initial aggregation
-    aggregatePowerState();
-    aggregatePowerStatus();
 }
 
-void ChassisSMP::aggregatePowerState()
+void ChassisSMP::refreshChassis(size_t chassisId)
 {
-    // Aggregate power state with priority:
-    // 1. If ANY chassis is TransitioningToOff -> TransitioningToOff
-    // 2. If ANY chassis is TransitioningToOn -> TransitioningToOn
-    // 3. If ANY chassis is On -> On
-    // 4. Only report Off if ALL present chassis are Off
-    PowerState aggregatedState = PowerState::Off;
-    bool hasTransitioningToOff = false;
-    bool hasTransitioningToOn = false;
-    bool hasOn = false;
+    chassisPowerStates.set(chassisId,
+                           readPowerState(chassisId).value_or(PowerState::Off));
+    // Assume good if we can't read the status
+    chassisPowerStatus.set(
+        chassisId, readPowerStatus(chassisId).value_or(PowerStatus::Good));
+}
 
-    for (size_t i = 1; i <= numChassis; ++i)
-    {
-        if (!chassisPresentStatus[i])
+void ChassisSMP::auditChassis()
+{
+    forEachChassis(chassisPresent, [this](size_t i) {
+        auto state = readPowerState(i);
+        if (state && (*state != chassisPowerStates.get(i)))
         {
-            continue;
+            warning("{AGGREGATOR}: Audit found chassis "
+                    "{TARGET_CHASSIS_ID} power state {POWER_STATE}, cached "
+                    "{CACHED}",
+                    "AGGREGATOR", name, "TARGET_CHASSIS_ID", i, "POWER_STATE",
+                    *state, "CACHED", chassisPowerStates.get(i));
+            chassisPowerStates.set(i, *state);
         }
 
-        sdbusplus::object_path chassisPath = std::format(CHASSIS_OBJ_PATH, i);
-        std::string chassisService = std::format(CHASSIS_SERVICE, i);
-        try
+        auto status = readPowerStatus(i);
+        if (status && (*status != chassisPowerStatus.get(i)))
         {
-            auto method = bus.new_method_call(
-                chassisService.c_str(), chassisPath, PROPERTY_INTERFACE, "Get");
-            method.append(server::Chassis::interface,
-                          server::Chassis::property_names::current_power_state);
+            warning("{AGGREGATOR}: Audit found chassis "
+                    "{TARGET_CHASSIS_ID} power status {POWER_STATUS}, cached "
+                    "{CACHED}",
+                    "AGGREGATOR", name, "TARGET_CHASSIS_ID", i, "POWER_STATUS",
+                    *status, "CACHED", chassisPowerStatus.get(i));
+            chassisPowerStatus.set(i, *status);
+        }
+    });
 
-            auto reply = bus.call(method);
-            auto propertyValue = reply.unpack<std::variant<PowerState>>();
-            auto state = std::get<PowerState>(propertyValue);
+    aggregatePowerState();
+    aggregatePowerStatus();
+}
 
-            chassisPowerStates[i] = state;
+void ChassisSMP::runAggregation(size_t changes)
+{
+    debug("{AGGREGATOR}: Aggregating {CHANGES} chassis changes",
+          "AGGREGATOR", name, "CHANGES", changes);
 
-            if (state == PowerState::TransitioningToOff)
-            {
-                hasTransitioningToOff = true;
-            }
-            else if (state == PowerState::TransitioningToOn)
-            {
-                hasTransitioningToOn = true;
-            }
-            else if (state == PowerState::On)
-            {
-                hasOn = true;
-            }
-        }
-        catch (const sdbusplus::exception_t& e)
-        {
-            error("Chassis0: Failed to get power state for chassis "
-                  "{TARGET_CHASSIS_ID}: {ERROR}",
-                  "TARGET_CHASSIS_ID", i, "ERROR", e);
-            chassisPowerStates[i] = PowerState::Off;
-        }
+    aggregatePowerState();
+    aggregatePowerStatus();
+
+    // Published along with the aggregate rather than on every signal
+    if (timelinesChanged)
+    {
+        timelinesChanged = false;
+        timelineStatistics.set(timelines.values());
     }
+}
 
-    if (hasTransitioningToOff)
+void ChassisSMP::aggregatePowerState()
+{
+    // Aggregate power state with priority:
+    // 1. If ANY chassis is TransitioningToOff -> TransitioningToOff
+    // 2. If ANY chassis is TransitioningToOn -> TransitioningToOn
+    // 3. If ANY chassis is On -> On
+    // 4. Only report Off if ALL present chassis are Off
+    auto hasState = [this](PowerState state) {
+        return (chassisPresent & chassisPowerStates.with(state)).any();
+    };
+
+    PowerState aggregatedState = PowerState::Off;
+    if (hasState(PowerState::TransitioningToOff))
     {
         aggregatedState = PowerState::TransitioningToOff;
     }
-    else if (hasTransitioningToOn)
+    else if (hasState(PowerState::TransitioningToOn))
     {
         aggregatedState = PowerState::TransitioningToOn;
     }
-    else if (hasOn)
+    else if (hasState(PowerState::On))
     {
         aggregatedState = PowerState::On;
     }
@@ -233,9 +408,9 @@ void ChassisSMP::aggregatePowerState()
 
     if (server::Chassis::currentPowerState() != aggregatedState)
     {
-        info("Chassis0: SMP Aggregator power state changing to: "
+        info("{AGGREGATOR}: SMP Aggregator power state changing to: "
              "{POWER_STATE}",
-             "POWER_STATE", aggregatedState);
+             "AGGREGATOR", name, "POWER_STATE", aggregatedState);
         currentPowerState(aggregatedState);
     }
 }
@@ -243,58 +418,25 @@ void ChassisSMP::aggregatePowerState()
 void ChassisSMP::aggregatePowerStatus()
 {
     // Aggregate power status: worst case (BrownOut > UPS > Good)
-    PowerStatus aggregatedStatus = PowerStatus::Good;
+    auto hasStatus = [this](PowerStatus status) {
+        return (chassisPresent & chassisPowerStatus.with(status)).any();
+    };
 
-    for (size_t i = 1; i <= numChassis; ++i)
+    PowerStatus aggregatedStatus = PowerStatus::Good;
+    if (hasStatus(PowerStatus::BrownOut))
     {
-        if (!chassisPresentStatus[i])
-        {
-            continue;
-        }
-
-        sdbusplus::object_path chassisPath = std::format(CHASSIS_OBJ_PATH, i);
-        std::string chassisService = std::format(CHASSIS_SERVICE, i);
-
-        try
-        {
-            auto method = bus.new_method_call(
-                chassisService.c_str(), chassisPath, PROPERTY_INTERFACE, "Get");
-            method.append(
-                server::Chassis::interface,
-                server::Chassis::property_names::current_power_status);
-
-            auto reply = bus.call(method);
-            auto propertyValue = reply.unpack<std::variant<PowerStatus>>();
-            auto status = std::get<PowerStatus>(propertyValue);
-
-            chassisPowerStatus[i] = status;
-
-            // Worst case: BrownOut > UPS > Good
-            if (status == PowerStatus::BrownOut)
-            {
-                aggregatedStatus = PowerStatus::BrownOut;
-            }
-            else if (status == PowerStatus::UninterruptiblePowerSupply &&
-                     aggregatedStatus != PowerStatus::BrownOut)
-            {
-                aggregatedStatus = PowerStatus::UninterruptiblePowerSupply;
-            }
-        }
-        catch (const sdbusplus::exception_t& e)
-        {
-            error("Chassis0: Failed to get power status for chassis "
-                  "{TARGET_CHASSIS_ID}: {ERROR}",
-                  "TARGET_CHASSIS_ID", i, "ERROR", e);
-            // Assume good if we can't read the status
-            chassisPowerStatus[i] = PowerStatus::Good;
-        }
+        aggregatedStatus = PowerStatus::BrownOut;
+    }
+    else if (hasStatus(PowerStatus::UninterruptiblePowerSupply))
+    {
+        aggregatedStatus = PowerStatus::UninterruptiblePowerSupply;
     }
 
     if (server::Chassis::currentPowerStatus() != aggregatedStatus)
     {
-        info("Chassis0: SMP Aggregator power status changing to: "
+        info("{AGGREGATOR}: SMP Aggregator power status changing to: "
              "{POWER_STATUS}",
-             "POWER_STATUS", aggregatedStatus);
+             "AGGREGATOR", name, "POWER_STATUS", aggregatedStatus);
         currentPowerStatus(aggregatedStatus);
     }
 }
@@ -322,34 +464,45 @@ void ChassisSMP::chassisPropertyChanged(sdbusplus::message_t& msg,
             // off
             auto currentState = server::Chassis::currentPowerState();
             if (state == PowerState::TransitioningToOff &&
-                chassisPowerStates[chassisId] !=
+                chassisPowerStates.get(chassisId) !=
                     PowerState::TransitioningToOff &&
                 !coordinatedPowerOffInProgress &&
                 (currentState == PowerState::TransitioningToOn ||
                  currentState == PowerState::On))
             {
                 warning(
-                    "Chassis0: Chassis {FAILED_CHASSIS_ID} is "
+                    "{AGGREGATOR}: Chassis {FAILED_CHASSIS_ID} is "
                     "transitioning to off while system is in {POWER_STATE}, "
                     "initiating power off for all chassis",
-                    "FAILED_CHASSIS_ID", chassisId, "POWER_STATE",
-                    currentState);
+                    "AGGREGATOR", name, "FAILED_CHASSIS_ID", chassisId,
+                    "POWER_STATE", currentState);
 
                 // Set flag to prevent repeated power off requests
                 coordinatedPowerOffInProgress = true;
 
+                // Close the timeline of the power on before the power off
+                // starts the next one
+                if (timelines.failed(chassisId))
+                {
+                    reportTimeline();
+                }
+
                 // Set requested power transition to off so state is correct
                 server::Chassis::requestedPowerTransition(Transition::Off);
 
-                // Start the chassis 0 poweroff target
-                startUnit(CHASSIS_POWEROFF_TARGET);
+                // Start the poweroff target of this aggregator
+                startUnit(poweroffTarget);
 
                 // Request power off transition on all chassis instances
                 requestTransitionOnAllChassis(Transition::Off);
             }
+            else
+            {
+                recordTimeline(chassisId, state);
+            }
 
-            chassisPowerStates[chassisId] = state;
-            aggregatePowerState();
+            chassisPowerStates.set(chassisId, state);
+            aggregation.changed();
         }
         else if (property ==
                  server::Chassis::property_names::current_power_status)
@@ -358,35 +511,54 @@ void ChassisSMP::chassisPropertyChanged(sdbusplus::message_t& msg,
             PowerStatus status =
                 server::Chassis::convertPowerStatusFromString(statusStr);
 
-            chassisPowerStatus[chassisId] = status;
-            aggregatePowerStatus();
+            chassisPowerStatus.set(chassisId, status);
+            aggregation.changed();
         }
     }
 }
 
 void ChassisSMP::requestTransitionOnAllChassis(Transition transition)
 {
-    info("Chassis0: Forwarding transition request {TRANSITION} to "
+    info("{AGGREGATOR}: Forwarding transition request {TRANSITION} to "
          "all chassis instances",
-         "TRANSITION", transition);
+         "AGGREGATOR", name, "TRANSITION", transition);
 
-    for (size_t i = 1; i <= numChassis; ++i)
+    if (!fanOutCalls.empty())
     {
-        if (!chassisPresentStatus[i])
+        warning("{AGGREGATOR}: Transition {TRANSITION} superseded "
+                "before {PENDING} chassis replied",
+                "AGGREGATOR", name, "TRANSITION", fanOutTransition, "PENDING",
+                fanOutCalls.size());
+        for (auto chassisId : fanOutCalls.keys())
         {
-            info("Chassis0: Skipping transition for chassis "
-                 "{TARGET_CHASSIS_ID} because it is not present",
-                 "TARGET_CHASSIS_ID", i);
-            continue;
+            fanOutResult(chassisId, "superseded");
         }
+        fanOutCalls.clear();
+        reportFanOut();
+    }
+
+    fanOutTransition = transition;
+    fanOutStart = std::chrono::steady_clock::now();
+    timelines.start(static_cast<uint64_t>(transition), chassisPresent,
+                    fanOutStart);
+    timelinesChanged = true;
+    fanOutErrors.clear();
+    fanOutLatencies.clear();
+
+    std::string transitionStr = convertForMessage(transition);
 
+    forEachChassis(chassisMembers & ~chassisPresent, [this](size_t i) {
+        info("{AGGREGATOR}: Skipping transition for chassis "
+             "{TARGET_CHASSIS_ID} because it is not present",
+             "AGGREGATOR", name, "TARGET_CHASSIS_ID", i);
+    });
+
+    forEachChassis(chassisPresent, [this, &transitionStr](size_t i) {
         sdbusplus::object_path chassisPath = std::format(CHASSIS_OBJ_PATH, i);
         std::string chassisService = std::format(CHASSIS_SERVICE, i);
 
         try
         {
-            std::string transitionStr = convertForMessage(transition);
-
             auto method = bus.new_method_call(
                 chassisService.c_str(), chassisPath, PROPERTY_INTERFACE, "Set");
             method.append(
@@ -394,44 +566,180 @@ void ChassisSMP::requestTransitionOnAllChassis(Transition transition)
                 server::Chassis::property_names::requested_power_transition,
                 std::variant<std::string>(transitionStr));
 
-            bus.call_noreply(method);
-
-            debug("Chassis0: Forwarded transition to chassis "
-                  "{TARGET_CHASSIS_ID}",
-                  "TARGET_CHASSIS_ID", i);
+            fanOutCalls.call(i, method, [this, i](auto& reply) {
+                fanOutReply(i, reply);
+            });
         }
         catch (const sdbusplus::exception_t& e)
         {
-            error("Chassis0: Failed to forward transition to chassis "
-                  "{TARGET_CHASSIS_ID}: {ERROR}",
-                  "TARGET_CHASSIS_ID", i, "ERROR", e);
-            throw;
+            fanOutResult(i, e.what());
+        }
+    });
+
+    if (fanOutCalls.empty())
+    {
+        reportFanOut();
+    }
+}
+
+void ChassisSMP::fanOutReply(size_t chassisId, sdbusplus::message_t& reply)
+{
+    if (reply.is_method_error())
+    {
+        const auto* e = reply.get_error();
+        fanOutResult(chassisId,
+                     (e && e->name) ? e->name : "unknown D-Bus error");
+    }
+    else
+    {
+        debug("{AGGREGATOR}: Forwarded transition to chassis "
+              "{TARGET_CHASSIS_ID}",
+              "AGGREGATOR", name, "TARGET_CHASSIS_ID", chassisId);
+        fanOutResult(chassisId, "");
+    }
+
+    if (fanOutCalls.empty())
+    {
+        reportFanOut();
+    }
+}
+
+void ChassisSMP::fanOutResult(size_t chassisId, const std::string& reason)
+{
+    if (!reason.empty())
+    {
+        error("{AGGREGATOR}: Failed to forward transition to chassis "
+              "{TARGET_CHASSIS_ID}: {ERROR}",
+              "AGGREGATOR", name, "TARGET_CHASSIS_ID", chassisId, "ERROR",
+              reason);
+    }
+
+    fanOutErrors.insert_or_assign(chassisId, reason);
+    if (!reason.empty() && timelines.failed(chassisId))
+    {
+        reportTimeline();
+    }
+    fanOutLatencies.insert_or_assign(
+        chassisId, std::chrono::duration_cast<std::chrono::milliseconds>(
+                       std::chrono::steady_clock::now() - fanOutStart));
+}
+
+void ChassisSMP::reportFanOut()
+{
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - fanOutStart);
+
+    utils::StatisticsInterface::Values values;
+    std::string failed;
+    size_t failures = 0;
+    for (const auto& [chassisId, reason] : fanOutErrors)
+    {
+        auto prefix = std::format("chassis{}", chassisId);
+        values.emplace(prefix + ".failed", reason.empty() ? 0 : 1);
+        values.emplace(prefix + ".latency_ms",
+                       fanOutLatencies[chassisId].count());
+        if (!reason.empty())
+        {
+            failed += (failed.empty() ? "" : ",") + std::to_string(chassisId);
+            ++failures;
         }
     }
+    values.emplace("chassis", fanOutErrors.size());
+    values.emplace("failed", failures);
+    values.emplace("duration_ms", duration.count());
+    fanOutStatistics.set(std::move(values));
+
+    // The forwarding failures are part of the timeline
+    timelinesChanged = false;
+    timelineStatistics.set(timelines.values());
+
+    if (failures != 0)
+    {
+        error("{AGGREGATOR}: Transition {TRANSITION} failed on chassis "
+              "{FAILED_CHASSIS}, {FAILURES} of {CHASSIS} in {DURATION_MS} ms",
+              "AGGREGATOR", name, "TRANSITION", fanOutTransition,
+              "FAILED_CHASSIS", failed, "FAILURES", failures, "CHASSIS",
+              fanOutErrors.size(), "DURATION_MS", duration.count());
+    }
+    else
+    {
+        info("{AGGREGATOR}: Transition {TRANSITION} forwarded to "
+             "{CHASSIS} chassis in {DURATION_MS} ms",
+             "AGGREGATOR", name, "TRANSITION", fanOutTransition, "CHASSIS",
+             fanOutErrors.size(), "DURATION_MS", duration.count());
+    }
+}
+
+void ChassisSMP::recordTimeline(size_t chassisId, PowerState state)
+{
+    bool complete = false;
+    switch (state)
+    {
+        case PowerState::TransitioningToOn:
+        case PowerState::TransitioningToOff:
+            timelines.transitioning(chassisId);
+            break;
+        case PowerState::On:
+            complete = (fanOutTransition != Transition::Off) &&
+                       timelines.reached(chassisId);
+            break;
+        case PowerState::Off:
+            complete = (fanOutTransition == Transition::Off) &&
+                       timelines.reached(chassisId);
+            break;
+        default:
+            return;
+    }
+
+    timelinesChanged = true;
+    if (complete)
+    {
+        reportTimeline();
+    }
+}
+
+void ChassisSMP::reportTimeline()
+{
+    auto slowest = timelines.slowest();
+    if (!slowest)
+    {
+        warning("{AGGREGATOR}: Transition {TRANSITION} completed "
+                "without any chassis reaching the requested state",
+                "AGGREGATOR", name, "TRANSITION", fanOutTransition);
+        return;
+    }
+
+    info("{AGGREGATOR}: Transition {TRANSITION} completed, slowest "
+         "chassis {SLOWEST_CHASSIS_ID} after {SLOWEST_MS} ms, spread "
+         "{SPREAD_MS} ms",
+         "AGGREGATOR", name, "TRANSITION", fanOutTransition,
+         "SLOWEST_CHASSIS_ID", *slowest, "SLOWEST_MS",
+         timelines.slowestTime().count(), "SPREAD_MS",
+         timelines.spread().count());
 }
 
 ChassisSMP::Transition ChassisSMP::requestedPowerTransition(Transition value)
 {
-    info("Chassis0: SMP Aggregator received transition request: "
+    info("{AGGREGATOR}: SMP Aggregator received transition request: "
          "{TRANSITION}",
-         "TRANSITION", value);
+         "AGGREGATOR", name, "TRANSITION", value);
 
     // Reset the coordinated power off flag when a new transition is requested
     // This allows the system to detect new failures after a power on attempt
     coordinatedPowerOffInProgress = false;
 
-    // Start the systemd target for chassis 0
+    // Start the systemd target of this aggregator
     if (value == Transition::Off)
     {
-        startUnit(CHASSIS_POWEROFF_TARGET);
+        startUnit(poweroffTarget);
     }
     else if (value == Transition::On)
     {
-        startUnit(CHASSIS_POWERON_TARGET);
+        startUnit(poweronTarget);
     }
     else if (value == Transition::PowerCycle)
     {
-        startUnit(CHASSIS_POWERCYCLE_TARGET);
+        startUnit(powercycleTarget);
     }
 
     // Forward the transition request to all chassis instances
@@ -442,49 +750,12 @@ ChassisSMP::Transition ChassisSMP::requestedPowerTransition(Transition value)
 
 ChassisSMP::PowerState ChassisSMP::currentPowerState(PowerState value)
 {
-    info("Chassis0: SMP Aggregator power state set to: "
+    info("{AGGREGATOR}: SMP Aggregator power state set to: "
          "{POWER_STATE}",
-         "POWER_STATE", value);
+         "AGGREGATOR", name, "POWER_STATE", value);
     return server::Chassis::currentPowerState(value);
 }
 
-bool ChassisSMP::isChassisPresent(size_t chassisId)
-{
-    constexpr auto inventoryObjPathFmt =
-        "/xyz/openbmc_project/inventory/system/chassis{}";
-
-    sdbusplus::object_path inventoryPath =
-        std::format(inventoryObjPathFmt, chassisId);
-
-    try
-    {
-        auto inventoryBusName =
-            utils::getService(bus, inventoryPath.str, InventoryItem::interface);
-
-        auto method = bus.new_method_call(
-            inventoryBusName.c_str(), inventoryPath, PROPERTY_INTERFACE, "Get");
-        method.append(InventoryItem::interface,
-                      InventoryItem::property_names::present);
-
-        auto response = bus.call(method);
-        std::variant<bool> value;
-        response.read(value);
-
-        bool present = std::get<bool>(value);
-        debug("Chassis0: Chassis {CHASSIS_ID} present status: "
-              "{PRESENT}",
-              "CHASSIS_ID", chassisId, "PRESENT", present);
-        return present;
-    }
-    catch (const sdbusplus::exception_t& e)
-    {
-        debug("Chassis0: Could not read Present property for "
-              "chassis {CHASSIS_ID}: {ERROR}",
-              "CHASSIS_ID", chassisId, "ERROR", e.what());
-        return false;
-    }
-}
-
 void ChassisSMP::inventoryPresentChanged(sdbusplus::message_t& msg,
                                          size_t chassisId)
 {
@@ -501,43 +772,93 @@ void ChassisSMP::inventoryPresentChanged(sdbusplus::message_t& msg,
 
     bool isPresent = std::get<bool>(present->second);
 
-    info("Chassis0: Chassis {TARGET_CHASSIS_ID} inventory presence "
-         "changed to {PRESENT}",
-         "TARGET_CHASSIS_ID", chassisId, "PRESENT", isPresent);
+    info("{AGGREGATOR}: Chassis {TARGET_CHASSIS_ID} inventory "
+         "presence changed to {PRESENT}",
+         "AGGREGATOR", name, "TARGET_CHASSIS_ID", chassisId, "PRESENT",
+         isPresent);
+
+    // A chassis signalling presence has an inventory item, even if its
+    // InterfacesAdded signal was missed
+    chassisMembers.set(chassisId);
 
     // Update the cached present status
-    chassisPresentStatus[chassisId] = isPresent;
+    chassisPresent.set(chassisId, isPresent);
+    updateStateMatches();
 
-    // If chassis became present, start monitoring its state properties
+    // If chassis became present, start monitoring its state properties.
+    // Its signals were ignored while it wasn't present, so read it again.
     if (isPresent)
     {
-        // Only create a new match if we're not already monitoring this chassis
-        if (chassisMatches.find(chassisId) == chassisMatches.end())
-        {
-            sdbusplus::object_path chassisPath =
-                std::format("/xyz/openbmc_project/state/chassis{}", chassisId);
+        refreshChassis(chassisId);
 
-            auto match = std::make_unique<sdbusplus::match>(
-                bus,
-                sdbusRule::propertiesChanged(
-                    chassisPath.string(), "xyz.openbmc_project.State.Chassis"),
-                [this, chassisId](sdbusplus::message_t& msg) {
-                    this->chassisPropertyChanged(msg, chassisId);
-                });
+        info("{AGGREGATOR}: Started monitoring chassis "
+             "{MONITORED_CHASSIS_ID}",
+             "AGGREGATOR", name, "MONITORED_CHASSIS_ID", chassisId);
+    }
 
-            chassisMatches[chassisId] = std::move(match);
+    aggregation.changed();
+}
 
-            info("Chassis0: Started monitoring chassis "
-                 "{MONITORED_CHASSIS_ID}",
-                 "MONITORED_CHASSIS_ID", chassisId);
-        }
+void ChassisSMP::inventoryItemAdded(sdbusplus::message_t& msg)
+{
+    auto item = readAddedItem(bus, msg);
+    if (!item)
+    {
+        return;
     }
 
-    aggregatePowerState();
-    aggregatePowerStatus();
+    auto chassisId = chassisIdFromPath(
+        item->first, CHASSIS_INVENTORY_PATH_PREFIX, numChassis);
+    if (!chassisId || !leaves.test(*chassisId) ||
+        chassisMembers.test(*chassisId))
+    {
+        return;
+    }
+
+    chassisMembers.set(*chassisId);
+    chassisPresent.set(*chassisId, item->second);
+    updateStateMatches();
+
+    info("{AGGREGATOR}: Chassis {TARGET_CHASSIS_ID} added to the "
+         "inventory, present {PRESENT}",
+         "AGGREGATOR", name, "TARGET_CHASSIS_ID", *chassisId, "PRESENT",
+         chassisPresent.test(*chassisId));
+
+    if (chassisPresent.test(*chassisId))
+    {
+        refreshChassis(*chassisId);
+        aggregation.changed();
+    }
+}
+
+void ChassisSMP::inventoryItemRemoved(sdbusplus::message_t& msg)
+{
+    sdbusplus::object_path path;
+    std::vector<std::string> interfaces;
+    msg.read(path, interfaces);
+
+    auto chassisId =
+        chassisIdFromPath(path.str, CHASSIS_INVENTORY_PATH_PREFIX, numChassis);
+    if (!chassisId || !leaves.test(*chassisId) ||
+        !chassisMembers.test(*chassisId) ||
+        std::ranges::find(interfaces, InventoryItem::interface) ==
+            interfaces.end())
+    {
+        return;
+    }
+
+    info("{AGGREGATOR}: Chassis {TARGET_CHASSIS_ID} removed from the "
+         "inventory",
+         "AGGREGATOR", name, "TARGET_CHASSIS_ID", *chassisId);
+
+    chassisMembers.reset(*chassisId);
+    chassisPresent.reset(*chassisId);
+    updateStateMatches();
+
+    aggregation.changed();
 }
 
-void ChassisSMP::sysStateChangeJobNew(sdbusplus::message_t& msg)
+bool ChassisSMP::sysStateChangeJobNew(sdbusplus::message_t& msg)
 {
     uint32_t newStateID{};
     sdbusplus::object_path newStateObjPath;
@@ -545,11 +866,8 @@ void ChassisSMP::sysStateChangeJobNew(sdbusplus::message_t& msg)
 
     msg.read(newStateID, newStateObjPath, newStateUnit);
 
-    // Check if the chassis 0 poweron target was started outside of this
-    // application
-    std::string poweronTarget =
-        std::format("obmc-chassis-poweron@{}.target", std::to_string(0));
-
+    // Check if the poweron target of this aggregator was started outside of
+    // this application
     if (newStateUnit == poweronTarget)
     {
         // Only initiate power on if our current requested power state is off
@@ -560,17 +878,19 @@ void ChassisSMP::sysStateChangeJobNew(sdbusplus::message_t& msg)
         if ((currentRequestedTransition == Transition::Off) &&
             (currentPowerState == PowerState::Off))
         {
-            info("Chassis0: Chassis 0 poweron target started while "
-                 "in state {POWER_STATE}, forwarding to all chassis instances",
-                 "POWER_STATE", currentPowerState);
+            info("{AGGREGATOR}: poweron target "
+                 "started while in state {POWER_STATE}, forwarding to all "
+                 "chassis instances",
+                 "AGGREGATOR", name, "POWER_STATE", currentPowerState);
 
             requestedPowerTransition(Transition::On);
+            return true;
         }
-        return;
+        return false;
     }
 
-    // Check if the chassis 0 poweroff target was started
-    if (newStateUnit == CHASSIS_POWEROFF_TARGET)
+    // Check if the poweroff target of this aggregator was started
+    if (newStateUnit == poweroffTarget)
     {
         // Only initiate auto power off if we were actively trying to power on
         // and we have not already processed a request to power off
@@ -581,14 +901,17 @@ void ChassisSMP::sysStateChangeJobNew(sdbusplus::message_t& msg)
              currentState == PowerState::On) &&
             (currentRequestedTransition != Transition::Off))
         {
-            info("Chassis0: Chassis 0 poweroff target started while "
-                 "in state {POWER_STATE}, initiating power off for all chassis "
-                 "instances",
-                 "POWER_STATE", currentState);
+            info("{AGGREGATOR}: poweroff target "
+                 "started while in state {POWER_STATE}, initiating power off "
+                 "for all chassis instances",
+                 "AGGREGATOR", name, "POWER_STATE", currentState);
 
             requestedPowerTransition(Transition::Off);
+            return true;
         }
     }
+
+    return false;
 }
 
 } // namespace phosphor::state::manager
@@ -2,6 +2,13 @@
 
 #include "config.h"
 
+#include "chassis_smp_coalescer.hpp"
+#include "chassis_smp_common.hpp"
+#include "chassis_smp_config.hpp"
+#include "chassis_smp_timeline.hpp"
+#include "statistics.hpp"
+#include "utils.hpp"
+
 #include <sdbusplus/bus.hpp>
 #include <sdeventplus/clock.hpp>
 #include <sdeventplus/event.hpp>
@@ -9,9 +16,11 @@
 #include <xyz/openbmc_project/State/Chassis/server.hpp>
 #include <xyz/openbmc_project/State/PowerOnHours/server.hpp>
 
+#include <chrono>
 #include <map>
 #include <memory>
-#include <vector>
+#include <optional>
+#include <string>
 
 namespace phosphor::state::manager
 {
@@ -21,12 +30,25 @@ using ChassisInherit = sdbusplus::server::object_t<
     sdbusplus::server::xyz::openbmc_project::state::PowerOnHours>;
 namespace sdbusRule = sdbusplus::match_rules;
 
+/** @brief Interface exposing the result of the last forwarded transition */
+constexpr auto TRANSITION_FAN_OUT_INTERFACE =
+    "phosphor.state_manager.Debug.TransitionFanOut";
+
+/** @brief Interface exposing when each chassis reached the last transitions */
+constexpr auto TRANSITION_TIMELINE_INTERFACE =
+    "phosphor.state_manager.Debug.TransitionTimeline";
+
 /** @class ChassisSMP
  *  @brief Multi-chassis SMP aggregator for chassis state management.
- *  @details Aggregates state information from chassis instances 1-N and
- *           presents it on chassis instance 0. This class overrides the
- *           normal chassis_state_manager behavior for instance 0 to only
- *           aggregate data from other chassis instances.
+ *  @details Aggregates state information from the chassis instances found
+ *           in the inventory and presents it on chassis instance 0. This
+ *           class overrides the normal chassis_state_manager behavior for
+ *           instance 0 to only aggregate data from other chassis instances.
+ *           With an SMPConfig having groups, an instance also runs as the
+ *           intermediate aggregator of each group, and chassis 0 aggregates
+ *           the group objects instead of every chassis. The aggregator of the
+ *           partition of a host only aggregates the chassis of that
+ *           partition, and is driven by the partition targets of the host.
  */
 class ChassisSMP : public ChassisInherit
 {
@@ -39,10 +61,14 @@ class ChassisSMP : public ChassisInherit
      *
      * @param[in] bus        - The Dbus bus object
      * @param[in] objPath    - The Dbus object path
-     * @param[in] numChassis - Number of chassis instances to aggregate (1-N)
+     * @param[in] numChassis - Highest chassis ID to aggregate, the chassis
+     *                         themselves are discovered from the inventory
+     * @param[in] aggregator - Chassis 0, a group or the partition of a host
+     * @param[in] config     - The arrangement of the aggregators
      */
     ChassisSMP(sdbusplus::bus_t& bus, const sdbusplus::object_path& objPath,
-               size_t numChassis);
+               size_t numChassis, const SMPAggregator& aggregator = {},
+               const SMPConfig& config = {});
 
     /** @brief Set value of RequestedPowerTransition */
     Transition requestedPowerTransition(Transition value) override;
@@ -54,16 +80,18 @@ class ChassisSMP : public ChassisInherit
     void startMonitoring();
 
   private:
-    /** @brief Handle systemd JobNew signals for chassis 0 targets
+    /** @brief Handle systemd JobNew signals for the aggregator targets
      *
      * This ensures that when systemd targets are started directly (not via
      * the D-Bus API), the transition is still forwarded to all chassis
      * instances to maintain SMP coordination. Monitors both poweron and
-     * poweroff targets for chassis 0.
+     * poweroff targets of the aggregator.
      *
      * @param[in] msg - D-Bus message containing job information
+     *
+     * @return true if the signal was acted on
      */
-    void sysStateChangeJobNew(sdbusplus::message_t& msg);
+    bool sysStateChangeJobNew(sdbusplus::message_t& msg);
 
     /** @brief Start the systemd unit requested
      *
@@ -73,21 +101,67 @@ class ChassisSMP : public ChassisInherit
      */
     void startUnit(const std::string& sysdUnit);
 
+    /** @brief Aggregate the power state and status of the collected changes
+     *
+     * Without an aggregation delay this runs once the event loop has
+     * handled the signals already queued, otherwise after the delay. Either
+     * way a burst of signals results in a single aggregation.
+     *
+     * @param[in] changes - The chassis changes collected
+     */
+    void runAggregation(size_t changes);
+
     /** @brief Aggregate power state from all chassis instances
      *
-     * Determines the overall power state by checking all chassis instances.
+     * Determines the overall power state from the per state counts of the
+     * present chassis, without any D-Bus call.
      * If any chassis is On, the aggregate state is On.
      */
     void aggregatePowerState();
 
     /** @brief Aggregate power status from all chassis instances
      *
-     * Determines the overall power status by checking all chassis instances.
+     * Determines the overall power status from the per status counts of the
+     * present chassis, without any D-Bus call.
      * Uses the worst-case status (e.g., if any chassis has bad power, report
      * bad).
      */
     void aggregatePowerStatus();
 
+    /** @brief Read the power state of a chassis instance
+     *
+     * @param[in] chassisId - ID of the chassis to read
+     * @return The power state, std::nullopt if it couldn't be read
+     */
+    std::optional<PowerState> readPowerState(size_t chassisId);
+
+    /** @brief Read the power status of a chassis instance
+     *
+     * @param[in] chassisId - ID of the chassis to read
+     * @return The power status, std::nullopt if it couldn't be read
+     */
+    std::optional<PowerStatus> readPowerStatus(size_t chassisId);
+
+    /** @brief Re-read the cached state and status of a chassis instance
+     *
+     * A value that can't be read is cached as Off or Good.
+     *
+     * @param[in] chassisId - ID of the chassis to read
+     */
+    void refreshChassis(size_t chassisId);
+
+    /** @brief Match the state changes of each present chassis
+     *
+     * Only used with groups, where each aggregator has few members.
+     */
+    void updateStateMatches();
+
+    /** @brief Re-read all present chassis and correct the cache
+     *
+     * Run periodically to recover from a missed PropertiesChanged signal.
+     */
+    void auditChassis();
+
     /** @brief Handle property changes from monitored chassis instances
      *
      * @param[in] msg - D-Bus message containing property changes
@@ -96,17 +170,41 @@ class ChassisSMP : public ChassisInherit
     void chassisPropertyChanged(sdbusplus::message_t& msg, size_t chassisId);
 
     /** @brief Send power transition request to all chassis instances
+     *
+     * The requests are sent concurrently. The per chassis results are
+     * collected by fanOutReply() and reported once all have replied.
+     * A fan-out still in progress is abandoned and reported as is.
      *
      * @param[in] transition - The requested transition
      */
     void requestTransitionOnAllChassis(Transition transition);
 
-    /** @brief Check if a chassis is present in the inventory
+    /** @brief Record the reply of a chassis to a forwarded transition
+     *
+     * @param[in] chassisId - ID of the chassis that replied
+     * @param[in] reply     - The reply
+     */
+    void fanOutReply(size_t chassisId, sdbusplus::message_t& reply);
+
+    /** @brief Record the result of a chassis for a forwarded transition
      *
-     * @param[in] chassisId - ID of the chassis to check
-     * @return true if chassis is present, false otherwise
+     * @param[in] chassisId - ID of the chassis
+     * @param[in] reason    - Why it failed, empty if it succeeded
      */
-    bool isChassisPresent(size_t chassisId);
+    void fanOutResult(size_t chassisId, const std::string& reason);
+
+    /** @brief Log and publish the results of the forwarded transition */
+    void reportFanOut();
+
+    /** @brief Record a chassis power state in the transition timeline
+     *
+     * @param[in] chassisId - ID of the chassis
+     * @param[in] state     - Its new power state
+     */
+    void recordTimeline(size_t chassisId, PowerState state);
+
+    /** @brief Log the slowest chassis of the completed transition timeline */
+    void reportTimeline();
 
     /** @brief Handle inventory Present property changes
      *
@@ -115,30 +213,117 @@ class ChassisSMP : public ChassisInherit
      */
     void inventoryPresentChanged(sdbusplus::message_t& msg, size_t chassisId);
 
+    /** @brief Handle a chassis inventory item being added
+     *
+     * @param[in] msg - D-Bus InterfacesAdded message
+     */
+    void inventoryItemAdded(sdbusplus::message_t& msg);
+
+    /** @brief Handle a chassis inventory item being removed
+     *
+     * @param[in] msg - D-Bus InterfacesRemoved message
+     */
+    void inventoryItemRemoved(sdbusplus::message_t& msg);
+
     /** @brief Persistent sdbusplus DBus connection. */
     sdbusplus::bus_t& bus;
 
-    /** @brief Number of chassis instances to aggregate (1-N). **/
+    /** @brief Name of this aggregator in the logs. **/
+    const std::string name;
+
+    /** @brief Targets of this aggregator, of the chassis or partition. **/
+    const std::string poweronTarget;
+    const std::string poweroffTarget;
+    const std::string powercycleTarget;
+
+    /** @brief Highest chassis ID to aggregate. **/
     const size_t numChassis;
 
-    /** @brief Property change signal matches for each chassis instance.
-     *  Maps chassis ID to its match object. **/
-    std::map<size_t, std::unique_ptr<sdbusplus::match>> chassisMatches;
+    /** @brief Chassis this aggregator may aggregate, if in the inventory. **/
+    const ChassisSet<> leaves;
+
+    /** @brief Groups this aggregator aggregates. **/
+    const ChassisSet<> subGroups;
+
+    /** @brief Whether to match each member rather than the namespace. **/
+    const bool perChassisMatches;
+
+    /** @brief Room for every value of the PowerState enum **/
+    static constexpr size_t powerStateRoom =
+        enumValueRoom<PowerState::Off, PowerState::TransitioningToOff,
+                      PowerState::On, PowerState::TransitioningToOn>;
+
+    /** @brief Room for every value of the PowerStatus enum **/
+    static constexpr size_t powerStatusRoom =
+        enumValueRoom<PowerStatus::Undefined, PowerStatus::BrownOut,
+                      PowerStatus::UninterruptiblePowerSupply,
+                      PowerStatus::Good>;
+
+    /** @brief Property change signal match for all chassis instances. **/
+    std::unique_ptr<sdbusplus::match> chassisStateMatch;
 
-    /** @brief Inventory Present property change signal matches. **/
-    std::vector<std::unique_ptr<sdbusplus::match>> inventoryPresentMatches;
+    /** @brief Property change signal matches, by chassis ID. **/
+    std::map<size_t, std::unique_ptr<sdbusplus::match>> chassisStateMatches;
 
-    /** @brief Systemd JobNew signal match for chassis 0 target monitoring. **/
-    sdbusplus::match systemdSignalJobNew;
+    /** @brief Inventory Present property change signal match for all
+     *  chassis instances. **/
+    std::unique_ptr<sdbusplus::match> inventoryPresentMatch;
+
+    /** @brief Chassis inventory item added signal match. **/
+    std::unique_ptr<sdbusplus::match> inventoryAddedMatch;
+
+    /** @brief Chassis inventory item removed signal match. **/
+    std::unique_ptr<sdbusplus::match> inventoryRemovedMatch;
+
+    /** @brief Systemd JobNew signal matches for the aggregator targets. **/
+    utils::SystemdJobSignals systemdSignalJobNew;
 
     /** @brief Cached power states from each chassis instance. **/
-    std::map<size_t, PowerState> chassisPowerStates;
+    ChassisStateTable<PowerState, powerStateRoom> chassisPowerStates{
+        PowerState::Off};
 
     /** @brief Cached power status from each chassis instance. **/
-    std::map<size_t, PowerStatus> chassisPowerStatus;
+    ChassisStateTable<PowerStatus, powerStatusRoom> chassisPowerStatus{
+        PowerStatus::Good};
+
+    /** @brief Groups and chassis instances having an inventory item. **/
+    ChassisSet<> chassisMembers;
+
+    /** @brief Cached present status of the member chassis instances. **/
+    ChassisSet<> chassisPresent;
+
+    /** @brief Timer running the periodic consistency audit. **/
+    sdeventplus::utility::Timer<sdeventplus::ClockId::Monotonic> auditTimer;
+
+    /** @brief Collects the chassis changes before aggregating them. **/
+    ChangeCoalescer aggregation;
+
+    /** @brief Transition being forwarded to the chassis instances. **/
+    Transition fanOutTransition = Transition::Off;
+
+    /** @brief When the transition forwarding started. **/
+    std::chrono::steady_clock::time_point fanOutStart;
+
+    /** @brief Pending forwarding calls, by chassis ID. **/
+    utils::PendingCalls<size_t> fanOutCalls;
+
+    /** @brief Forwarding errors by chassis ID, empty when it succeeded. **/
+    std::map<size_t, std::string> fanOutErrors;
+
+    /** @brief Forwarding latency of each chassis that replied. **/
+    std::map<size_t, std::chrono::milliseconds> fanOutLatencies;
+
+    /** @brief The published result of the last forwarded transition. **/
+    utils::StatisticsInterface fanOutStatistics;
+
+    /** @brief Per chassis timelines of the last forwarded transitions. **/
+    TransitionTimelines timelines{SMP_TIMELINE_DEPTH};
+
+    /** @brief Whether the timelines changed since they were published. **/
+    bool timelinesChanged = false;
 
-    /** @brief Cached present status from each chassis instance. **/
-    std::map<size_t, bool> chassisPresentStatus;
+    /** @brief The published transition timelines. **/
+    utils::StatisticsInterface timelineStatistics;
 
     /** @brief Flag to track if we've initiated a coordinated power off due to
      * failure. Prevents repeated power off requests as each chassis transitions
@@ -2,14 +2,22 @@
 
 #include "chassis_wait_for_smp_poweron.hpp"
 
-#include "utils.hpp"
+#include "chassis_smp_presence.hpp"
+
+#include <getopt.h>
 
 #include <phosphor-logging/lg2.hpp>
 #include <sdbusplus/exception.hpp>
 #include <xyz/openbmc_project/Inventory/Item/common.hpp>
 
+#include <algorithm>
 #include <chrono>
+#include <cstdlib>
 #include <format>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
 namespace phosphor::state::manager
 {
@@ -20,18 +28,41 @@ namespace server = sdbusplus::server::xyz::openbmc_project::state;
 namespace sdbusRule = sdbusplus::match_rules;
 
 using PowerState = server::Chassis::PowerState;
-
 using InventoryItem = sdbusplus::common::xyz::openbmc_project::inventory::Item;
 
 constexpr auto PROPERTY_INTERFACE = "org.freedesktop.DBus.Properties";
 constexpr auto CHASSIS_INTERFACE = "xyz.openbmc_project.State.Chassis";
 
 SMPChassisWaiter::SMPChassisWaiter(
-    sdbusplus::bus_t& bus, sdeventplus::Event& event, size_t numChassis) :
-    bus(bus), event(event), numChassis(numChassis)
+    sdbusplus::bus_t& bus, sdeventplus::Event& event, size_t numChassis,
+    size_t hostId, const SMPConfig& config, std::chrono::seconds timeout) :
+    bus(bus), event(event), numChassis(numChassis),
+    hostChassis(config.chassisOfHost(hostId)), timeout(timeout),
+    deadlineTimer(event, [this](auto&) { deadlineExpired(); })
 {
-    info("SMP Chassis Waiter: Monitoring {NUM_CHASSIS} chassis instances",
-         "NUM_CHASSIS", numChassis);
+    if (numChassis > smpMaxChassis)
+    {
+        throw std::invalid_argument(std::format(
+            "SMP Chassis Waiter monitors at most {} chassis", smpMaxChassis));
+    }
+
+    // Waiting for nothing would let the host start on no chassis at all
+    if (hostChassis.none())
+    {
+        throw std::invalid_argument(
+            std::format("Host {} has no chassis in the SMP config", hostId));
+    }
+
+    info("SMP Chassis Waiter: Monitoring up to {NUM_CHASSIS} chassis "
+         "instances for host {HOST_ID}, timeout {TIMEOUT_S} s",
+         "NUM_CHASSIS", numChassis, "HOST_ID", hostId, "TIMEOUT_S",
+         timeout.count());
+
+    // The deadline covers the startup reads too
+    if (timeout.count() != 0)
+    {
+        deadlineTimer.restartOnce(timeout);
+    }
 
     // Initialize monitoring for all chassis
     initializeMonitoring();
@@ -47,107 +78,231 @@ int SMPChassisWaiter::run()
 
 void SMPChassisWaiter::initializeMonitoring()
 {
-    for (size_t i = 1; i <= numChassis; ++i)
-    {
-        // Check if chassis is present (read once at startup)
-        if (!isChassisPresent(i))
-        {
-            info("SMP Chassis Waiter: Chassis {CHASSIS_ID} is not "
-                 "present, skipping",
-                 "CHASSIS_ID", i);
-            continue;
-        }
-
-        presentChassis.insert(i);
+    // Monitor CurrentPowerState property changes of all chassis with one
+    // match, the chassis ID is decoded from the path of the signal
+    chassisMatch = std::make_unique<sdbusplus::match>(
+        bus,
+        sdbusRule::propertiesChangedNamespace(CHASSIS_STATE_NAMESPACE,
+                                              CHASSIS_INTERFACE),
+        [this](sdbusplus::message_t& msg) {
+            auto chassisId = chassisIdFromPath(
+                msg.get_path(), CHASSIS_STATE_PATH_PREFIX, numChassis);
+            if (chassisId && presentChassis.test(*chassisId))
+            {
+                chassisPowerStateChanged(msg, *chassisId);
+            }
+        });
+
+    // Follow the presence of the chassis while waiting, so a chassis
+    // removed or becoming absent doesn't hold the host up
+    inventoryPresentMatch = std::make_unique<sdbusplus::match>(
+        bus,
+        sdbusRule::propertiesChangedNamespace(CHASSIS_INVENTORY_NAMESPACE,
+                                              InventoryItem::interface),
+        [this](sdbusplus::message_t& msg) {
+            auto chassisId = chassisIdFromPath(
+                msg.get_path(), CHASSIS_INVENTORY_PATH_PREFIX, numChassis);
+            if (chassisId && hostChassis.test(*chassisId))
+            {
+                inventoryPresentChanged(msg, *chassisId);
+            }
+        });
+
+    inventoryAddedMatch = std::make_unique<sdbusplus::match>(
+        bus,
+        sdbusRule::interfacesAdded() +
+            sdbusRule::argNpath(0, std::string(CHASSIS_INVENTORY_NAMESPACE) +
+                                       "/"),
+        [this](sdbusplus::message_t& msg) { inventoryItemAdded(msg); });
+
+    inventoryRemovedMatch = std::make_unique<sdbusplus::match>(
+        bus,
+        sdbusRule::interfacesRemoved() +
+            sdbusRule::argNpath(0, std::string(CHASSIS_INVENTORY_NAMESPACE) +
+                                       "/"),
+        [this](sdbusplus::message_t& msg) { inventoryItemRemoved(msg); });
+
+    // Discover the present chassis of the host in one pass, numChassis is
+    // only the highest ID accepted
+    auto inventory = readChassisInventory(bus, numChassis);
+    presentChassis = inventory.present & hostChassis;
+
+    auto absentChassis = inventory.members & hostChassis & ~presentChassis;
+    forEachChassis(absentChassis, [](size_t i) {
+        info("SMP Chassis Waiter: Chassis {CHASSIS_ID} is not "
+             "present, skipping",
+             "CHASSIS_ID", i);
+    });
+
+    // Read the initial power states concurrently, the replies are handled
+    // by the event loop
+    forEachChassis(presentChassis, [this](size_t i) { probeChassis(i); });
 
-        // Monitor chassis CurrentPowerState property changes
-        sdbusplus::object_path chassisPath =
-            std::format("/xyz/openbmc_project/state/chassis{}", i);
+    info("SMP Chassis Waiter: Monitoring {NUM_PRESENT} present chassis",
+         "NUM_PRESENT", presentChassis.count());
+}
 
-        auto chassisMatch = std::make_unique<sdbusplus::match>(
-            bus,
-            sdbusRule::propertiesChanged(chassisPath.string(),
-                                         CHASSIS_INTERFACE),
-            [this, i](sdbusplus::message_t& msg) {
-                chassisPowerStateChanged(msg, i);
-            });
+void SMPChassisWaiter::probeChassis(size_t chassisId)
+{
+    sdbusplus::object_path chassisPath =
+        std::format("{}{}", CHASSIS_STATE_PATH_PREFIX, chassisId);
+    std::string chassisService =
+        std::format("xyz.openbmc_project.State.Chassis{}", chassisId);
 
-        chassisMatches.push_back(std::move(chassisMatch));
+    poweredOnChassis.reset(chassisId);
+    try
+    {
+        auto method = bus.new_method_call(chassisService.c_str(), chassisPath,
+                                          PROPERTY_INTERFACE, "Get");
+        method.append(CHASSIS_INTERFACE, "CurrentPowerState");
 
-        // Get initial power state
-        updateChassisPowerState(i);
+        chassisProbes.call(chassisId, method, [this, chassisId](auto& reply) {
+            probeReply(chassisId, reply);
+        });
+    }
+    catch (const sdbusplus::exception_t& e)
+    {
+        error("SMP Chassis Waiter: Failed to get power state for chassis "
+              "{CHASSIS_ID}: {ERROR}",
+              "CHASSIS_ID", chassisId, "ERROR", e.what());
+        chassisProbes.cancel(chassisId);
     }
-
-    info("SMP Chassis Waiter: Monitoring {NUM_PRESENT} present chassis",
-         "NUM_PRESENT", presentChassis.size());
 }
 
-bool SMPChassisWaiter::isChassisPresent(size_t chassisId)
+void SMPChassisWaiter::probeReply(size_t chassisId,
+                                  sdbusplus::message_t& reply)
 {
-    sdbusplus::object_path inventoryPath = std::format(
-        "/xyz/openbmc_project/inventory/system/chassis{}", chassisId);
-
     try
     {
-        auto inventoryBusName =
-            utils::getService(bus, inventoryPath.str, InventoryItem::interface);
-
-        auto method = bus.new_method_call(
-            inventoryBusName.c_str(), inventoryPath, PROPERTY_INTERFACE, "Get");
-        method.append(InventoryItem::interface,
-                      InventoryItem::property_names::present);
+        if (reply.is_method_error())
+        {
+            const auto* e = reply.get_error();
+            error("SMP Chassis Waiter: Failed to get power state for chassis "
+                  "{CHASSIS_ID}: {ERROR}",
+                  "CHASSIS_ID", chassisId, "ERROR",
+                  (e && e->name) ? e->name : "unknown D-Bus error");
+        }
+        else
+        {
+            std::variant<std::string> propertyValue;
+            reply.read(propertyValue);
 
-        auto response = bus.call(method);
-        std::variant<bool> value;
-        response.read(value);
+            auto stateStr = std::get<std::string>(propertyValue);
+            auto state =
+                server::Chassis::convertPowerStateFromString(stateStr);
+            poweredOnChassis.set(chassisId, state == PowerState::On);
 
-        return std::get<bool>(value);
+            debug("SMP Chassis Waiter: Chassis {CHASSIS_ID} power state: "
+                  "{STATE}",
+                  "CHASSIS_ID", chassisId, "STATE", stateStr);
+        }
     }
-    catch (const sdbusplus::exception_t& e)
+    catch (const std::exception& e)
     {
-        debug("SMP Chassis Waiter: Could not read Present property for "
-              "chassis {CHASSIS_ID}: {ERROR}",
+        error("SMP Chassis Waiter: Failed to read power state of chassis "
+              "{CHASSIS_ID}: {ERROR}",
               "CHASSIS_ID", chassisId, "ERROR", e.what());
-        return false;
+    }
+
+    // Check once the snapshot is complete rather than on each reply
+    if (chassisProbes.empty())
+    {
+        checkAllChassisReady();
     }
 }
 
-void SMPChassisWaiter::updateChassisPowerState(size_t chassisId)
+void SMPChassisWaiter::setPresent(size_t chassisId, bool present)
 {
-    sdbusplus::object_path chassisPath =
-        std::format("/xyz/openbmc_project/state/chassis{}", chassisId);
-    std::string chassisService =
-        std::format("xyz.openbmc_project.State.Chassis{}", chassisId);
+    if (presentChassis.test(chassisId) == present)
+    {
+        return;
+    }
 
-    try
+    info("SMP Chassis Waiter: Chassis {CHASSIS_ID} presence changed to "
+         "{PRESENT}",
+         "CHASSIS_ID", chassisId, "PRESENT", present);
+
+    presentChassis.set(chassisId, present);
+    if (present)
     {
-        auto method = bus.new_method_call(chassisService.c_str(), chassisPath,
-                                          PROPERTY_INTERFACE, "Get");
-        method.append(CHASSIS_INTERFACE, "CurrentPowerState");
+        // Its signals were ignored while it wasn't present
+        probeChassis(chassisId);
+    }
+    else
+    {
+        chassisProbes.cancel(chassisId);
+        poweredOnChassis.reset(chassisId);
+    }
 
-        auto reply = bus.call(method);
-        std::variant<std::string> propertyValue;
-        reply.read(propertyValue);
+    checkAllChassisReady();
+}
 
-        auto stateStr = std::get<std::string>(propertyValue);
-        auto state = server::Chassis::convertPowerStateFromString(stateStr);
-        bool isOn = (state == PowerState::On);
+void SMPChassisWaiter::inventoryPresentChanged(sdbusplus::message_t& msg,
+                                               size_t chassisId)
+{
+    std::string interface;
+    std::map<std::string, std::variant<bool>> properties;
 
-        chassisPowerStates[chassisId] = isOn;
+    msg.read(interface, properties);
 
-        debug("SMP Chassis Waiter: Chassis {CHASSIS_ID} power state: "
-              "{STATE}",
-              "CHASSIS_ID", chassisId, "STATE", stateStr);
+    auto present = properties.find(InventoryItem::property_names::present);
+    if (present != properties.end())
+    {
+        setPresent(chassisId, std::get<bool>(present->second));
     }
-    catch (const sdbusplus::exception_t& e)
+}
+
+void SMPChassisWaiter::inventoryItemAdded(sdbusplus::message_t& msg)
+{
+    auto item = readAddedItem(bus, msg);
+    if (!item)
     {
-        error("SMP Chassis Waiter: Failed to get power state for chassis "
-              "{CHASSIS_ID}: {ERROR}",
-              "CHASSIS_ID", chassisId, "ERROR", e.what());
-        chassisPowerStates[chassisId] = false;
+        return;
+    }
+
+    auto chassisId = chassisIdFromPath(
+        item->first, CHASSIS_INVENTORY_PATH_PREFIX, numChassis);
+    if (chassisId && hostChassis.test(*chassisId) &&
+        !presentChassis.test(*chassisId))
+    {
+        setPresent(*chassisId, item->second);
+    }
+}
+
+void SMPChassisWaiter::inventoryItemRemoved(sdbusplus::message_t& msg)
+{
+    sdbusplus::object_path path;
+    std::vector<std::string> interfaces;
+    msg.read(path, interfaces);
+
+    auto chassisId =
+        chassisIdFromPath(path.str, CHASSIS_INVENTORY_PATH_PREFIX, numChassis);
+    if (chassisId && hostChassis.test(*chassisId) &&
+        std::ranges::find(interfaces, InventoryItem::interface) !=
+            interfaces.end())
+    {
+        setPresent(*chassisId, false);
     }
 }
 
+void SMPChassisWaiter::deadlineExpired()
+{
+    auto offChassis = laggards();
+
+    error("SMP Chassis Waiter: Timed out after {TIMEOUT_S} s, chassis "
+          "{LAGGARDS} not powered on, {NUM_OFF} of {NUM_PRESENT} present",
+          "TIMEOUT_S", timeout.count(), "LAGGARDS", chassisIdList(offChassis),
+          "NUM_OFF", offChassis.count(), "NUM_PRESENT",
+          presentChassis.count());
+
+    event.exit(timeoutExitCode);
+}
+
+ChassisSet<> SMPChassisWaiter::laggards() const
+{
+    return presentChassis & ~poweredOnChassis;
+}
+
 void SMPChassisWaiter::chassisPowerStateChanged(sdbusplus::message_t& msg,
                                                 size_t chassisId)
 {
@@ -162,11 +317,12 @@ void SMPChassisWaiter::chassisPowerStateChanged(sdbusplus::message_t& msg,
         return;
     }
 
+    // The signal is newer than any read still in flight
+    chassisProbes.cancel(chassisId);
+
     auto stateStr = std::get<std::string>(stateIt->second);
     auto state = server::Chassis::convertPowerStateFromString(stateStr);
-    bool isOn = (state == PowerState::On);
-
-    chassisPowerStates[chassisId] = isOn;
+    poweredOnChassis.set(chassisId, state == PowerState::On);
 
     info("SMP Chassis Waiter: Chassis {CHASSIS_ID} power state changed to "
          "{STATE}",
@@ -177,7 +333,7 @@ void SMPChassisWaiter::chassisPowerStateChanged(sdbusplus::message_t& msg,
 
 void SMPChassisWaiter::checkAllChassisReady()
 {
-    if (presentChassis.empty())
+    if (presentChassis.none())
     {
         warning("SMP Chassis Waiter: No chassis are present, exiting with "
                 "success");
@@ -185,49 +341,82 @@ void SMPChassisWaiter::checkAllChassisReady()
         return;
     }
 
-    size_t numOn = 0;
-    size_t numOff = 0;
-
-    for (size_t chassisId : presentChassis)
-    {
-        auto it = chassisPowerStates.find(chassisId);
-        if (it != chassisPowerStates.end() && it->second)
-        {
-            numOn++;
-        }
-        else
-        {
-            numOff++;
-        }
-    }
+    auto numPresent = presentChassis.count();
+    auto numOn = (presentChassis & poweredOnChassis).count();
+    auto numOff = numPresent - numOn;
 
     info("SMP Chassis Waiter: Status - {NUM_ON} chassis on, {NUM_OFF} "
          "chassis off/unknown out of {NUM_PRESENT} present",
-         "NUM_ON", numOn, "NUM_OFF", numOff, "NUM_PRESENT",
-         presentChassis.size());
+         "NUM_ON", numOn, "NUM_OFF", numOff, "NUM_PRESENT", numPresent);
 
-    if (numOn == presentChassis.size())
+    if (numOn == numPresent)
     {
         info("SMP Chassis Waiter: All {NUM_CHASSIS} present chassis are "
              "powered on, exiting with success",
-             "NUM_CHASSIS", presentChassis.size());
+             "NUM_CHASSIS", numPresent);
         event.exit(0);
     }
 }
 
 } // namespace phosphor::state::manager
 
-int main()
+int main(int argc, char** argv)
 {
     using namespace phosphor::state::manager;
 
+    size_t hostId = 0;
+    std::chrono::seconds timeout{SMP_WAIT_TIMEOUT_S};
+    int arg;
+    int optIndex = 0;
+    static struct option longOpts[] = {
+        {"host", required_argument, nullptr, 'h'},
+        {"timeout", required_argument, nullptr, 't'},
+        {nullptr, 0, nullptr, 0}};
+
+    while ((arg = getopt_long(argc, argv, "h:t:", longOpts, &optIndex)) != -1)
+    {
+        switch (arg)
+        {
+            case 'h':
+                hostId = std::stoul(optarg);
+                break;
+            case 't':
+                timeout = std::chrono::seconds{std::stoul(optarg)};
+                break;
+            default:
+                break;
+        }
+    }
+
     auto bus = sdbusplus::bus::new_bus();
     auto event = sdeventplus::Event::get_new();
 
     // Attach the bus to sd_event to service user requests
     bus.attach_event(event.get(), SD_EVENT_PRIORITY_NORMAL);
 
-    SMPChassisWaiter waiter(bus, event, NUM_CHASSIS_SMP);
+    // A broken config fails the wait rather than skip it
+    SMPConfig config;
+    try
+    {
+        config = loadSMPConfig(SMP_CONFIG_FILE, NUM_CHASSIS_SMP);
+    }
+    catch (const std::exception& e)
+    {
+        error("SMP Chassis Waiter: Invalid SMP config {CONFIG}: {ERROR}",
+              "CONFIG", SMP_CONFIG_FILE, "ERROR", e);
+        return EXIT_FAILURE;
+    }
+
+    if (config.chassisOfHost(hostId).none())
+    {
+        error("SMP Chassis Waiter: Host {HOST_ID} has no chassis in the SMP "
+              "config {CONFIG}",
+              "HOST_ID", hostId, "CONFIG", SMP_CONFIG_FILE);
+        return EXIT_FAILURE;
+    }
+
+    SMPChassisWaiter waiter(bus, event, NUM_CHASSIS_SMP, hostId, config,
+                            timeout);
 
     return waiter.run();
 }
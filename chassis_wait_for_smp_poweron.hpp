@@ -1,16 +1,20 @@
 #pragma once
 
+#include "chassis_smp_common.hpp"
+#include "chassis_smp_config.hpp"
+#include "utils.hpp"
+
 #include <sdbusplus/bus.hpp>
 #include <sdbusplus/bus/match.hpp>
+#include <sdeventplus/clock.hpp>
 #include <sdeventplus/event.hpp>
 #include <sdeventplus/source/signal.hpp>
+#include <sdeventplus/utility/timer.hpp>
 #include <xyz/openbmc_project/State/Chassis/server.hpp>
 
-#include <map>
+#include <chrono>
 #include <memory>
-#include <set>
 #include <string>
-#include <vector>
 
 namespace phosphor::state::manager
 {
@@ -19,10 +23,15 @@ namespace phosphor::state::manager
  * @class SMPChassisWaiter
  * @brief Waits for all SMP chassis instances to reach PowerState::On
  *
- * This service monitors chassis instances 1 through N in an SMP system and
+ * This service monitors the chassis instances of an SMP system and
  * exits successfully only when all present chassis have reached the On state.
- * This ensures that host services depending on obmc-power-on@0.target don't
- * start until all physical chassis hardware is actually powered on.
+ * This ensures that host services depending on obmc-power-on@N.target don't
+ * start until all physical chassis hardware is actually powered on. With
+ * partitions, each host only waits for the chassis of its own partition.
+ *
+ * Chassis leaving the inventory or becoming absent while waiting are no
+ * longer waited for. If the chassis don't all power on before the deadline
+ * the waiter gives up and exits with timeoutExitCode.
  */
 class SMPChassisWaiter
 {
@@ -34,43 +43,104 @@ class SMPChassisWaiter
     SMPChassisWaiter& operator=(SMPChassisWaiter&&) = delete;
     ~SMPChassisWaiter() = default;
 
+    /** @brief Exit code when the deadline passes before all chassis are on,
+     *         the waiter services count it as a success */
+    static constexpr int timeoutExitCode = 2;
+
     /**
      * @brief Constructor
      *
      * @param[in] bus - D-Bus connection
      * @param[in] event - Event loop
-     * @param[in] numChassis - Number of chassis to monitor (1-N)
+     * @param[in] numChassis - Highest chassis ID to monitor, the chassis
+     *                         themselves are discovered from the inventory
+     * @param[in] hostId - Host whose chassis to wait for
+     * @param[in] config - The arrangement of the chassis into partitions
+     * @param[in] timeout - Longest time to wait, 0 to wait forever
+     *
+     * @throw std::invalid_argument if the host has no chassis to wait for,
+     *        which is a configuration error
      */
-    SMPChassisWaiter(sdbusplus::bus_t& bus, sdeventplus::Event& event,
-                     size_t numChassis);
+    SMPChassisWaiter(
+        sdbusplus::bus_t& bus, sdeventplus::Event& event, size_t numChassis,
+        size_t hostId = 0, const SMPConfig& config = {},
+        std::chrono::seconds timeout = std::chrono::seconds{
+            SMP_WAIT_TIMEOUT_S});
 
     /**
      * @brief Run the event loop
      *
-     * @return Exit code (0 = success, all chassis powered on)
+     * @return Exit code (0 = success, all chassis powered on,
+     *         timeoutExitCode = the deadline passed)
      */
     int run();
 
   private:
+    friend class SMPChassisWaiterTest;
+
     /**
      * @brief Initialize monitoring for all chassis instances
      */
     void initializeMonitoring();
 
     /**
-     * @brief Check if a chassis is present in inventory
+     * @brief Read the power state of a chassis without waiting for it
+     *
+     * The reads of all chassis are in flight together, and the reply is
+     * handled by probeReply(). A signal arriving first supersedes the read.
+     *
+     * @param[in] chassisId - Chassis ID to read
+     */
+    void probeChassis(size_t chassisId);
+
+    /**
+     * @brief Handle the reply to the power state read of a chassis
+     *
+     * @param[in] chassisId - Chassis ID that was read
+     * @param[in] reply - The reply
+     */
+    void probeReply(size_t chassisId, sdbusplus::message_t& reply);
+
+    /**
+     * @brief Start or stop waiting for a chassis as its presence changes
+     *
+     * @param[in] chassisId - Chassis ID that changed
+     * @param[in] present - Whether it is now present
+     */
+    void setPresent(size_t chassisId, bool present);
+
+    /**
+     * @brief Handle inventory Present property changes
      *
-     * @param[in] chassisId - Chassis ID to check
-     * @return true if present, false otherwise
+     * @param[in] msg - D-Bus message
+     * @param[in] chassisId - Chassis ID that changed
+     */
+    void inventoryPresentChanged(sdbusplus::message_t& msg, size_t chassisId);
+
+    /**
+     * @brief Handle a chassis inventory item being added
+     *
+     * @param[in] msg - D-Bus InterfacesAdded message
      */
-    bool isChassisPresent(size_t chassisId);
+    void inventoryItemAdded(sdbusplus::message_t& msg);
 
     /**
-     * @brief Update cached power state for a chassis
+     * @brief Handle a chassis inventory item being removed
      *
-     * @param[in] chassisId - Chassis ID to update
+     * @param[in] msg - D-Bus InterfacesRemoved message
      */
-    void updateChassisPowerState(size_t chassisId);
+    void inventoryItemRemoved(sdbusplus::message_t& msg);
+
+    /**
+     * @brief The present chassis that aren't powered on yet
+     */
+    ChassisSet<> laggards() const;
+
+    /**
+     * @brief Log the chassis that didn't power on and exit with
+     *        timeoutExitCode
+     */
+    void deadlineExpired();
 
     /**
      * @brief Handle chassis CurrentPowerState property changes
@@ -93,17 +163,38 @@ class SMPChassisWaiter
     /** @brief Event loop */
     sdeventplus::Event& event;
 
-    /** @brief Number of chassis to monitor */
+    /** @brief Highest chassis ID to monitor */
     const size_t numChassis;
 
+    /** @brief Chassis the host runs on, if in the inventory */
+    const ChassisSet<> hostChassis;
+
     /** @brief Set of present chassis IDs */
-    std::set<size_t> presentChassis;
+    ChassisSet<> presentChassis;
+
+    /** @brief Set of chassis IDs that are powered on */
+    ChassisSet<> poweredOnChassis;
+
+    /** @brief Longest time to wait, 0 to wait forever */
+    const std::chrono::seconds timeout;
+
+    /** @brief D-Bus match for the property changes of all chassis */
+    std::unique_ptr<sdbusplus::match> chassisMatch;
+
+    /** @brief D-Bus match for the inventory Present changes of all chassis */
+    std::unique_ptr<sdbusplus::match> inventoryPresentMatch;
+
+    /** @brief D-Bus match for chassis inventory items being added */
+    std::unique_ptr<sdbusplus::match> inventoryAddedMatch;
+
+    /** @brief D-Bus match for chassis inventory items being removed */
+    std::unique_ptr<sdbusplus::match> inventoryRemovedMatch;
 
-    /** @brief Map of chassis ID to power state (true = On) */
-    std::map<size_t, bool> chassisPowerStates;
+    /** @brief Pending power state reads, by chassis ID */
+    utils::PendingCalls<size_t> chassisProbes;
 
-    /** @brief D-Bus matches for chassis property changes */
-    std::vector<std::unique_ptr<sdbusplus::match>> chassisMatches;
+    /** @brief Ends the wait at the deadline */
+    sdeventplus::utility::Timer<sdeventplus::ClockId::Monotonic> deadlineTimer;
 
     /** @brief Signal source for SIGINT */
     std::unique_ptr<sdeventplus::source::Signal> sigintSource;
@@ -0,0 +1,161 @@
+#include "gpio_service.hpp"
+
+#include <sys/epoll.h>
+
+#include <phosphor-logging/lg2.hpp>
+#include <sdeventplus/event.hpp>
+
+#include <cerrno>
+
+namespace phosphor::state::manager::utils
+{
+
+PHOSPHOR_LOG2_USING;
+
+constexpr auto GPIO_CONSUMER = "state-manager";
+
+GpioService& GpioService::instance()
+{
+    static GpioService service;
+    return service;
+}
+
+GpioService::~GpioService()
+{
+    watches.clear();
+    for (auto& [name, line] : lines)
+    {
+        if (line != nullptr)
+        {
+            gpiod_line_close_chip(line);
+        }
+    }
+}
+
+gpiod_line* GpioService::resolve(const std::string& name)
+{
+    auto it = lines.find(name);
+    if (it != lines.end())
+    {
+        return it->second;
+    }
+
+    // This scans the gpiochips, the chip of a found line stays open
+    errno = 0;
+    auto* line = gpiod_line_find(name.c_str());
+    if (line == nullptr)
+    {
+        // A gpiochip probed late shows up on a later lookup, so only a
+        // name missing from every chip is remembered
+        if (errno != ENOENT)
+        {
+            error("Failed to look up GPIO {GPIO_NAME}: {ERRNO}", "GPIO_NAME",
+                  name, "ERRNO", errno);
+            return nullptr;
+        }
+        debug("GPIO {GPIO_NAME} not found", "GPIO_NAME", name);
+    }
+    lines.emplace(name, line);
+    return line;
+}
+
+int GpioService::getValue(const std::string& name)
+{
+    auto watched = watches.find(name);
+    if (watched != watches.end())
+    {
+        return watched->second.value;
+    }
+
+    auto* line = resolve(name);
+    if (line == nullptr)
+    {
+        return -1;
+    }
+
+    // take ownership of gpio
+    if (0 != gpiod_line_request_input(line, GPIO_CONSUMER))
+    {
+        error("Failed request for {GPIO_NAME} GPIO", "GPIO_NAME", name);
+        return -1;
+    }
+
+    int gpioval = gpiod_line_get_value(line);
+
+    // release ownership of gpio, the chip stays open
+    gpiod_line_release(line);
+
+    return gpioval;
+}
+
+bool GpioService::watch(const std::string& name, EdgeHandler handler)
+{
+    auto watched = watches.find(name);
+    if (watched != watches.end())
+    {
+        watched->second.handlers.emplace_back(std::move(handler));
+        return true;
+    }
+
+    auto* line = resolve(name);
+    if (line == nullptr)
+    {
+        return false;
+    }
+
+    if (0 != gpiod_line_request_both_edges_events(line, GPIO_CONSUMER))
+    {
+        error("Failed edge event request for {GPIO_NAME} GPIO", "GPIO_NAME",
+              name);
+        return false;
+    }
+
+    int fd = gpiod_line_event_get_fd(line);
+    int gpioval = gpiod_line_get_value(line);
+    if ((fd < 0) || (gpioval < 0))
+    {
+        error("Failed to set up edge events for {GPIO_NAME} GPIO",
+              "GPIO_NAME", name);
+        gpiod_line_release(line);
+        return false;
+    }
+
+    auto& entry = watches[name];
+    entry.value = gpioval;
+    entry.source = std::make_unique<sdeventplus::source::IO>(
+        sdeventplus::Event::get_default(), fd, EPOLLIN,
+        [this, name](sdeventplus::source::IO&, int, uint32_t) {
+            edgeEvent(name);
+        });
+    entry.handlers.emplace_back(std::move(handler));
+    return true;
+}
+
+void GpioService::edgeEvent(const std::string& name)
+{
+    auto& entry = watches.at(name);
+
+    gpiod_line_event lineEvent{};
+    if (gpiod_line_event_read(lines.at(name), &lineEvent) < 0)
+    {
+        error("Failed to read edge event for {GPIO_NAME} GPIO: {ERRNO}",
+              "GPIO_NAME", name, "ERRNO", errno);
+        return;
+    }
+
+    int gpioval = (lineEvent.event_type == GPIOD_LINE_EVENT_RISING_EDGE) ? 1
+                                                                          : 0;
+    entry.value = gpioval;
+
+    debug("GPIO {GPIO_NAME} changed to {VALUE}", "GPIO_NAME", name, "VALUE",
+          gpioval);
+
+    // Copy in case a handler adds another subscription
+    auto handlers = entry.handlers;
+    for (const auto& handler : handlers)
+    {
+        handler(gpioval);
+    }
+}
+
+} // namespace phosphor::state::manager::utils
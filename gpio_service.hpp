@@ -0,0 +1,97 @@
+#pragma once
+
+#include <gpiod.h>
+
+#include <sdeventplus/source/io.hpp>
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace phosphor::state::manager::utils
+{
+
+/** @class GpioService
+ *  @brief Process wide cache of GPIO lines looked up by name
+ *  @details Each line name is resolved once, scanning the gpiochips only on
+ *  the first use, and the chip handle stays open for later reads. Names
+ *  that don't exist on the board are remembered too, so a missing optional
+ *  line doesn't cause a rescan on every read.
+ *
+ *  Lines read on demand are only requested for the duration of the read,
+ *  since other daemons read the same lines. A watched line stays requested
+ *  and its value is taken from the edge events delivered through sd-event.
+ */
+class GpioService
+{
+  public:
+    /** @brief Called with the new line value on each edge */
+    using EdgeHandler = std::function<void(int value)>;
+
+    GpioService(const GpioService&) = delete;
+    GpioService& operator=(const GpioService&) = delete;
+    GpioService(GpioService&&) = delete;
+    GpioService& operator=(GpioService&&) = delete;
+
+    /** @brief Get the process wide instance */
+    static GpioService& instance();
+
+    /** @brief Read the value of a GPIO line
+     *
+     * @param[in] name       - The name of the GPIO line
+     *
+     * @return The value of the gpio (0 or 1) or -1 on error
+     */
+    int getValue(const std::string& name);
+
+    /** @brief Subscribe to both edges of a GPIO line
+     *
+     * The edges are delivered by the default event loop. The line stays
+     * requested until the process exits, and getValue() returns the value
+     * of the last edge from then on.
+     *
+     * @param[in] name       - The name of the GPIO line
+     * @param[in] handler    - Called with the new value on each edge
+     *
+     * @return true if the subscription was set up
+     */
+    bool watch(const std::string& name, EdgeHandler handler);
+
+  private:
+    GpioService() = default;
+    ~GpioService();
+
+    /** @brief Edge subscription of a watched line */
+    struct Watch
+    {
+        /** @brief Value of the last edge */
+        int value = 0;
+
+        /** @brief Edge event source */
+        std::unique_ptr<sdeventplus::source::IO> source;
+
+        /** @brief Handlers called on each edge */
+        std::vector<EdgeHandler> handlers;
+    };
+
+    /** @brief Resolve a line name, using the cache when possible
+     *
+     * @return The line, nullptr if it doesn't exist or couldn't be looked
+     *         up
+     */
+    gpiod_line* resolve(const std::string& name);
+
+    /** @brief Read and dispatch the pending edge event of a line */
+    void edgeEvent(const std::string& name);
+
+    /** @brief Resolved lines keyed by name, nullptr for names that don't
+     *  exist */
+    std::map<std::string, gpiod_line*> lines;
+
+    /** @brief Edge subscriptions keyed by line name */
+    std::map<std::string, Watch> watches;
+};
+
+} // namespace phosphor::state::manager::utils
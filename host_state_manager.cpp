@@ -50,8 +50,15 @@ constexpr auto AUTO_REBOOT_PROPERTY = "AutoReboot";
 
 void Host::determineInitialState()
 {
-    if (utils::stateActive(bus, getTarget(server::Host::HostState::Running)) ||
-        isHostRunning(id))
+    bool running = false;
+    {
+        auto phase = utils::StartupTimer::instance().phase("host_check");
+        running = unitStates.stateActive(
+                      getTarget(server::Host::HostState::Running)) ||
+                  isHostRunning(id);
+    }
+
+    if (running)
     {
         info("Initial Host State will be Running");
         server::Host::currentHostState(HostState::Running, true);
@@ -64,7 +71,13 @@ void Host::determineInitialState()
         server::Host::requestedHostTransition(Transition::Off, true);
     }
 
-    if (!deserialize())
+    bool restored = false;
+    {
+        auto phase = utils::StartupTimer::instance().phase("deserialize");
+        restored = deserialize();
+    }
+
+    if (!restored)
     {
         // set to default value.
         server::Host::requestedHostTransition(Transition::Off, true);
@@ -127,6 +140,17 @@ void Host::createSystemdTargetMaps()
     }
 
     hostCrashTarget = std::format("obmc-host-crash@{}.target", id);
+
+    // Track the state targets checked when their jobs complete and only
+    // have the bus deliver job signals for this host's targets
+    for (auto state : {HostState::Off, HostState::Running, HostState::Quiesced})
+    {
+        unitStates.track(getTarget(state));
+        systemdSignalJobRemoved.watch(getTarget(state));
+    }
+
+    systemdSignalJobNew.watch(getTarget(HostState::DiagnosticMode));
+    systemdSignalJobNew.watch(hostCrashTarget);
 }
 
 const std::string& Host::getTarget(HostState state)
@@ -264,7 +288,7 @@ void Host::removeRunningFile()
     }
 }
 
-void Host::sysStateChangeJobRemoved(sdbusplus::message_t& msg)
+bool Host::sysStateChangeJobRemoved(sdbusplus::message_t& msg)
 {
     uint32_t newStateID{};
     sdbusplus::object_path newStateObjPath;
@@ -275,17 +299,19 @@ void Host::sysStateChangeJobRemoved(sdbusplus::message_t& msg)
     msg.read(newStateID, newStateObjPath, newStateUnit, newStateResult);
 
     if ((newStateUnit == getTarget(server::Host::HostState::Off)) &&
-        (newStateResult == "done") && (utils::stateActive(bus, newStateUnit)))
+        (newStateResult == "done") && (unitStates.stateActive(newStateUnit)))
     {
         info("Received signal that host is off");
         this->currentHostState(server::Host::HostState::Off);
         this->bootProgress(bootprogress::Progress::ProgressStages::Unspecified);
         this->operatingSystemState(osstatus::Status::OSStatus::Inactive);
         removeRunningFile();
+        transitionLatency.complete(convertForMessage(Transition::Off));
+        return true;
     }
     else if ((newStateUnit == getTarget(server::Host::HostState::Running)) &&
              (newStateResult == "done") &&
-             (utils::stateActive(bus, newStateUnit)))
+             (unitStates.stateActive(newStateUnit)))
     {
         info("Received signal that host is running");
         this->currentHostState(server::Host::HostState::Running);
@@ -296,10 +322,18 @@ void Host::sysStateChangeJobRemoved(sdbusplus::message_t& msg)
         // that the host is already running and they should skip running.
         // Once the host state is back to running we can clear this file.
         removeRunningFile();
+        transitionLatency.complete(convertForMessage(Transition::On));
+        for (auto transition : {Transition::Reboot,
+                                Transition::GracefulWarmReboot,
+                                Transition::ForceWarmReboot})
+        {
+            transitionLatency.completeCycle(convertForMessage(transition));
+        }
+        return true;
     }
     else if ((newStateUnit == getTarget(server::Host::HostState::Quiesced)) &&
              (newStateResult == "done") &&
-             (utils::stateActive(bus, newStateUnit)))
+             (unitStates.stateActive(newStateUnit)))
     {
         if (Host::isAutoReboot())
         {
@@ -311,10 +345,13 @@ void Host::sysStateChangeJobRemoved(sdbusplus::message_t& msg)
             info("Maintaining quiesce");
             this->currentHostState(server::Host::HostState::Quiesced);
         }
+        return true;
     }
+
+    return false;
 }
 
-void Host::sysStateChangeJobNew(sdbusplus::message_t& msg)
+bool Host::sysStateChangeJobNew(sdbusplus::message_t& msg)
 {
     uint32_t newStateID{};
     sdbusplus::object_path newStateObjPath;
@@ -327,6 +364,7 @@ void Host::sysStateChangeJobNew(sdbusplus::message_t& msg)
     {
         info("Received signal that host is in diagnostic mode");
         this->currentHostState(server::Host::HostState::DiagnosticMode);
+        return true;
     }
     else if ((newStateUnit == hostCrashTarget) &&
              (server::Host::currentHostState() ==
@@ -341,7 +379,10 @@ void Host::sysStateChangeJobNew(sdbusplus::message_t& msg)
         // A host crash can cause a reboot of the host so decrement the reboot
         // count
         decrementRebootCount();
+        return true;
     }
+
+    return false;
 }
 
 uint32_t Host::decrementRebootCount()
@@ -354,28 +395,72 @@ uint32_t Host::decrementRebootCount()
     return rebootCount;
 }
 
-fs::path Host::serialize()
+void Host::serialize()
 {
-    fs::path path{std::format(HOST_STATE_PERSIST_PATH, id)};
-    std::ofstream os(path.c_str(), std::ios::binary);
-    cereal::JSONOutputArchive oarchive(os);
-    oarchive(*this);
-    return path;
+    persistFile.update();
+}
+
+Host::PersistData Host::persistData() const
+{
+    return PersistData{
+        reboot::RebootAttempts::retryAttempts(),
+        EnumString(convertForMessage(server::Host::requestedHostTransition())),
+        EnumString(convertForMessage(bootprogress::Progress::bootProgress())),
+        EnumString(
+            convertForMessage(osstatus::Status::operatingSystemState()))};
 }
 
 bool Host::deserialize()
+{
+    PersistData data{};
+    if (!persistFile.restore(data))
+    {
+        return migrateLegacyState();
+    }
+
+    try
+    {
+        // When restoring, set the requested state with persistent value
+        // but don't call the override which would execute it
+        server::Host::requestedHostTransition(
+            convertTransitionFromString(data.requestedHostTransition.str()),
+            true);
+        bootprogress::Progress::bootProgress(
+            convertProgressStagesFromString(data.bootProgress.str()), true);
+        osstatus::Status::operatingSystemState(
+            convertOSStatusFromString(data.operatingSystemState.str()), true);
+        reboot::RebootAttempts::retryAttempts(data.retryAttempts, true);
+        return true;
+    }
+    catch (const std::exception& e)
+    {
+        error("Invalid persisted host state in {PATH}: {ERROR}", "PATH",
+              persistFile.path(), "ERROR", e);
+        return false;
+    }
+}
+
+bool Host::migrateLegacyState()
 {
     fs::path path{std::format(HOST_STATE_PERSIST_PATH, id)};
     try
     {
-        if (fs::exists(path))
+        if (!fs::exists(path))
+        {
+            return false;
+        }
+
         {
             std::ifstream is(path.c_str(), std::ios::in | std::ios::binary);
             cereal::JSONInputArchive iarchive(is);
             iarchive(*this);
-            return true;
         }
-        return false;
+
+        info("Migrating persisted host state from {LEGACY} to {PATH}",
+             "LEGACY", path, "PATH", persistFile.path());
+        persistFile.store(persistData());
+        fs::remove(path);
+        return true;
     }
     catch (const cereal::Exception& e)
     {
@@ -383,6 +468,12 @@ bool Host::deserialize()
         fs::remove(path);
         return false;
     }
+    catch (const fs::filesystem_error& e)
+    {
+        error("Failed to migrate {LEGACY}: {ERROR}", "LEGACY", path, "ERROR",
+              e);
+        return false;
+    }
 }
 
 Host::Transition Host::requestedHostTransition(Transition value)
@@ -424,6 +515,7 @@ Host::Transition Host::requestedHostTransition(Transition value)
     }
 
     executeTransition(value);
+    transitionLatency.start(convertForMessage(value));
 
     auto retVal = server::Host::requestedHostTransition(value);
 
@@ -439,7 +531,9 @@ Host::ProgressStages Host::bootProgress(ProgressStages value)
     auto timeStamp = std::chrono::duration_cast<std::chrono::microseconds>(
                          std::chrono::system_clock::now().time_since_epoch())
                          .count();
-    this->bootProgressLastUpdate(timeStamp);
+    // Set the base property directly, the override would persist the same
+    // state a second time
+    bootprogress::Progress::bootProgressLastUpdate(timeStamp);
     serialize();
     return retVal;
 }
@@ -462,6 +556,11 @@ Host::HostState Host::currentHostState(HostState value)
 {
     info("Change to Host{HOST_ID} State: {STATE}", "HOST_ID", id, "STATE",
          value);
+    if (value != HostState::Running)
+    {
+        // A reboot only completes once running again after this
+        transitionLatency.departed();
+    }
     return server::Host::currentHostState(value);
 }
 
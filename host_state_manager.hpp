@@ -2,19 +2,25 @@
 
 #include "config.h"
 
+#include "persistent_file.hpp"
 #include "settings.hpp"
+#include "statistics.hpp"
+#include "transition_latency.hpp"
 #include "utils.hpp"
 
 #include <cereal/access.hpp>
 #include <cereal/cereal.hpp>
 #include <phosphor-logging/lg2.hpp>
 #include <sdbusplus/bus.hpp>
+#include <sdeventplus/event.hpp>
 #include <xyz/openbmc_project/Control/Boot/RebootAttempts/server.hpp>
 #include <xyz/openbmc_project/State/Boot/Progress/server.hpp>
 #include <xyz/openbmc_project/State/Host/server.hpp>
 #include <xyz/openbmc_project/State/OperatingSystem/Status/server.hpp>
 
+#include <chrono>
 #include <filesystem>
+#include <format>
 #include <string>
 
 namespace phosphor::state::manager
@@ -52,19 +58,29 @@ class Host : public HostInherit
     Host(sdbusplus::bus_t& bus, const sdbusplus::object_path& objPath,
          size_t id) :
         HostInherit(bus, objPath, HostInherit::action::defer_emit), bus(bus),
-        systemdSignalJobRemoved(
-            bus,
-            sdbusRule::type::signal() + sdbusRule::member("JobRemoved") +
-                sdbusRule::path(SYSTEMD_OBJ_PATH) +
-                sdbusRule::interface(SYSTEMD_MANAGER_INTERFACE),
-            [this](sdbusplus::message_t& m) { sysStateChangeJobRemoved(m); }),
-        systemdSignalJobNew(
-            bus,
-            sdbusRule::type::signal() + sdbusRule::member("JobNew") +
-                sdbusRule::path(SYSTEMD_OBJ_PATH) +
-                sdbusRule::interface(SYSTEMD_MANAGER_INTERFACE),
-            [this](sdbusplus::message_t& m) { sysStateChangeJobNew(m); }),
-        settings(bus, id), id(id)
+        unitStates(bus),
+        systemdSignalJobRemoved(bus, "JobRemoved",
+                                [this](sdbusplus::message_t& m) {
+                                    return sysStateChangeJobRemoved(m);
+                                }),
+        systemdSignalJobNew(bus, "JobNew",
+                            [this](sdbusplus::message_t& m) {
+                                return sysStateChangeJobNew(m);
+                            }),
+        settings(utils::timedPhase("settings",
+                                   [&bus, id]() {
+                                       return settings::HostObjects(bus, id);
+                                   })),
+        id(id),
+        persistStatistics(bus, objPath.str,
+                          utils::PERSIST_STATISTICS_INTERFACE),
+        persistFile(
+            sdeventplus::Event::get_default(),
+            std::format(HOST_STATE_PERSIST_PATH, id) + JOURNAL_FILE_SUFFIX,
+            persistVersion, [this]() { return persistData(); },
+            std::chrono::milliseconds(PERSIST_WRITE_WINDOW_MS)),
+        transitionLatency(bus, sdeventplus::Event::get_default(), objPath.str,
+                          std::format(HOST_TRANSITION_LATENCY_PERSIST_PATH, id))
     {
         // Enable systemd signals
         utils::subscribeToSystemdSignals(bus);
@@ -72,8 +88,14 @@ class Host : public HostInherit
         // create map of target name base on host id
         createSystemdTargetMaps();
 
+        persistFile.publishTo(persistStatistics);
+        transitionLatency.publishWritesTo(persistStatistics);
+
         // Will throw exception on fail
-        determineInitialState();
+        {
+            auto phase = utils::StartupTimer::instance().phase("initial_state");
+            determineInitialState();
+        }
 
         // Setup supported transitions against this host object
         setupSupportedTransitions();
@@ -197,8 +219,9 @@ class Host : public HostInherit
      *
      * @param[in]  msg       - Data associated with subscribed signal
      *
+     * @return true if the signal was acted on
      */
-    void sysStateChangeJobRemoved(sdbusplus::message_t& msg);
+    bool sysStateChangeJobRemoved(sdbusplus::message_t& msg);
 
     /** @brief Check if JobNew systemd signal is relevant to this object
      *
@@ -210,8 +233,9 @@ class Host : public HostInherit
      *
      * @param[in]  msg       - Data associated with subscribed signal
      *
+     * @return true if the signal was acted on
      */
-    void sysStateChangeJobNew(sdbusplus::message_t& msg);
+    bool sysStateChangeJobNew(sdbusplus::message_t& msg);
 
     /** @brief Decrement reboot count
      *
@@ -223,33 +247,10 @@ class Host : public HostInherit
      */
     uint32_t decrementRebootCount();
 
-    // Allow cereal class access to allow these next two function to be
-    // private
+    // Allow cereal class access to allow the legacy persisted state to be
+    // loaded by a private function
     friend class cereal::access;
 
-    /** @brief Function required by Cereal to perform serialization.
-     *
-     *  @tparam Archive - Cereal archive type (binary in our case).
-     *  @param[in] archive - reference to Cereal archive.
-     *  @param[in] version - Class version that enables handling
-     *                       a serialized data across code levels
-     */
-    template <class Archive>
-    void save(Archive& archive, const std::uint32_t version) const
-    {
-        // version is not used currently
-        (void)(version);
-        archive(sdbusplus::server::xyz::openbmc_project::control::boot::
-                    RebootAttempts::retryAttempts(),
-                convertForMessage(sdbusplus::xyz::openbmc_project::State::
-                                      server::Host::requestedHostTransition()),
-                convertForMessage(sdbusplus::xyz::openbmc_project::State::Boot::
-                                      server::Progress::bootProgress()),
-                convertForMessage(
-                    sdbusplus::xyz::openbmc_project::State::OperatingSystem::
-                        server::Status::operatingSystemState()));
-    }
-
     /** @brief Function required by Cereal to perform deserialization.
      *
      *  @tparam Archive - Cereal archive type (binary in our case).
@@ -290,19 +291,44 @@ class Host : public HostInherit
             retryAttempts(retryAttempts, true);
     }
 
-    /** @brief Serialize and persist requested host state
+    /** @brief Persisted host state record */
+    struct PersistData
+    {
+        uint32_t retryAttempts;
+        EnumString requestedHostTransition;
+        EnumString bootProgress;
+        EnumString operatingSystemState;
+    };
+
+    /** @brief Version of the PersistData layout */
+    static constexpr uint32_t persistVersion = 1;
+
+    /** @brief Schedule a write of the persisted host state */
+    void serialize();
+
+    /** @brief Get the current persisted host state record
      *
-     *  @return fs::path - pathname of persisted requested host state.
+     *  @return PersistData - the record to persist
      */
-    fs::path serialize();
+    PersistData persistData() const;
 
     /** @brief Deserialize a persisted requested host state.
+     *
+     *  Falls back to a one time migration from the legacy cereal archive
+     *  when there is no journal yet.
      *
      *  @return bool - true if the deserialization was successful, false
      *                 otherwise.
      */
     bool deserialize();
 
+    /** @brief Load the legacy cereal archive into the journal and remove it
+     *
+     *  @return bool - true if a legacy archive was migrated, false
+     *                 otherwise.
+     */
+    bool migrateLegacyState();
+
     /**
      * @brief Get target name of a HostState
      *
@@ -329,11 +355,14 @@ class Host : public HostInherit
     /** @brief Persistent sdbusplus DBus bus connection. */
     sdbusplus::bus_t& bus;
 
+    /** @brief ActiveState of the systemd targets this object watches **/
+    utils::UnitStateCache unitStates;
+
     /** @brief Used to subscribe to dbus systemd JobRemoved signal **/
-    sdbusplus::match systemdSignalJobRemoved;
+    utils::SystemdJobSignals systemdSignalJobRemoved;
 
     /** @brief Used to subscribe to dbus systemd JobNew signal **/
-    sdbusplus::match systemdSignalJobNew;
+    utils::SystemdJobSignals systemdSignalJobNew;
 
     // Settings host objects of interest
     settings::HostObjects settings;
@@ -349,6 +378,16 @@ class Host : public HostInherit
 
     /** @brief Target called when a host crash occurs **/
     std::string hostCrashTarget;
+
+    /** @brief Update and write counts of the persisted files, outlives
+     *  them **/
+    utils::StatisticsInterface persistStatistics;
+
+    /** @brief Persisted requested host state, boot progress and OS status **/
+    PersistentFile<PersistData> persistFile;
+
+    /** @brief Latency histograms of the host transitions */
+    TransitionLatency transitionLatency;
 };
 
 } // namespace phosphor::state::manager
@@ -1,11 +1,14 @@
 #include "config.h"
 
 #include "host_state_manager.hpp"
+#include "persistent_file.hpp"
+#include "statistics.hpp"
 
 #include <getopt.h>
 
 #include <phosphor-logging/lg2.hpp>
 #include <sdbusplus/bus.hpp>
+#include <sdeventplus/event.hpp>
 
 #include <cstdlib>
 #include <exception>
@@ -22,6 +25,9 @@ using HostState = sdbusplus::server::xyz::openbmc_project::state::Host;
 
 int main(int argc, char** argv)
 {
+    // Start-up timing is relative to this
+    phosphor::state::manager::utils::StartupTimer::instance();
+
     size_t hostId = 0;
 
     int arg;
@@ -44,7 +50,9 @@ int main(int argc, char** argv)
 
     namespace fs = std::filesystem;
 
+    auto event = sdeventplus::Event::get_default();
     auto bus = sdbusplus::bus::new_default();
+    bus.attach_event(event.get(), SD_EVENT_PRIORITY_NORMAL);
 
     auto hostBusName = HostState::interface + std::to_string(hostId);
     auto hostName = std::string(HostState::namespace_path::host) +
@@ -103,10 +111,11 @@ int main(int argc, char** argv)
 
     bus.request_name(hostBusName.c_str());
 
-    while (true)
-    {
-        bus.process_discard();
-        bus.wait();
-    }
-    return 0;
+    auto startupStatistics =
+        phosphor::state::manager::utils::publishStartup(bus, objPathInst.str);
+
+    // Exit the loop on a service stop so pending persisted state is written
+    auto terminate = phosphor::state::manager::exitOnTerminate(event);
+
+    return event.loop();
 }
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <sdeventplus/event.hpp>
+#include <sdeventplus/source/event.hpp>
+
+#include <cstddef>
+#include <cstdlib>
+#include <functional>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace phosphor::state::manager
+{
+
+/** @class HostedInstances
+ *  @brief Instances sharing the event loop of one process, keyed by id
+ *  @details An instance that fails after starting is dropped on its own,
+ *  from the event loop rather than from the call reporting the failure, so
+ *  the instance can report it from one of its own callbacks. The event loop
+ *  is only exited once no instance is left.
+ *
+ *  @tparam Instance - The hosted object
+ */
+template <typename Instance>
+class HostedInstances
+{
+  public:
+    /** @brief Called with the id of an instance once it is dropped */
+    using Dropped = std::function<void(size_t)>;
+
+    HostedInstances() = delete;
+    HostedInstances(const HostedInstances&) = delete;
+    HostedInstances& operator=(const HostedInstances&) = delete;
+    HostedInstances(HostedInstances&&) = delete;
+    HostedInstances& operator=(HostedInstances&&) = delete;
+    ~HostedInstances() = default;
+
+    /** @brief Constructs an empty set of instances
+     *
+     * @param[in] event   - The event loop the instances run on
+     * @param[in] dropped - Called for each dropped instance, such as to
+     *                      release its bus name
+     */
+    HostedInstances(const sdeventplus::Event& event, Dropped dropped) :
+        event(event), dropped(std::move(dropped)),
+        dropDefer(event, [this](auto&) { dropFailed(); })
+    {
+        dropDefer.set_enabled(sdeventplus::source::Enabled::Off);
+    }
+
+    /** @brief Add an instance
+     *
+     * @param[in] id       - Id of the instance
+     * @param[in] instance - The instance
+     */
+    void add(size_t id, std::unique_ptr<Instance> instance)
+    {
+        instances.insert_or_assign(id, std::move(instance));
+    }
+
+    /** @brief Report that an instance failed, it is dropped from the event
+     *  loop
+     *
+     * @param[in] id - Id of the instance
+     */
+    void failed(size_t id)
+    {
+        failures.push_back(id);
+        dropDefer.set_enabled(sdeventplus::source::Enabled::OneShot);
+    }
+
+    /** @brief Determine if an instance is hosted */
+    bool contains(size_t id) const
+    {
+        return instances.contains(id);
+    }
+
+    /** @brief Determine if no instance is hosted */
+    bool empty() const
+    {
+        return instances.empty();
+    }
+
+    /** @brief Ids of the hosted instances, in order */
+    std::vector<size_t> ids() const
+    {
+        std::vector<size_t> hosted;
+        hosted.reserve(instances.size());
+        for (const auto& [id, instance] : instances)
+        {
+            hosted.push_back(id);
+        }
+        return hosted;
+    }
+
+  private:
+    /** @brief Drop the failed instances, exit the loop if none is left */
+    void dropFailed()
+    {
+        for (auto id : std::exchange(failures, {}))
+        {
+            if (instances.erase(id) != 0)
+            {
+                dropped(id);
+            }
+        }
+
+        if (instances.empty())
+        {
+            event.exit(EXIT_FAILURE);
+        }
+    }
+
+    /** @brief The event loop the instances run on */
+    sdeventplus::Event event;
+
+    /** @brief Called for each dropped instance */
+    Dropped dropped;
+
+    /** @brief The hosted instances, keyed by id */
+    std::map<size_t, std::unique_ptr<Instance>> instances;
+
+    /** @brief Ids of the instances that failed since the last drop */
+    std::vector<size_t> failures;
+
+    /** @brief Drops the failed instances from the event loop */
+    sdeventplus::source::Defer dropDefer;
+};
+
+} // namespace phosphor::state::manager
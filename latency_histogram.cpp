@@ -0,0 +1,86 @@
+#include "latency_histogram.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <limits>
+
+namespace phosphor::state::manager
+{
+
+size_t LatencyHistogram::bucket(uint64_t latencyMs)
+{
+    return std::min<size_t>(std::bit_width(latencyMs), numBuckets - 1);
+}
+
+void LatencyHistogram::record(std::chrono::milliseconds latency)
+{
+    auto latencyMs = static_cast<uint32_t>(
+        std::clamp<int64_t>(latency.count(), 0,
+                            std::numeric_limits<uint32_t>::max()));
+
+    if ((count == 0) || (latencyMs < minMs))
+    {
+        minMs = latencyMs;
+    }
+    maxMs = std::max(maxMs, latencyMs);
+    ++count;
+    ++buckets[bucket(latencyMs)];
+}
+
+uint32_t LatencyHistogram::percentile(unsigned percent) const
+{
+    if (count == 0)
+    {
+        return 0;
+    }
+
+    // Rank of the latency in the sorted recorded latencies, from 1
+    auto rank = std::max<uint64_t>(
+        1, ((static_cast<uint64_t>(count) * percent) + 99) / 100);
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < numBuckets - 1; ++i)
+    {
+        seen += buckets[i];
+        if (seen >= rank)
+        {
+            uint64_t upperBound = (uint64_t{1} << i) - 1;
+            return static_cast<uint32_t>(
+                std::clamp<uint64_t>(upperBound, minMs, maxMs));
+        }
+    }
+
+    // The last bucket has no upper bound
+    return maxMs;
+}
+
+void LatencyHistogram::addValues(std::map<std::string, uint64_t>& values,
+                                 const std::string& prefix) const
+{
+    values.insert_or_assign(prefix + ".count", count);
+    values.insert_or_assign(prefix + ".min_ms", minMs);
+    values.insert_or_assign(prefix + ".max_ms", maxMs);
+    values.insert_or_assign(prefix + ".p50_ms", percentile(50));
+    values.insert_or_assign(prefix + ".p90_ms", percentile(90));
+    values.insert_or_assign(prefix + ".p99_ms", percentile(99));
+
+    for (size_t i = 0; i < numBuckets - 1; ++i)
+    {
+        if (buckets[i] != 0)
+        {
+            values.insert_or_assign(
+                prefix + ".lt_" + std::to_string(uint64_t{1} << i) + "_ms",
+                buckets[i]);
+        }
+    }
+    if (buckets[numBuckets - 1] != 0)
+    {
+        values.insert_or_assign(prefix + ".ge_" +
+                                    std::to_string(uint64_t{1}
+                                                   << (numBuckets - 2)) +
+                                    "_ms",
+                                buckets[numBuckets - 1]);
+    }
+}
+
+} // namespace phosphor::state::manager
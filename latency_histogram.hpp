@@ -0,0 +1,67 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+
+namespace phosphor::state::manager
+{
+
+/** @struct LatencyHistogram
+ *  @brief Latency distribution in power of two millisecond buckets
+ *  @details Bucket 0 holds latencies below 1 ms and bucket i holds
+ *  latencies from 2^(i-1) ms to 2^i - 1 ms, except the last bucket which
+ *  holds everything above. Percentiles are estimated as the upper bound of
+ *  their bucket, clamped to the minimum and maximum seen. Trivially
+ *  copyable so it can be persisted as is.
+ */
+struct LatencyHistogram
+{
+    /** @brief Number of buckets, the last one starts at 2^22 ms (~70 min) */
+    static constexpr size_t numBuckets = 24;
+
+    /** @brief Number of latencies recorded */
+    uint32_t count = 0;
+
+    /** @brief Lowest latency recorded, in ms */
+    uint32_t minMs = 0;
+
+    /** @brief Highest latency recorded, in ms */
+    uint32_t maxMs = 0;
+
+    /** @brief Number of latencies recorded in each bucket */
+    std::array<uint32_t, numBuckets> buckets{};
+
+    /** @brief Record a latency
+     *
+     * @param[in] latency    - The latency
+     */
+    void record(std::chrono::milliseconds latency);
+
+    /** @brief Estimate a percentile
+     *
+     * @param[in] percent    - The percentile, 1 to 100
+     *
+     * @return The estimated latency in ms, 0 when nothing was recorded
+     */
+    uint32_t percentile(unsigned percent) const;
+
+    /** @brief Add the statistics of the histogram to a set of values
+     *
+     * Adds <prefix>.count, .min_ms, .max_ms, .p50_ms, .p90_ms and .p99_ms,
+     * plus .lt_<N>_ms for each non-empty bucket below N ms.
+     *
+     * @param[out] values    - Values to add to
+     * @param[in] prefix     - Prefix of the value names
+     */
+    void addValues(std::map<std::string, uint64_t>& values,
+                   const std::string& prefix) const;
+
+    /** @brief Bucket that holds a latency */
+    static size_t bucket(uint64_t latencyMs);
+};
+
+} // namespace phosphor::state::manager
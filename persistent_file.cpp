@@ -0,0 +1,27 @@
+#include "persistent_file.hpp"
+
+#include <signal.h>
+
+#include <phosphor-logging/lg2.hpp>
+
+namespace phosphor::state::manager
+{
+
+PHOSPHOR_LOG2_USING;
+
+sdeventplus::source::Signal exitOnTerminate(const sdeventplus::Event& event)
+{
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGTERM);
+    sigprocmask(SIG_BLOCK, &mask, nullptr);
+
+    return sdeventplus::source::Signal(
+        event, SIGTERM,
+        [](sdeventplus::source::Signal& source, const struct signalfd_siginfo*) {
+            info("Received SIGTERM, flushing persisted state and exiting");
+            source.get_event().exit(0);
+        });
+}
+
+} // namespace phosphor::state::manager
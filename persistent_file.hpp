@@ -0,0 +1,233 @@
+#pragma once
+
+#include "state_journal.hpp"
+#include "statistics.hpp"
+
+#include <phosphor-logging/lg2.hpp>
+#include <sdeventplus/clock.hpp>
+#include <sdeventplus/event.hpp>
+#include <sdeventplus/source/signal.hpp>
+#include <sdeventplus/utility/timer.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <span>
+#include <type_traits>
+
+namespace phosphor::state::manager
+{
+
+namespace fs = std::filesystem;
+
+/** @brief Suffix added to a legacy persisted file path for its journal */
+constexpr auto JOURNAL_FILE_SUFFIX = ".journal";
+
+/** @class PersistentFile
+ *  @brief Crash safe, write coalescing persisted state
+ *  @details Updates requested within the write window are merged into a
+ *  single append of the current state to a StateJournal, done when the
+ *  window expires. Any pending write is done when the object is destroyed.
+ *
+ *  @tparam Payload - Trivially copyable record holding the persisted state
+ */
+template <typename Payload>
+class PersistentFile
+{
+    static_assert(std::is_trivially_copyable_v<Payload>,
+                  "Persisted state must be trivially copyable");
+
+  public:
+    /** @brief Returns the current state to persist */
+    using Serializer = std::function<Payload()>;
+
+    PersistentFile() = delete;
+    PersistentFile(const PersistentFile&) = delete;
+    PersistentFile& operator=(const PersistentFile&) = delete;
+    PersistentFile(PersistentFile&&) = delete;
+    PersistentFile& operator=(PersistentFile&&) = delete;
+
+    /** @brief Constructs the persisted state
+     *
+     * @param[in] event      - The event loop running the write timer
+     * @param[in] path       - Path of the journal file
+     * @param[in] version    - Version of the Payload layout
+     * @param[in] serializer - Returns the current state
+     * @param[in] window     - Time to coalesce updates for, 0 writes
+     *                         every update immediately
+     */
+    PersistentFile(const sdeventplus::Event& event, fs::path path,
+                   uint32_t version, Serializer serializer,
+                   std::chrono::milliseconds window) :
+        journal(std::move(path), version, sizeof(Payload)),
+        serializer(std::move(serializer)), window(window),
+        timer(event, [this](auto&) { flush(); })
+    {}
+
+    ~PersistentFile()
+    {
+        flush();
+    }
+
+    /** @brief Read the last persisted state
+     *
+     * @param[out] payload - Receives the state
+     *
+     * @return true if a persisted state was found
+     */
+    bool restore(Payload& payload)
+    {
+        return journal.restore(std::as_writable_bytes(std::span(&payload, 1)));
+    }
+
+    /** @brief Request the current state to be persisted */
+    void update()
+    {
+        ++requestCount;
+
+        if (window.count() == 0)
+        {
+            write();
+            return;
+        }
+        publishCounts();
+
+        // The window starts at the first update so a steady stream of
+        // updates can't hold the write off forever
+        if (!pending)
+        {
+            pending = true;
+            timer.restartOnce(window);
+        }
+    }
+
+    /** @brief Persist the state now if an update is pending */
+    void flush()
+    {
+        if (!pending)
+        {
+            return;
+        }
+
+        pending = false;
+        timer.setEnabled(false);
+        write();
+    }
+
+    /** @brief Persist the given state now, dropping any pending update
+     *
+     * Used when the state to persist isn't the current state yet, such as
+     * when migrating from another format.
+     *
+     * @param[in] payload - The state to persist
+     */
+    void store(const Payload& payload)
+    {
+        pending = false;
+        timer.setEnabled(false);
+        append(payload);
+    }
+
+    /** @brief Path of the journal file */
+    const fs::path& path() const
+    {
+        return journal.path();
+    }
+
+    /** @brief Number of updates requested */
+    uint64_t requests() const
+    {
+        return requestCount;
+    }
+
+    /** @brief Number of times the state was written */
+    uint64_t writes() const
+    {
+        return writeCount;
+    }
+
+    /** @brief Publish the request and write counts, kept up to date
+     *
+     * Adds <file name>.requests and <file name>.writes to the statistics,
+     * so the writes saved by coalescing can be measured.
+     *
+     * @param[in] statistics - Interface to publish on, must outlive this
+     */
+    void publishTo(utils::StatisticsInterface& statistics)
+    {
+        published = &statistics;
+        publishCounts();
+    }
+
+  private:
+    /** @brief Set the counts on the published statistics, if any */
+    void publishCounts()
+    {
+        if (published == nullptr)
+        {
+            return;
+        }
+
+        auto name = journal.path().filename().string();
+        published->set(name + ".requests", requestCount);
+        published->set(name + ".writes", writeCount);
+    }
+
+    /** @brief Append the current state to the journal */
+    void write()
+    {
+        append(serializer());
+    }
+
+    /** @brief Append a state to the journal */
+    void append(const Payload& payload)
+    {
+        if (journal.append(std::as_bytes(std::span(&payload, 1))))
+        {
+            ++writeCount;
+            lg2::debug("Persisted {PATH}, {WRITES} writes for {REQUESTS} "
+                       "updates",
+                       "PATH", journal.path(), "WRITES", writeCount,
+                       "REQUESTS", requestCount);
+            publishCounts();
+        }
+    }
+
+    /** @brief Journal holding the persisted state */
+    StateJournal journal;
+
+    /** @brief Returns the current state */
+    Serializer serializer;
+
+    /** @brief Time to coalesce updates for */
+    const std::chrono::milliseconds window;
+
+    /** @brief Expires at the end of the write window */
+    sdeventplus::utility::Timer<sdeventplus::ClockId::Monotonic> timer;
+
+    /** @brief An update was requested but not yet written */
+    bool pending = false;
+
+    /** @brief Number of updates requested */
+    uint64_t requestCount = 0;
+
+    /** @brief Number of times the state was written */
+    uint64_t writeCount = 0;
+
+    /** @brief Statistics the counts are published on, if any */
+    utils::StatisticsInterface* published = nullptr;
+};
+
+/** @brief Exit the event loop on SIGTERM
+ *
+ * Lets the objects owned by main() be destroyed on a service stop, so
+ * pending persisted state writes are flushed.
+ *
+ * @param[in] event      - The event loop to exit
+ *
+ * @return The signal source, which must be kept alive
+ */
+sdeventplus::source::Signal exitOnTerminate(const sdeventplus::Event& event);
+
+} // namespace phosphor::state::manager
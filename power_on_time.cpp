@@ -0,0 +1,163 @@
+#include "power_on_time.hpp"
+
+#include <cereal/archives/json.hpp>
+#include <phosphor-logging/lg2.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <system_error>
+
+namespace phosphor::state::manager
+{
+
+PHOSPHOR_LOG2_USING;
+
+PowerOnTime::PowerOnTime(const sdeventplus::Event& event, const fs::path& path,
+                         std::chrono::milliseconds interval,
+                         std::chrono::milliseconds window,
+                         HoursChanged hoursChanged, Now now) :
+    hoursChanged(std::move(hoursChanged)), now(std::move(now)),
+    file(event, path, persistVersion,
+         [this]() { return POHData{totalSeconds()}; }, window),
+    timer(
+        event,
+        [this](auto&) {
+            if (restored && poweredOnSince)
+            {
+                this->checkpoint();
+            }
+        },
+        interval,
+        std::min<std::chrono::milliseconds>(interval, std::chrono::seconds{1}))
+{}
+
+PowerOnTime::~PowerOnTime()
+{
+    // Account for the time powered on up to the shutdown, there is nothing
+    // to account to if the persisted time wasn't restored
+    if (restored)
+    {
+        file.store(POHData{totalSeconds()});
+    }
+}
+
+void PowerOnTime::restore(const fs::path& legacyPath, bool poweredOn)
+{
+    POHData data{};
+    if (file.restore(data))
+    {
+        seconds = data.onSeconds;
+    }
+    else if (auto legacyHours = readLegacyHours(legacyPath))
+    {
+        // The hour counter dropped the partial hours, they can't be
+        // recovered
+        seconds = uint64_t{*legacyHours} * 3600;
+        info("Migrating POH counter of {HOURS} hours to {PATH}", "HOURS",
+             *legacyHours, "PATH", file.path());
+        file.store(POHData{seconds});
+
+        std::error_code ec;
+        fs::remove(legacyPath, ec);
+    }
+    else
+    {
+        seconds = 0;
+    }
+
+    restored = true;
+    if (poweredOn && !poweredOnSince)
+    {
+        poweredOnSince = now();
+    }
+
+    reportedHours = hours();
+    hoursChanged(*reportedHours);
+}
+
+void PowerOnTime::powerChanged(bool poweredOn)
+{
+    if (poweredOn && !poweredOnSince)
+    {
+        poweredOnSince = now();
+    }
+    else if (!poweredOn && poweredOnSince)
+    {
+        seconds = totalSeconds();
+        poweredOnSince.reset();
+        if (restored)
+        {
+            checkpoint();
+        }
+    }
+}
+
+void PowerOnTime::reset(uint32_t newHours)
+{
+    seconds = uint64_t{newHours} * 3600;
+    if (poweredOnSince)
+    {
+        poweredOnSince = now();
+    }
+    checkpoint();
+}
+
+uint64_t PowerOnTime::totalSeconds() const
+{
+    if (!poweredOnSince)
+    {
+        return seconds;
+    }
+
+    auto onTime = std::chrono::duration_cast<std::chrono::seconds>(
+        now() - *poweredOnSince);
+    return seconds + onTime.count();
+}
+
+uint32_t PowerOnTime::hours() const
+{
+    return totalSeconds() / 3600;
+}
+
+void PowerOnTime::checkpoint()
+{
+    auto current = hours();
+    if (current != reportedHours)
+    {
+        reportedHours = current;
+        hoursChanged(current);
+    }
+    file.update();
+}
+
+std::optional<uint32_t> PowerOnTime::readLegacyHours(const fs::path& legacyPath)
+{
+    try
+    {
+        if (!fs::exists(legacyPath))
+        {
+            return std::nullopt;
+        }
+
+        uint32_t legacyHours = 0;
+        std::ifstream is(legacyPath.c_str(), std::ios::in | std::ios::binary);
+        cereal::JSONInputArchive iarchive(is);
+        iarchive(legacyHours);
+        return legacyHours;
+    }
+    catch (const cereal::Exception& e)
+    {
+        error("Failed to read the POH counter {PATH}: {ERROR}", "PATH",
+              legacyPath, "ERROR", e);
+        std::error_code ec;
+        fs::remove(legacyPath, ec);
+    }
+    catch (const fs::filesystem_error& e)
+    {
+        error("Failed to read the POH counter {PATH}: {ERROR}", "PATH",
+              legacyPath, "ERROR", e);
+    }
+    return std::nullopt;
+}
+
+} // namespace phosphor::state::manager
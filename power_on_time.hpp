@@ -0,0 +1,143 @@
+#pragma once
+
+#include "persistent_file.hpp"
+#include "statistics.hpp"
+
+#include <sdeventplus/clock.hpp>
+#include <sdeventplus/event.hpp>
+#include <sdeventplus/utility/timer.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <optional>
+
+namespace phosphor::state::manager
+{
+
+/** @class PowerOnTime
+ *  @brief Accumulated power on time of a chassis
+ *  @details Power on periods are timed on the monotonic clock so wall clock
+ *  changes don't skew them. The total is persisted in seconds, checkpointed
+ *  periodically while powered on and at every power off, and stored when
+ *  the object is destroyed. Nothing is persisted before restore().
+ */
+class PowerOnTime
+{
+  public:
+    /** @brief Called with the total whole hours when they change */
+    using HoursChanged = std::function<void(uint32_t)>;
+
+    /** @brief Returns the current monotonic time */
+    using Now = std::function<std::chrono::steady_clock::time_point()>;
+
+    PowerOnTime() = delete;
+    PowerOnTime(const PowerOnTime&) = delete;
+    PowerOnTime& operator=(const PowerOnTime&) = delete;
+    PowerOnTime(PowerOnTime&&) = delete;
+    PowerOnTime& operator=(PowerOnTime&&) = delete;
+
+    /** @brief Constructs the power on time, powered off and not restored
+     *
+     * @param[in] event        - The event loop running the timers
+     * @param[in] path         - Path of the persisted power on time
+     * @param[in] interval     - Interval of the checkpoints while powered on
+     * @param[in] window       - Time to coalesce persisted writes for
+     * @param[in] hoursChanged - Called when the whole hours change
+     * @param[in] now          - Source of the monotonic time
+     */
+    PowerOnTime(const sdeventplus::Event& event, const fs::path& path,
+                std::chrono::milliseconds interval,
+                std::chrono::milliseconds window, HoursChanged hoursChanged,
+                Now now = std::chrono::steady_clock::now);
+
+    ~PowerOnTime();
+
+    /** @brief Restore the persisted power on time
+     *
+     * Falls back to a one time migration from the legacy cereal hour
+     * counter when nothing was persisted yet.
+     *
+     * @param[in] legacyPath - Path of the legacy hour counter
+     * @param[in] poweredOn  - Whether the chassis is powered on
+     */
+    void restore(const fs::path& legacyPath, bool poweredOn);
+
+    /** @brief Start or end a power on period
+     *
+     * @param[in] poweredOn  - Whether the chassis is powered on
+     */
+    void powerChanged(bool poweredOn);
+
+    /** @brief Reset the power on time
+     *
+     * @param[in] hours      - The new power on time in hours
+     */
+    void reset(uint32_t hours);
+
+    /** @brief Total power on time, including the current power on period
+     *
+     *  @return Power on time in seconds
+     */
+    uint64_t totalSeconds() const;
+
+    /** @brief Total power on time in whole hours */
+    uint32_t hours() const;
+
+    /** @brief Publish the update and write counts of the persisted time
+     *
+     * @param[in] statistics - Interface to publish on, must outlive this
+     */
+    void publishWritesTo(utils::StatisticsInterface& statistics)
+    {
+        file.publishTo(statistics);
+    }
+
+  private:
+    /** @brief Persisted power on time record */
+    struct POHData
+    {
+        uint64_t onSeconds;
+    };
+
+    /** @brief Version of the persisted power on time layout */
+    static constexpr uint32_t persistVersion = 1;
+
+    /** @brief Report the hours if they changed and schedule a write */
+    void checkpoint();
+
+    /** @brief Read the legacy persisted hour counter
+     *
+     *  @param[in] legacyPath - Path of the legacy hour counter
+     *
+     *  @return The hours, std::nullopt if there is no valid counter
+     */
+    static std::optional<uint32_t> readLegacyHours(const fs::path& legacyPath);
+
+    /** @brief Called when the whole hours change */
+    HoursChanged hoursChanged;
+
+    /** @brief Source of the monotonic time */
+    Now now;
+
+    /** @brief Power on time of the completed power on periods, in seconds */
+    uint64_t seconds = 0;
+
+    /** @brief Start of the current power on period, if powered on */
+    std::optional<std::chrono::steady_clock::time_point> poweredOnSince;
+
+    /** @brief Hours last reported to hoursChanged */
+    std::optional<uint32_t> reportedHours;
+
+    /** @brief The persisted power on time was restored */
+    bool restored = false;
+
+    /** @brief Persisted power on time */
+    PersistentFile<POHData> file;
+
+    /** @brief Timer used to checkpoint the power on time */
+    sdeventplus::utility::Timer<sdeventplus::ClockId::Monotonic> timer;
+};
+
+} // namespace phosphor::state::manager
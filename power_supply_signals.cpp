@@ -0,0 +1,134 @@
+#include "power_supply_signals.hpp"
+
+#include <xyz/openbmc_project/State/Decorator/PowerSystemInputs/server.hpp>
+
+#include <charconv>
+#include <format>
+#include <string_view>
+
+namespace phosphor::state::manager
+{
+
+namespace decoratorServer =
+    sdbusplus::server::xyz::openbmc_project::state::decorator;
+
+PowerSupplySignals::PowerSupplySignals(sdbusplus::bus_t& bus) :
+    changedSignal(bus,
+                  sdbusplus::match_rules::propertiesChangedNamespace(
+                      PSU_ROOT_PATH,
+                      decoratorServer::PowerSystemInputs::interface),
+                  [this](auto& msg) { propertiesChanged(msg); }),
+    addedSignal(bus,
+                sdbusplus::match_rules::interfacesAdded() +
+                    sdbusplus::match_rules::argNpath(
+                        0, std::string(PSU_ROOT_PATH) + "/"),
+                [this](auto& msg) { interfacesAdded(msg); }),
+    removedSignal(bus,
+                  sdbusplus::match_rules::interfacesRemoved() +
+                      sdbusplus::match_rules::argNpath(
+                          0, std::string(PSU_ROOT_PATH) + "/"),
+                  [this](auto& msg) { interfacesRemoved(msg); })
+{}
+
+std::shared_ptr<PowerSupplySignals>
+    PowerSupplySignals::shared(sdbusplus::bus_t& bus)
+{
+    static std::weak_ptr<PowerSupplySignals> instance;
+
+    auto signals = instance.lock();
+    if (!signals)
+    {
+        signals = std::make_shared<PowerSupplySignals>(bus);
+        instance = signals;
+    }
+    return signals;
+}
+
+void PowerSupplySignals::subscribe(size_t id, Handlers chassisHandlers)
+{
+    handlers.insert_or_assign(id, std::move(chassisHandlers));
+}
+
+void PowerSupplySignals::unsubscribe(size_t id)
+{
+    handlers.erase(id);
+}
+
+std::optional<size_t> PowerSupplySignals::chassisOf(const std::string& path)
+{
+    // <root>/chassis<id>/psus/...
+    constexpr std::string_view prefix = "/chassis";
+    std::string_view rest{path};
+    if (!rest.starts_with(PSU_ROOT_PATH))
+    {
+        return std::nullopt;
+    }
+    rest.remove_prefix(std::string_view{PSU_ROOT_PATH}.size());
+    if (!rest.starts_with(prefix))
+    {
+        return std::nullopt;
+    }
+    rest.remove_prefix(prefix.size());
+
+    size_t id = 0;
+    auto [end, ec] = std::from_chars(rest.data(), rest.data() + rest.size(),
+                                     id);
+    if ((ec != std::errc()) || (end == rest.data()))
+    {
+        return std::nullopt;
+    }
+
+    // The object must be in the chassis' power supply subtree
+    auto root = std::format(CHASSIS_PSU_ROOT_PATH_FMT, id);
+    if (!path.starts_with(root) ||
+        ((path.size() > root.size()) && (path[root.size()] != '/')))
+    {
+        return std::nullopt;
+    }
+    return id;
+}
+
+PowerSupplySignals::Handlers* PowerSupplySignals::find(const std::string& path)
+{
+    auto id = chassisOf(path);
+    if (!id)
+    {
+        return nullptr;
+    }
+
+    auto chassisHandlers = handlers.find(*id);
+    return (chassisHandlers == handlers.end()) ? nullptr
+                                               : &chassisHandlers->second;
+}
+
+void PowerSupplySignals::propertiesChanged(sdbusplus::message_t& msg)
+{
+    if (auto* chassisHandlers = find(msg.get_path()))
+    {
+        chassisHandlers->changed(msg);
+    }
+}
+
+void PowerSupplySignals::interfacesAdded(sdbusplus::message_t& msg)
+{
+    sdbusplus::object_path path;
+    msg.read(path);
+
+    if (auto* chassisHandlers = find(path.str))
+    {
+        chassisHandlers->added(path.str, msg);
+    }
+}
+
+void PowerSupplySignals::interfacesRemoved(sdbusplus::message_t& msg)
+{
+    sdbusplus::object_path path;
+    msg.read(path);
+
+    if (auto* chassisHandlers = find(path.str))
+    {
+        chassisHandlers->removed(path.str, msg);
+    }
+}
+
+} // namespace phosphor::state::manager
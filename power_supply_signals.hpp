@@ -0,0 +1,114 @@
+#pragma once
+
+#include <sdbusplus/bus.hpp>
+#include <sdbusplus/bus/match.hpp>
+
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+
+namespace phosphor::state::manager
+{
+
+/** @brief Root of the power supply objects of every chassis */
+constexpr auto PSU_ROOT_PATH = "/xyz/openbmc_project/power/power_supplies";
+
+/** @brief Root of the power supply objects of a chassis */
+constexpr auto CHASSIS_PSU_ROOT_PATH_FMT =
+    "/xyz/openbmc_project/power/power_supplies/chassis{}/psus";
+
+/** @class PowerSupplySignals
+ *  @brief Power supply signal matches shared by the chassis of a process
+ *  @details The power supplies of each chassis live in their own subtree
+ *  below PSU_ROOT_PATH. Instead of one set of matches per chassis, one set
+ *  on the common root serves every chassis of the process, and each signal
+ *  is dispatched to the chassis whose subtree the object is in.
+ */
+class PowerSupplySignals
+{
+  public:
+    /** @brief Handlers of the signals of one chassis' power supplies */
+    struct Handlers
+    {
+        /** @brief PropertiesChanged of a power supply */
+        std::function<void(sdbusplus::message_t&)> changed;
+
+        /** @brief InterfacesAdded, called after the object path is read */
+        std::function<void(const std::string&, sdbusplus::message_t&)> added;
+
+        /** @brief InterfacesRemoved, called after the object path is read */
+        std::function<void(const std::string&, sdbusplus::message_t&)>
+            removed;
+    };
+
+    PowerSupplySignals() = delete;
+    PowerSupplySignals(const PowerSupplySignals&) = delete;
+    PowerSupplySignals& operator=(const PowerSupplySignals&) = delete;
+    PowerSupplySignals(PowerSupplySignals&&) = delete;
+    PowerSupplySignals& operator=(PowerSupplySignals&&) = delete;
+    ~PowerSupplySignals() = default;
+
+    /** @brief Constructs the matches
+     *
+     * @param[in] bus       - The Dbus bus object
+     */
+    explicit PowerSupplySignals(sdbusplus::bus_t& bus);
+
+    /** @brief Get the matches shared by this process, created on first use
+     *
+     * @param[in] bus       - The Dbus bus object
+     */
+    static std::shared_ptr<PowerSupplySignals> shared(sdbusplus::bus_t& bus);
+
+    /** @brief Deliver the signals of a chassis' power supplies
+     *
+     * @param[in] id        - The chassis id
+     * @param[in] handlers  - The signal handlers
+     */
+    void subscribe(size_t id, Handlers handlers);
+
+    /** @brief Stop delivering the signals of a chassis' power supplies
+     *
+     * @param[in] id        - The chassis id
+     */
+    void unsubscribe(size_t id);
+
+    /** @brief Get the chassis whose power supply subtree holds a path
+     *
+     * @param[in] path      - Object path below PSU_ROOT_PATH
+     *
+     * @return The chassis id, std::nullopt if the path is in no chassis'
+     *         subtree
+     */
+    static std::optional<size_t> chassisOf(const std::string& path);
+
+  private:
+    /** @brief Find the handlers of the chassis holding a path */
+    Handlers* find(const std::string& path);
+
+    /** @brief Process PowerSystemInputs property changes */
+    void propertiesChanged(sdbusplus::message_t& msg);
+
+    /** @brief Process InterfacesAdded below the root */
+    void interfacesAdded(sdbusplus::message_t& msg);
+
+    /** @brief Process InterfacesRemoved below the root */
+    void interfacesRemoved(sdbusplus::message_t& msg);
+
+    /** @brief Handlers keyed by chassis id. **/
+    std::map<size_t, Handlers> handlers;
+
+    /** @brief Watch for PowerSystemInputs property changes **/
+    sdbusplus::match changedSignal;
+
+    /** @brief Watch for power supplies being added **/
+    sdbusplus::match addedSignal;
+
+    /** @brief Watch for power supplies being removed **/
+    sdbusplus::match removedSignal;
+};
+
+} // namespace phosphor::state::manager
@@ -253,26 +253,56 @@ int ScheduledHostTransition::onTimeChange(
 
 void ScheduledHostTransition::serializeScheduledValues()
 {
-    fs::path path{SCHEDULED_HOST_TRANSITION_PERSIST_PATH};
-    std::ofstream os(path.c_str(), std::ios::binary);
-    cereal::JSONOutputArchive oarchive(os);
+    persistFile.update();
+}
 
-    oarchive(HostTransition::scheduledTime(),
-             HostTransition::scheduledTransition());
+ScheduledHostTransition::PersistData
+    ScheduledHostTransition::persistData() const
+{
+    return PersistData{
+        HostTransition::scheduledTime(),
+        EnumString(convertForMessage(HostTransition::scheduledTransition()))};
 }
 
 bool ScheduledHostTransition::deserializeScheduledValues(uint64_t& time,
                                                          Transition& trans)
 {
+    PersistData data{};
+    if (persistFile.restore(data))
+    {
+        try
+        {
+            time = data.time;
+            trans = HostState::convertTransitionFromString(
+                data.transition.str());
+            return true;
+        }
+        catch (const std::exception& e)
+        {
+            error("Invalid persisted scheduled transition: {ERROR}", "ERROR",
+                  e);
+            return false;
+        }
+    }
+
     fs::path path{SCHEDULED_HOST_TRANSITION_PERSIST_PATH};
 
     try
     {
         if (fs::exists(path))
         {
-            std::ifstream is(path.c_str(), std::ios::in | std::ios::binary);
-            cereal::JSONInputArchive iarchive(is);
-            iarchive(time, trans);
+            {
+                std::ifstream is(path.c_str(),
+                                 std::ios::in | std::ios::binary);
+                cereal::JSONInputArchive iarchive(is);
+                iarchive(time, trans);
+            }
+
+            info("Migrating scheduled values from {LEGACY} to {PATH}",
+                 "LEGACY", path, "PATH", persistFile.path());
+            persistFile.store(
+                PersistData{time, EnumString(convertForMessage(trans))});
+            fs::remove(path);
             return true;
         }
     }
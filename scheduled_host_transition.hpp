@@ -2,12 +2,17 @@
 
 #include "config.h"
 
+#include "persistent_file.hpp"
+
 #include <sdbusplus/bus.hpp>
 #include <sdeventplus/event.hpp>
 #include <sdeventplus/utility/timer.hpp>
 #include <xyz/openbmc_project/State/Host/server.hpp>
 #include <xyz/openbmc_project/State/ScheduledHostTransition/server.hpp>
 
+#include <chrono>
+#include <string>
+
 namespace phosphor::state::manager
 {
 
@@ -31,10 +36,18 @@ class ScheduledHostTransition : public ScheduledHostTransitionInherit
         ScheduledHostTransitionInherit(
             bus, objPath, ScheduledHostTransition::action::defer_emit),
         bus(bus), id(id), event(event),
-        timer(event, [this](auto&) { callback(); })
+        timer(event, [this](auto&) { callback(); }),
+        persistStatistics(bus, objPath, utils::PERSIST_STATISTICS_INTERFACE),
+        persistFile(
+            event,
+            std::string(SCHEDULED_HOST_TRANSITION_PERSIST_PATH) +
+                JOURNAL_FILE_SUFFIX,
+            persistVersion, [this]() { return persistData(); },
+            std::chrono::milliseconds(PERSIST_WRITE_WINDOW_MS))
     {
         initialize();
 
+        persistFile.publishTo(persistStatistics);
         restoreScheduledValues();
 
         // We deferred this until we could get our property correct
@@ -68,6 +81,22 @@ class ScheduledHostTransition : public ScheduledHostTransitionInherit
     /** @brief Timer used for host transition with seconds */
     sdeventplus::utility::Timer<sdeventplus::ClockId::RealTime> timer;
 
+    /** @brief Persisted scheduled values record */
+    struct PersistData
+    {
+        uint64_t time;
+        EnumString transition;
+    };
+
+    /** @brief Version of the PersistData layout */
+    static constexpr uint32_t persistVersion = 1;
+
+    /** @brief Update and write counts of the persisted file, outlives it */
+    utils::StatisticsInterface persistStatistics;
+
+    /** @brief Persisted scheduled time and requested transition */
+    PersistentFile<PersistData> persistFile;
+
     /** @brief The fd for time change event */
     int timeFd = -1;
 
@@ -118,17 +147,26 @@ class ScheduledHostTransition : public ScheduledHostTransitionInherit
     /** @brief Handle with the process when bmc time is changed*/
     void handleTimeUpdates();
 
-    /** @brief Serialize the scheduled values */
+    /** @brief Schedule a write of the scheduled values */
     void serializeScheduledValues();
 
+    /** @brief Get the current persisted scheduled values record
+     *
+     *  @return PersistData - the record to persist
+     */
+    PersistData persistData() const;
+
     /** @brief Deserialize the scheduled values
+     *
+     *  Falls back to a one time migration from the legacy cereal archive
+     *  when there is no journal yet.
      *
      *  @param[out] time - Deserialized scheduled time
      *  @param[out] trans - Deserialized requested transition
      *
      *  @return bool - true if successful, false otherwise
      */
-    static bool deserializeScheduledValues(uint64_t& time, Transition& trans);
+    bool deserializeScheduledValues(uint64_t& time, Transition& trans);
 
     /** @brief Restore scheduled time and requested transition from persisted
      * file */
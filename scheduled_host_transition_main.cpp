@@ -1,5 +1,6 @@
 #include "config.h"
 
+#include "persistent_file.hpp"
 #include "scheduled_host_transition.hpp"
 
 #include <getopt.h>
@@ -72,6 +73,9 @@ int main(int argc, char** argv)
 
     // Attach the bus to sd_event to service user requests
     bus.attach_event(event.get(), SD_EVENT_PRIORITY_NORMAL);
+
+    // Exit the loop on a service stop so pending persisted values are written
+    auto terminate = phosphor::state::manager::exitOnTerminate(event);
     event.loop();
 
     return 0;
@@ -0,0 +1,281 @@
+#include "state_journal.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <phosphor-logging/lg2.hpp>
+
+#include <cerrno>
+#include <vector>
+
+namespace phosphor::state::manager
+{
+
+PHOSPHOR_LOG2_USING;
+
+namespace
+{
+
+constexpr std::array<char, 8> journalMagic = {'P', 'S', 'M', 'J',
+                                              'R', 'N', 'L', '\0'};
+constexpr uint32_t journalFormatVersion = 1;
+
+/** @brief Journal file header */
+struct Header
+{
+    std::array<char, 8> magic;
+    uint32_t formatVersion;
+    uint32_t payloadVersion;
+    uint32_t payloadSize;
+    uint32_t capacity;
+    uint32_t reserved;
+    uint32_t crc;
+};
+static_assert(sizeof(Header) == 32);
+
+/** @brief Record layout is sequence, payload, CRC32 padded to 8 bytes */
+constexpr size_t sequenceSize = sizeof(uint64_t);
+constexpr size_t crcSize = sizeof(uint32_t);
+
+constexpr size_t recordSizeFor(size_t payloadSize)
+{
+    return (sequenceSize + payloadSize + crcSize + 7) & ~size_t{7};
+}
+
+constexpr auto crcTable = [] {
+    std::array<uint32_t, 256> table{};
+    for (uint32_t i = 0; i < table.size(); i++)
+    {
+        uint32_t c = i;
+        for (int k = 0; k < 8; k++)
+        {
+            c = (c & 1) ? (0xEDB88320 ^ (c >> 1)) : (c >> 1);
+        }
+        table[i] = c;
+    }
+    return table;
+}();
+
+/** @brief CRC32 (IEEE 802.3) of a byte range */
+uint32_t crc32(std::span<const std::byte> data)
+{
+    uint32_t crc = 0xFFFFFFFF;
+    for (auto b : data)
+    {
+        crc = crcTable[(crc ^ std::to_integer<uint32_t>(b)) & 0xFF] ^
+              (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFF;
+}
+
+Header makeHeader(uint32_t payloadVersion, size_t payloadSize,
+                  size_t capacity)
+{
+    Header header{};
+    header.magic = journalMagic;
+    header.formatVersion = journalFormatVersion;
+    header.payloadVersion = payloadVersion;
+    header.payloadSize = payloadSize;
+    header.capacity = capacity;
+    header.crc = crc32(std::as_bytes(std::span(&header, 1))
+                           .first(offsetof(Header, crc)));
+    return header;
+}
+
+/** @brief Read only mapping of a whole file */
+class Mapping
+{
+  public:
+    explicit Mapping(const fs::path& path)
+    {
+        int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+        {
+            return;
+        }
+
+        struct stat st{};
+        if ((fstat(fd, &st) == 0) && (st.st_size > 0))
+        {
+            void* addr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd,
+                              0);
+            if (addr != MAP_FAILED)
+            {
+                data = std::span(static_cast<const std::byte*>(addr),
+                                 static_cast<size_t>(st.st_size));
+            }
+        }
+        close(fd);
+    }
+
+    Mapping(const Mapping&) = delete;
+    Mapping& operator=(const Mapping&) = delete;
+
+    ~Mapping()
+    {
+        if (!data.empty())
+        {
+            munmap(const_cast<std::byte*>(data.data()), data.size());
+        }
+    }
+
+    std::span<const std::byte> data;
+};
+
+} // namespace
+
+StateJournal::StateJournal(fs::path path, uint32_t payloadVersion,
+                           size_t payloadSize, size_t capacity) :
+    filePath(std::move(path)), payloadVersion(payloadVersion),
+    payloadSize(payloadSize), capacity(std::max<size_t>(capacity, 2)),
+    recordSize(recordSizeFor(payloadSize))
+{}
+
+StateJournal::~StateJournal()
+{
+    if (fd >= 0)
+    {
+        close(fd);
+    }
+}
+
+bool StateJournal::restore(std::span<std::byte> payload)
+{
+    if (payload.size() != payloadSize)
+    {
+        return false;
+    }
+    return scan(payload);
+}
+
+bool StateJournal::scan(std::span<std::byte> payload)
+{
+    headerValid = false;
+    nextSequence = 1;
+
+    Mapping map(filePath);
+    if (map.data.size() < sizeof(Header))
+    {
+        return false;
+    }
+
+    const auto expected = makeHeader(payloadVersion, payloadSize, capacity);
+    if (std::memcmp(map.data.data(), &expected, sizeof(Header)) != 0)
+    {
+        info("Ignoring journal {PATH} with a different format", "PATH",
+             filePath);
+        return false;
+    }
+    headerValid = true;
+
+    // Only look at complete slots, a torn append may have left a partial
+    // one at the end
+    auto records = map.data.subspan(sizeof(Header));
+    auto slots = std::min(capacity, records.size() / recordSize);
+
+    const std::byte* latest = nullptr;
+    uint64_t latestSequence = 0;
+    for (size_t slot = 0; slot < slots; slot++)
+    {
+        auto record = records.subspan(slot * recordSize, recordSize);
+
+        uint64_t sequence = 0;
+        std::memcpy(&sequence, record.data(), sequenceSize);
+        uint32_t crc = 0;
+        std::memcpy(&crc, record.data() + sequenceSize + payloadSize,
+                    crcSize);
+
+        if ((sequence > latestSequence) &&
+            (crc32(record.first(sequenceSize + payloadSize)) == crc))
+        {
+            latestSequence = sequence;
+            latest = record.data() + sequenceSize;
+        }
+    }
+
+    if (latest == nullptr)
+    {
+        return false;
+    }
+
+    nextSequence = latestSequence + 1;
+    if (!payload.empty())
+    {
+        std::memcpy(payload.data(), latest, payloadSize);
+    }
+    return true;
+}
+
+bool StateJournal::openForAppend()
+{
+    if (fd >= 0)
+    {
+        return true;
+    }
+
+    if (!headerValid)
+    {
+        // Pick up where an existing journal left off
+        scan({});
+    }
+
+    fd = open(filePath.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0)
+    {
+        error("Failed to open journal {PATH}: {ERRNO}", "PATH", filePath,
+              "ERRNO", errno);
+        return false;
+    }
+
+    if (!headerValid)
+    {
+        const auto header = makeHeader(payloadVersion, payloadSize, capacity);
+        if ((ftruncate(fd, 0) < 0) ||
+            (pwrite(fd, &header, sizeof(header), 0) !=
+             static_cast<ssize_t>(sizeof(header))) ||
+            (fsync(fd) < 0))
+        {
+            error("Failed to initialize journal {PATH}: {ERRNO}", "PATH",
+                  filePath, "ERRNO", errno);
+            close(fd);
+            fd = -1;
+            return false;
+        }
+        headerValid = true;
+        nextSequence = 1;
+    }
+
+    return true;
+}
+
+bool StateJournal::append(std::span<const std::byte> payload)
+{
+    if ((payload.size() != payloadSize) || !openForAppend())
+    {
+        return false;
+    }
+
+    std::vector<std::byte> record(recordSize);
+    std::memcpy(record.data(), &nextSequence, sequenceSize);
+    std::memcpy(record.data() + sequenceSize, payload.data(), payloadSize);
+    auto crc = crc32(std::span(record).first(sequenceSize + payloadSize));
+    std::memcpy(record.data() + sequenceSize + payloadSize, &crc, crcSize);
+
+    // Overwrite the oldest slot, the latest record is never touched
+    auto offset = sizeof(Header) + ((nextSequence - 1) % capacity) * recordSize;
+    if ((pwrite(fd, record.data(), record.size(), offset) !=
+         static_cast<ssize_t>(record.size())) ||
+        (fdatasync(fd) < 0))
+    {
+        error("Failed to append to journal {PATH}: {ERRNO}", "PATH", filePath,
+              "ERRNO", errno);
+        return false;
+    }
+
+    nextSequence++;
+    return true;
+}
+
+} // namespace phosphor::state::manager
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <string_view>
+
+namespace phosphor::state::manager
+{
+
+namespace fs = std::filesystem;
+
+/** @brief Fixed size, NUL padded string for use in journal records
+ *
+ *  @tparam N - Storage size, strings are truncated to N - 1 characters
+ */
+template <size_t N>
+struct FixedString
+{
+    std::array<char, N> value{};
+
+    FixedString() = default;
+
+    explicit FixedString(std::string_view str)
+    {
+        std::memcpy(value.data(), str.data(), std::min(str.size(), N - 1));
+    }
+
+    std::string str() const
+    {
+        return std::string(value.data(), strnlen(value.data(), N));
+    }
+};
+
+/** @brief String holding a D-Bus enum value, such as a state or transition,
+ *         in a journal record
+ */
+using EnumString = FixedString<128>;
+
+/** @class StateJournal
+ *  @brief Binary journal of fixed size, checksummed state records
+ *  @details The file holds a header followed by a ring of capacity record
+ *  slots. Each append writes the next slot with an increasing sequence
+ *  number and a CRC32 over the record, so a torn write only loses the
+ *  record being written and never the last complete one. Restoring maps
+ *  the file and picks the valid record with the highest sequence number,
+ *  which is a read of at most capacity records.
+ */
+class StateJournal
+{
+  public:
+    StateJournal() = delete;
+    StateJournal(const StateJournal&) = delete;
+    StateJournal& operator=(const StateJournal&) = delete;
+    StateJournal(StateJournal&&) = delete;
+    StateJournal& operator=(StateJournal&&) = delete;
+
+    /** @brief Constructs the journal, the file is not touched until used
+     *
+     * @param[in] path           - Path of the journal file
+     * @param[in] payloadVersion - Version of the record payload layout, a
+     *                             file with a different version is discarded
+     * @param[in] payloadSize    - Size of the record payload
+     * @param[in] capacity       - Number of record slots, at least 2
+     */
+    StateJournal(fs::path path, uint32_t payloadVersion, size_t payloadSize,
+                 size_t capacity = defaultCapacity);
+
+    ~StateJournal();
+
+    /** @brief Read the most recent valid record
+     *
+     * @param[out] payload - Receives the record payload
+     *
+     * @return true if a valid record was found
+     */
+    bool restore(std::span<std::byte> payload);
+
+    /** @brief Append a record and sync it to storage
+     *
+     * @param[in] payload - The record payload
+     *
+     * @return true if the record was written
+     */
+    bool append(std::span<const std::byte> payload);
+
+    /** @brief Path of the journal file */
+    const fs::path& path() const
+    {
+        return filePath;
+    }
+
+    /** @brief Default number of record slots */
+    static constexpr size_t defaultCapacity = 16;
+
+  private:
+    /** @brief Find the most recent valid record in the file
+     *
+     * @param[out] payload - Receives the record payload, if not empty
+     *
+     * @return true if a valid record was found
+     */
+    bool scan(std::span<std::byte> payload);
+
+    /** @brief Open the file for appending, recreating it if its header
+     *         doesn't match this journal
+     *
+     * @return true if the file is ready for appending
+     */
+    bool openForAppend();
+
+    /** @brief Path of the journal file */
+    const fs::path filePath;
+
+    /** @brief Version of the record payload layout */
+    const uint32_t payloadVersion;
+
+    /** @brief Size of the record payload */
+    const size_t payloadSize;
+
+    /** @brief Number of record slots */
+    const size_t capacity;
+
+    /** @brief Size of a record slot */
+    const size_t recordSize;
+
+    /** @brief File descriptor used for appending */
+    int fd = -1;
+
+    /** @brief The file was scanned and has a header matching this journal */
+    bool headerValid = false;
+
+    /** @brief Sequence number of the next record */
+    uint64_t nextSequence = 1;
+};
+
+} // namespace phosphor::state::manager
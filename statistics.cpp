@@ -0,0 +1,201 @@
+#include "config.h"
+
+#include "statistics.hpp"
+
+#include <phosphor-logging/lg2.hpp>
+#include <sdbusplus/exception.hpp>
+#include <sdbusplus/message.hpp>
+
+#include <format>
+
+namespace phosphor::state::manager::utils
+{
+
+PHOSPHOR_LOG2_USING;
+
+using std::chrono::duration_cast;
+using std::chrono::microseconds;
+
+const sdbusplus::vtable_t StatisticsInterface::vtable[] = {
+    sdbusplus::vtable::start(),
+    sdbusplus::vtable::property("Statistics", "a{st}", getStatistics,
+                                sdbusplus::vtable::property_::emits_change),
+    sdbusplus::vtable::end()};
+
+StatisticsInterface::StatisticsInterface(sdbusplus::bus_t& bus,
+                                         const std::string& path,
+                                         const std::string& interface) :
+    objectPath(path), interfaceName(interface)
+{
+    if constexpr (!ENABLE_DEBUG_STATISTICS)
+    {
+        return;
+    }
+
+    iface.emplace(bus, objectPath.c_str(), interfaceName.c_str(), vtable,
+                  this);
+    try
+    {
+        iface->emit_added();
+    }
+    catch (const sdbusplus::exception_t& e)
+    {
+        // There is no object manager above every path this is added to
+        debug("No InterfacesAdded for {INTERFACE} on {PATH}: {ERROR}",
+              "INTERFACE", interfaceName, "PATH", objectPath, "ERROR", e);
+    }
+}
+
+StatisticsInterface::~StatisticsInterface()
+{
+    if (!iface)
+    {
+        return;
+    }
+
+    try
+    {
+        iface->emit_removed();
+    }
+    catch (const sdbusplus::exception_t& e)
+    {
+        debug("No InterfacesRemoved for {INTERFACE} on {PATH}: {ERROR}",
+              "INTERFACE", interfaceName, "PATH", objectPath, "ERROR", e);
+    }
+}
+
+void StatisticsInterface::set(const std::string& name, uint64_t value)
+{
+    statistics.insert_or_assign(name, value);
+    if (iface)
+    {
+        iface->property_changed("Statistics");
+    }
+}
+
+void StatisticsInterface::set(Values values)
+{
+    statistics = std::move(values);
+    if (iface)
+    {
+        iface->property_changed("Statistics");
+    }
+}
+
+int StatisticsInterface::getStatistics(
+    sd_bus* /*bus*/, const char* /*path*/, const char* /*interface*/,
+    const char* /*property*/, sd_bus_message* reply, void* context,
+    sd_bus_error* /*error*/)
+{
+    auto* self = static_cast<StatisticsInterface*>(context);
+
+    try
+    {
+        sdbusplus::message_t m(reply);
+        m.append(self->statistics);
+    }
+    catch (const sdbusplus::exception_t& e)
+    {
+        error("Failed to read {INTERFACE} statistics: {ERROR}", "INTERFACE",
+              self->interfaceName, "ERROR", e);
+        return -e.get_errno();
+    }
+
+    return 1;
+}
+
+StartupTimer::Phase::Phase(StartupTimer& timer, std::string name) :
+    timer(timer), name(std::move(name)),
+    begin(std::chrono::steady_clock::now())
+{}
+
+StartupTimer::Phase::~Phase()
+{
+    timer.record(name, begin);
+}
+
+StartupTimer::StartupTimer() : start(std::chrono::steady_clock::now()) {}
+
+StartupTimer& StartupTimer::instance()
+{
+    static StartupTimer timer;
+    return timer;
+}
+
+StartupTimer::Phase StartupTimer::phase(std::string name)
+{
+    return Phase(*this, std::move(name));
+}
+
+void StartupTimer::mark(const std::string& name)
+{
+    record(name, std::chrono::steady_clock::now());
+}
+
+void StartupTimer::record(const std::string& name,
+                          std::chrono::steady_clock::time_point begin)
+{
+    auto now = std::chrono::steady_clock::now();
+    records.emplace_back(name, duration_cast<microseconds>(begin - start),
+                         duration_cast<microseconds>(now - start));
+}
+
+void StartupTimer::log() const
+{
+    std::string phases;
+    for (const auto& record : records)
+    {
+        if (!phases.empty())
+        {
+            phases += ", ";
+        }
+
+        if (record.begin == record.end)
+        {
+            phases += std::format("{} at {} us", record.name,
+                                  record.begin.count());
+        }
+        else
+        {
+            phases += std::format("{} {} us at {} us", record.name,
+                                  (record.end - record.begin).count(),
+                                  record.begin.count());
+        }
+    }
+
+    auto elapsed = duration_cast<microseconds>(
+        std::chrono::steady_clock::now() - start);
+    info("Start-up took {ELAPSED_US} us: {PHASES}", "ELAPSED_US",
+         elapsed.count(), "PHASES", phases);
+}
+
+StatisticsInterface::Values StartupTimer::values() const
+{
+    StatisticsInterface::Values values;
+    values.emplace("start_us",
+                   duration_cast<microseconds>(start.time_since_epoch())
+                       .count());
+
+    for (const auto& record : records)
+    {
+        values.insert_or_assign(record.name + ".begin_us",
+                                record.begin.count());
+        values.insert_or_assign(record.name + ".end_us", record.end.count());
+    }
+    return values;
+}
+
+std::unique_ptr<StatisticsInterface> publishStartup(sdbusplus::bus_t& bus,
+                                                    const std::string& path)
+{
+    auto& startup = StartupTimer::instance();
+    startup.mark("request_name");
+    startup.log();
+
+    auto statistics = std::make_unique<StatisticsInterface>(
+        bus, path, STARTUP_STATISTICS_INTERFACE);
+    statistics->set(startup.values());
+    return statistics;
+}
+
+} // namespace phosphor::state::manager::utils
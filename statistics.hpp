@@ -0,0 +1,213 @@
+#pragma once
+
+#include "config.h"
+
+#include <sdbusplus/bus.hpp>
+#include <sdbusplus/server/interface.hpp>
+#include <sdbusplus/vtable.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace phosphor::state::manager::utils
+{
+
+/** @brief Interface exposing the start-up timing of a daemon */
+constexpr auto STARTUP_STATISTICS_INTERFACE =
+    "phosphor.state_manager.Debug.Startup";
+
+/** @brief Interface exposing the update and write counts of the persisted
+ *  files of an object */
+constexpr auto PERSIST_STATISTICS_INTERFACE =
+    "phosphor.state_manager.Debug.Persist";
+
+/** @class StatisticsInterface
+ *  @brief Read only D-Bus interface exposing named values
+ *  @details Adds an interface with a single Statistics property, a dict of
+ *  names to unsigned values, to an object path. Used for debug data that has
+ *  no phosphor-dbus-interfaces definition, so the interfaces are named in
+ *  this repository's phosphor.state_manager.Debug namespace. They are only
+ *  added to D-Bus when the debug-statistics option is enabled, the values
+ *  are kept either way.
+ */
+class StatisticsInterface
+{
+  public:
+    /** @brief Statistics keyed by name */
+    using Values = std::map<std::string, uint64_t>;
+
+    StatisticsInterface() = delete;
+    StatisticsInterface(const StatisticsInterface&) = delete;
+    StatisticsInterface& operator=(const StatisticsInterface&) = delete;
+    StatisticsInterface(StatisticsInterface&&) = delete;
+    StatisticsInterface& operator=(StatisticsInterface&&) = delete;
+
+    /** @brief Removes the interface, emitting InterfacesRemoved */
+    ~StatisticsInterface();
+
+    /** @brief Adds the interface to an object path, emitting InterfacesAdded
+     *
+     * @param[in] bus        - The Dbus bus object
+     * @param[in] path       - The Dbus object path
+     * @param[in] interface  - Name of the interface
+     */
+    StatisticsInterface(sdbusplus::bus_t& bus, const std::string& path,
+                        const std::string& interface);
+
+    /** @brief Set one value, emitting PropertiesChanged */
+    void set(const std::string& name, uint64_t value);
+
+    /** @brief Replace all values, emitting PropertiesChanged */
+    void set(Values values);
+
+    /** @brief Current values */
+    const Values& values() const
+    {
+        return statistics;
+    }
+
+  private:
+    /** @brief sd-bus getter of the Statistics property */
+    static int getStatistics(sd_bus* bus, const char* path,
+                             const char* interface, const char* property,
+                             sd_bus_message* reply, void* context,
+                             sd_bus_error* error);
+
+    /** @brief The interface vtable */
+    static const sdbusplus::vtable_t vtable[];
+
+    /** @brief Current values */
+    Values statistics;
+
+    /** @brief Object path, kept for the lifetime of the interface */
+    const std::string objectPath;
+
+    /** @brief Name of the interface, kept for the lifetime of the
+     *  interface */
+    const std::string interfaceName;
+
+    /** @brief The registered interface, empty unless debug statistics are
+     *  enabled */
+    std::optional<sdbusplus::server::interface_t> iface;
+};
+
+/** @class StartupTimer
+ *  @brief Records when the start-up phases of a daemon begin and end
+ *  @details One timer exists per process. Times are monotonic and relative
+ *  to the first use of the timer, which should be early in main().
+ */
+class StartupTimer
+{
+  public:
+    /** @class Phase
+     *  @brief Times a start-up phase for as long as it exists
+     */
+    class Phase
+    {
+      public:
+        Phase() = delete;
+        Phase(const Phase&) = delete;
+        Phase& operator=(const Phase&) = delete;
+        Phase(Phase&&) = delete;
+        Phase& operator=(Phase&&) = delete;
+
+        /** @brief Starts timing a phase */
+        Phase(StartupTimer& timer, std::string name);
+
+        /** @brief Records the end of the phase */
+        ~Phase();
+
+      private:
+        StartupTimer& timer;
+        const std::string name;
+        const std::chrono::steady_clock::time_point begin;
+    };
+
+    StartupTimer(const StartupTimer&) = delete;
+    StartupTimer& operator=(const StartupTimer&) = delete;
+    StartupTimer(StartupTimer&&) = delete;
+    StartupTimer& operator=(StartupTimer&&) = delete;
+
+    /** @brief Get the process wide timer */
+    static StartupTimer& instance();
+
+    /** @brief Start timing a phase, which ends when the result is destroyed
+     *
+     * @param[in] name       - Name of the phase
+     */
+    [[nodiscard]] Phase phase(std::string name);
+
+    /** @brief Record a point in time, such as claiming the bus name
+     *
+     * @param[in] name       - Name of the point
+     */
+    void mark(const std::string& name);
+
+    /** @brief Log every recorded phase in one record */
+    void log() const;
+
+    /** @brief Recorded phases for a StatisticsInterface
+     *
+     *  Each phase has <name>.begin_us and <name>.end_us entries, in
+     *  microseconds from the start of the timer. start_us is the start of the
+     *  timer in microseconds of monotonic time since boot.
+     */
+    StatisticsInterface::Values values() const;
+
+  private:
+    StartupTimer();
+    ~StartupTimer() = default;
+
+    /** @brief A recorded phase */
+    struct Record
+    {
+        std::string name;
+        std::chrono::microseconds begin;
+        std::chrono::microseconds end;
+    };
+
+    /** @brief Record a phase that just ended */
+    void record(const std::string& name,
+                std::chrono::steady_clock::time_point begin);
+
+    /** @brief Start of the timer */
+    const std::chrono::steady_clock::time_point start;
+
+    /** @brief Recorded phases in the order they ended */
+    std::vector<Record> records;
+};
+
+/** @brief Record that start-up is complete, log and publish the timing
+ *
+ * Called once the daemon claimed its bus name.
+ *
+ * @param[in] bus        - The Dbus bus object
+ * @param[in] path       - Object path to add the timing interface to
+ *
+ * @return The timing interface, which must be kept alive
+ */
+std::unique_ptr<StatisticsInterface> publishStartup(sdbusplus::bus_t& bus,
+                                                    const std::string& path);
+
+/** @brief Time a start-up phase that produces a value
+ *
+ * Meant for member initializers, which can't hold a StartupTimer::Phase.
+ *
+ * @param[in] name       - Name of the phase
+ * @param[in] func       - Produces the value
+ *
+ * @return The value returned by func
+ */
+template <typename Func>
+auto timedPhase(std::string name, Func&& func) -> decltype(func())
+{
+    auto phase = StartupTimer::instance().phase(std::move(name));
+    return func();
+}
+
+} // namespace phosphor::state::manager::utils
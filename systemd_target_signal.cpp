@@ -119,7 +119,7 @@ std::string SystemdTargetLogging::processError(const std::string& unit,
     return (std::string{});
 }
 
-void SystemdTargetLogging::systemdUnitChange(sdbusplus::message_t& msg)
+bool SystemdTargetLogging::systemdUnitChange(sdbusplus::message_t& msg)
 {
     uint32_t id;
     sdbusplus::object_path objPath;
@@ -137,9 +137,10 @@ void SystemdTargetLogging::systemdUnitChange(sdbusplus::message_t& msg)
         if (!error.empty())
         {
             logError(error, result, unit);
+            return true;
         }
     }
-    return;
+    return false;
 }
 
 void SystemdTargetLogging::processNameChangeSignal(sdbusplus::message_t& msg)
@@ -36,17 +36,24 @@ class SystemdTargetLogging
         sdbusplus::bus_t& bus) :
         targetData(targetData), serviceData(serviceData),
         immediateQuiesceServiceData(immediateQuiesceServiceData), bus(bus),
-        systemdJobRemovedSignal(
-            bus,
-            sdbusplus::match_rules::type::signal() +
-                sdbusplus::match_rules::member("JobRemoved") +
-                sdbusplus::match_rules::path(SYSTEMD_OBJ_PATH) +
-                sdbusplus::match_rules::interface(SYSTEMD_MANAGER_INTERFACE),
-            [this](sdbusplus::message_t& m) { systemdUnitChange(m); }),
+        systemdJobRemovedSignal(bus, "JobRemoved",
+                                [this](sdbusplus::message_t& m) {
+                                    return systemdUnitChange(m);
+                                }),
         systemdNameOwnedChangedSignal(
             bus, sdbusplus::match_rules::nameOwnerChanged(),
             [this](sdbusplus::message_t& m) { processNameChangeSignal(m); })
-    {}
+    {
+        // Only have the bus deliver job signals for monitored units
+        for (const auto& [target, errors] : targetData)
+        {
+            systemdJobRemovedSignal.watch(target);
+        }
+        for (const auto& service : serviceData)
+        {
+            systemdJobRemovedSignal.watch(service);
+        }
+    }
 
     /**
      * @brief subscribe to the systemd signals
@@ -89,8 +96,9 @@ class SystemdTargetLogging
      *
      * @param[in]  msg       - Data associated with subscribed signal
      *
+     * @return true if an error was logged for the unit
      */
-    void systemdUnitChange(sdbusplus::message_t& msg);
+    bool systemdUnitChange(sdbusplus::message_t& msg);
 
     /** @brief Wait for systemd to show up on dbus
      *
@@ -133,7 +141,7 @@ class SystemdTargetLogging
     sdbusplus::bus_t& bus;
 
     /** @brief Used to subscribe to dbus systemd JobRemoved signals **/
-    sdbusplus::match systemdJobRemovedSignal;
+    utils::SystemdJobSignals systemdJobRemovedSignal;
 
     /** @brief Used to know when systemd has registered on dbus **/
     sdbusplus::match systemdNameOwnedChangedSignal;
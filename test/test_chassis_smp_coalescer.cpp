@@ -0,0 +1,104 @@
+#include "chassis_smp_coalescer.hpp"
+
+#include <sys/epoll.h>
+#include <unistd.h>
+
+#include <sdeventplus/event.hpp>
+#include <sdeventplus/source/io.hpp>
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace phosphor::state::manager
+{
+
+using namespace std::chrono_literals;
+
+class TestChangeCoalescer : public testing::Test
+{
+  public:
+    sdeventplus::Event event = sdeventplus::Event::get_new();
+
+    /** @brief The changes of each run of the callback */
+    std::vector<size_t> runs;
+
+    ChangeCoalescer::Callback record()
+    {
+        return [this](size_t changes) { runs.push_back(changes); };
+    }
+
+    /** @brief Run the event loop until the callback ran count times */
+    void runUntil(size_t count)
+    {
+        while (runs.size() < count)
+        {
+            event.run(std::nullopt);
+        }
+    }
+};
+
+TEST_F(TestChangeCoalescer, QueuedChangesRunOnce)
+{
+    ChangeCoalescer coalescer(event, 0ms, record());
+
+    // Each byte stands for a queued signal, read one per dispatch like the
+    // bus handles its messages
+    constexpr size_t signals = 8;
+    std::array<int, 2> fds{};
+    ASSERT_EQ(pipe(fds.data()), 0);
+    std::string queued(signals, 'x');
+    ASSERT_EQ(write(fds[1], queued.data(), queued.size()),
+              static_cast<ssize_t>(signals));
+
+    sdeventplus::source::IO bus(event, fds[0], EPOLLIN,
+                                [&coalescer](auto&, int fd, uint32_t) {
+                                    char byte;
+                                    if (read(fd, &byte, 1) == 1)
+                                    {
+                                        coalescer.changed();
+                                    }
+                                });
+
+    runUntil(1);
+    EXPECT_EQ(runs, std::vector<size_t>{signals});
+    EXPECT_EQ(coalescer.pending(), 0U);
+
+    close(fds[0]);
+    close(fds[1]);
+}
+
+TEST_F(TestChangeCoalescer, DelayedChangesRunOnce)
+{
+    ChangeCoalescer coalescer(event, 10ms, record());
+
+    for (size_t i = 0; i < 5; ++i)
+    {
+        coalescer.changed();
+    }
+    EXPECT_EQ(coalescer.pending(), 5U);
+
+    runUntil(1);
+    EXPECT_EQ(runs, std::vector<size_t>{5});
+}
+
+TEST_F(TestChangeCoalescer, ChangesAfterARunStartANewBurst)
+{
+    ChangeCoalescer coalescer(event, 0ms, record());
+
+    coalescer.changed();
+    runUntil(1);
+
+    coalescer.changed();
+    coalescer.changed();
+    runUntil(2);
+
+    EXPECT_EQ(runs, (std::vector<size_t>{1, 2}));
+}
+
+} // namespace phosphor::state::manager
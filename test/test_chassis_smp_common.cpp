@@ -0,0 +1,167 @@
+#include "chassis_smp_common.hpp"
+
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace phosphor::state::manager
+{
+
+enum class TestState
+{
+    Off,
+    Transitioning,
+    On,
+};
+
+using TestTable =
+    ChassisStateTable<TestState, enumValueRoom<TestState::Off,
+                                               TestState::Transitioning,
+                                               TestState::On>,
+                      4>;
+
+static_assert(enumValueRoom<TestState::On, TestState::Off> == 3);
+
+TEST(TestChassisSMPCommon, ChassisRange)
+{
+    auto range = chassisRange<4>(3);
+
+    EXPECT_FALSE(range.test(0));
+    EXPECT_TRUE(range.test(1));
+    EXPECT_TRUE(range.test(3));
+    EXPECT_FALSE(range.test(4));
+    EXPECT_EQ(range.count(), 3U);
+}
+
+TEST(TestChassisSMPCommon, ForEachChassisVisitsMembers)
+{
+    ChassisSet<4> chassis;
+    chassis.set(2);
+    chassis.set(4);
+
+    std::vector<size_t> visited;
+    forEachChassis(chassis, [&visited](size_t id) { visited.push_back(id); });
+    EXPECT_EQ(visited, (std::vector<size_t>{2, 4}));
+
+    visited.clear();
+    forEachChassis(ChassisSet<4>{},
+                   [&visited](size_t id) { visited.push_back(id); });
+    EXPECT_TRUE(visited.empty());
+}
+
+TEST(TestChassisSMPCommon, ForEachChassisSkipsBitZero)
+{
+    ChassisSet<4> chassis;
+    chassis.set(0);
+    chassis.set(4);
+
+    std::vector<size_t> visited;
+    forEachChassis(chassis, [&visited](size_t id) { visited.push_back(id); });
+    EXPECT_EQ(visited, (std::vector<size_t>{4}));
+
+    chassis.reset(4);
+    visited.clear();
+    forEachChassis(chassis, [&visited](size_t id) { visited.push_back(id); });
+    EXPECT_TRUE(visited.empty());
+}
+
+TEST(TestChassisSMPCommon, ChassisIdListJoinsMembers)
+{
+    EXPECT_EQ(chassisIdList(ChassisSet<4>{}), "");
+    EXPECT_EQ(chassisIdList(ChassisSet<4>{0b00100}), "2");
+    EXPECT_EQ(chassisIdList(ChassisSet<4>{0b10101}), "2,4");
+}
+
+TEST(TestChassisSMPCommon, ChassisIdFromPath)
+{
+    EXPECT_EQ(chassisIdFromPath("/xyz/openbmc_project/state/chassis1",
+                                CHASSIS_STATE_PATH_PREFIX, 12),
+              1U);
+    EXPECT_EQ(chassisIdFromPath("/xyz/openbmc_project/state/chassis12",
+                                CHASSIS_STATE_PATH_PREFIX, 12),
+              12U);
+    EXPECT_EQ(
+        chassisIdFromPath("/xyz/openbmc_project/inventory/system/chassis3",
+                          CHASSIS_INVENTORY_PATH_PREFIX, 12),
+        3U);
+}
+
+TEST(TestChassisSMPCommon, ChassisIdFromPathRejectsOtherPaths)
+{
+    // The aggregator itself, out of range and not a chassis
+    for (const auto* path : {"/xyz/openbmc_project/state/chassis0",
+                             "/xyz/openbmc_project/state/chassis13",
+                             "/xyz/openbmc_project/state/chassis",
+                             "/xyz/openbmc_project/state/chassis01",
+                             "/xyz/openbmc_project/state/chassis1x",
+                             "/xyz/openbmc_project/state/host1",
+                             "/xyz/openbmc_project/state/chassis1/sub"})
+    {
+        EXPECT_EQ(chassisIdFromPath(path, CHASSIS_STATE_PATH_PREFIX, 12),
+                  std::nullopt)
+            << path;
+    }
+}
+
+TEST(TestChassisSMPCommon, StartsAtInitialValue)
+{
+    TestTable table{TestState::Off};
+
+    EXPECT_EQ(table.get(1), TestState::Off);
+    EXPECT_EQ(table.get(4), TestState::Off);
+    EXPECT_EQ(table.with(TestState::Off), chassisRange<4>(4));
+    EXPECT_TRUE(table.with(TestState::On).none());
+}
+
+TEST(TestChassisSMPCommon, SetMovesChassisBetweenSets)
+{
+    TestTable table{TestState::Off};
+
+    table.set(2, TestState::On);
+    EXPECT_EQ(table.get(2), TestState::On);
+    EXPECT_TRUE(table.with(TestState::On).test(2));
+    EXPECT_FALSE(table.with(TestState::Off).test(2));
+    EXPECT_EQ(table.with(TestState::Off).count(), 3U);
+
+    table.set(2, TestState::Transitioning);
+    EXPECT_TRUE(table.with(TestState::On).none());
+    EXPECT_TRUE(table.with(TestState::Transitioning).test(2));
+}
+
+TEST(TestChassisSMPCommon, QueriesPresentChassis)
+{
+    TestTable table{TestState::Off};
+    ChassisSet<4> present;
+    present.set(1);
+    present.set(3);
+
+    // An absent chassis doesn't count
+    table.set(2, TestState::On);
+    EXPECT_FALSE((present & table.with(TestState::On)).any());
+
+    table.set(1, TestState::On);
+    table.set(3, TestState::On);
+    EXPECT_TRUE((present & ~table.with(TestState::On)).none());
+}
+
+TEST(TestChassisSMPCommon, RejectsInvalidChassisId)
+{
+    TestTable table{TestState::Off};
+
+    EXPECT_THROW(table.get(0), std::out_of_range);
+    EXPECT_THROW(table.get(5), std::out_of_range);
+    EXPECT_THROW(table.set(5, TestState::On), std::out_of_range);
+}
+
+TEST(TestChassisSMPCommon, RejectsValueOutsideTable)
+{
+    ChassisStateTable<TestState, 2, 4> table{TestState::Off};
+
+    EXPECT_THROW(table.set(1, TestState::On), std::out_of_range);
+    EXPECT_EQ(table.get(1), TestState::Off);
+}
+
+} // namespace phosphor::state::manager
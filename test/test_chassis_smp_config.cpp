@@ -0,0 +1,205 @@
+#include "chassis_smp_config.hpp"
+
+#include <nlohmann/json.hpp>
+
+#include <stdexcept>
+
+#include <gtest/gtest.h>
+
+namespace phosphor::state::manager
+{
+
+using json = nlohmann::json;
+
+TEST(TestChassisSMPConfig, FlatWithoutGroups)
+{
+    SMPConfig config{json::object(), 4};
+
+    EXPECT_FALSE(config.hierarchical());
+    EXPECT_EQ(config.leavesOf(0), chassisRange(4));
+    EXPECT_TRUE(config.subGroupsOf(0).none());
+}
+
+TEST(TestChassisSMPConfig, SplitsChassisIntoGroups)
+{
+    auto data = json::parse(R"({
+        "groups": [
+            { "chassis": 9, "members": [1, 2, 3, 4] },
+            { "chassis": 10, "members": [5, 6] },
+            { "chassis": 11, "members": [9, 10] }
+        ]
+    })");
+    SMPConfig config{data, 12};
+
+    EXPECT_TRUE(config.hierarchical());
+    EXPECT_TRUE(config.isGroup(9));
+    EXPECT_FALSE(config.isGroup(1));
+
+    // Chassis 0 aggregates the top group and the ungrouped chassis
+    ChassisSet<> topGroups;
+    topGroups.set(11);
+    EXPECT_EQ(config.subGroupsOf(0), topGroups);
+    ChassisSet<> ungrouped;
+    ungrouped.set(7).set(8).set(12);
+    EXPECT_EQ(config.leavesOf(0), ungrouped);
+
+    ChassisSet<> subGroups;
+    subGroups.set(9).set(10);
+    EXPECT_EQ(config.subGroupsOf(11), subGroups);
+    EXPECT_TRUE(config.leavesOf(11).none());
+
+    EXPECT_EQ(config.leavesOf(9), chassisRange(4));
+    EXPECT_TRUE(config.subGroupsOf(9).none());
+
+    // A chassis that isn't a group aggregates nothing
+    EXPECT_TRUE(config.leavesOf(1).none());
+}
+
+TEST(TestChassisSMPConfig, SplitsChassisIntoPartitions)
+{
+    auto data = json::parse(R"({
+        "groups": [
+            { "chassis": 9, "members": [1, 2] },
+            { "chassis": 10, "members": [3, 4] }
+        ],
+        "partitions": [
+            { "host": 0, "members": [9, 10] },
+            { "host": 1, "members": [5, 6, 7, 8] }
+        ]
+    })");
+    SMPConfig config{data, 12};
+
+    EXPECT_TRUE(config.hierarchical());
+    EXPECT_TRUE(config.hasPartition(0));
+    EXPECT_TRUE(config.hasPartition(1));
+    EXPECT_FALSE(config.hasPartition(2));
+
+    // The partitions are keyed by host, not by chassis
+    EXPECT_FALSE(config.isGroup(1));
+    EXPECT_TRUE(config.leavesOf(1).none());
+
+    ChassisSet<> rootGroups;
+    rootGroups.set(9).set(10);
+    EXPECT_EQ(config.subGroupsOf(SMPAggregator::partition(0)), rootGroups);
+    EXPECT_TRUE(config.leavesOf(SMPAggregator::partition(0)).none());
+
+    ChassisSet<> partition1;
+    partition1.set(5).set(6).set(7).set(8);
+    EXPECT_EQ(config.leavesOf(SMPAggregator::partition(1)), partition1);
+
+    // Chassis 0 keeps the chassis outside of the partitions
+    ChassisSet<> unpartitioned;
+    unpartitioned.set(11).set(12);
+    EXPECT_EQ(config.leavesOf(0), unpartitioned);
+    EXPECT_TRUE(config.subGroupsOf(0).none());
+
+    EXPECT_EQ(config.chassisOfHost(0), chassisRange(4));
+    EXPECT_EQ(config.chassisOfHost(1), partition1);
+    EXPECT_TRUE(config.chassisOfHost(2).none());
+}
+
+TEST(TestChassisSMPConfig, PartitionIdsAreSeparateFromChassisIds)
+{
+    auto data = json::parse(R"({
+        "partitions": [
+            { "host": 0, "members": [1, 2, 3, 4] },
+            { "host": 1, "members": [5, 6, 7, 8] }
+        ]
+    })");
+    SMPConfig config{data, 8};
+
+    EXPECT_EQ(config.chassisOfHost(0), chassisRange(4));
+    EXPECT_EQ(config.chassisOfHost(1), chassisRange(8) & ~chassisRange(4));
+
+    // Chassis 1 is a member of host 0, not the aggregator of host 1
+    EXPECT_FALSE(config.isGroup(1));
+    EXPECT_TRUE(config.leavesOf(0).none());
+}
+
+TEST(TestChassisSMPConfig, PartitionsAreIndependentOfChassis0)
+{
+    auto data = json::parse(R"({
+        "partitions": [
+            { "host": 1, "members": [5, 6] }
+        ]
+    })");
+    SMPConfig config{data, 12};
+
+    // Chassis 0 keeps the chassis outside of the partitions
+    EXPECT_TRUE(config.subGroupsOf(0).none());
+    EXPECT_FALSE(config.leavesOf(0).test(5));
+    EXPECT_TRUE(config.leavesOf(0).test(1));
+    EXPECT_EQ(config.chassisOfHost(0), config.leavesOf(0));
+}
+
+TEST(TestChassisSMPConfig, RejectsInvalidGroups)
+{
+    EXPECT_THROW(
+        (SMPConfig{json::parse(R"({"groups": [
+                       {"chassis": 0, "members": [1]}]})"),
+                   4}),
+        std::invalid_argument);
+    EXPECT_THROW(
+        (SMPConfig{json::parse(R"({"groups": [
+                       {"chassis": 4, "members": [1, 5]}]})"),
+                   4}),
+        std::invalid_argument);
+    EXPECT_THROW(
+        (SMPConfig{json::parse(R"({"groups": [
+                       {"chassis": 3, "members": [1]},
+                       {"chassis": 4, "members": [1]}]})"),
+                   4}),
+        std::invalid_argument);
+    EXPECT_THROW(
+        (SMPConfig{json::parse(R"({"groups": [
+                       {"chassis": 3, "members": [4]},
+                       {"chassis": 4, "members": [3]}]})"),
+                   4}),
+        std::invalid_argument);
+}
+
+TEST(TestChassisSMPConfig, RejectsInvalidPartitions)
+{
+    // A host with two partitions
+    EXPECT_THROW(
+        (SMPConfig{json::parse(R"({"partitions": [
+                       {"host": 1, "members": [1]},
+                       {"host": 1, "members": [2]}]})"),
+                   4}),
+        std::invalid_argument);
+    // A chassis in a group and a partition
+    EXPECT_THROW(
+        (SMPConfig{json::parse(R"({"groups": [
+                       {"chassis": 3, "members": [1]}],
+                   "partitions": [
+                       {"host": 1, "members": [1]}]})"),
+                   4}),
+        std::invalid_argument);
+    // A partition without chassis
+    EXPECT_THROW(
+        (SMPConfig{json::parse(R"({"partitions": [
+                       {"host": 1, "members": []}]})"),
+                   4}),
+        std::invalid_argument);
+    // A partition keyed by chassis
+    EXPECT_THROW(
+        (SMPConfig{json::parse(R"({"partitions": [
+                       {"chassis": 3, "host": 1, "members": [1]}]})"),
+                   4}),
+        std::invalid_argument);
+}
+
+TEST(TestChassisSMPConfig, RejectsMalformedJson)
+{
+    EXPECT_THROW((SMPConfig{json::parse(R"({"groups": [{"chassis": 3}]})"),
+                            4}),
+                 nlohmann::json::exception);
+}
+
+TEST(TestChassisSMPConfig, MissingFileIsFlat)
+{
+    auto config = loadSMPConfig("/nonexistent/smp-config.json", 4);
+    EXPECT_FALSE(config.hierarchical());
+}
+
+} // namespace phosphor::state::manager
@@ -175,9 +175,10 @@ TEST_F(ChassisSMPEnhancedTest, ForwardsTransitionToAllChassis)
 {
     auto smp = createChassisSMP(3);
 
-    // Mock the D-Bus call for transition forwarding
-    EXPECT_CALL(sdbusMock, sd_bus_call(_, _, _, _, _))
-        .Times(AtLeast(3)); // Should forward to chassis 1, 2, 3
+    // The transition is forwarded with concurrent async calls
+    EXPECT_CALL(sdbusMock, sd_bus_call_async(_, _, _, _, _, _))
+        .Times(AtLeast(3)) // Should forward to chassis 1, 2, 3
+        .WillRepeatedly(DoAll(SetArgPointee<1>(mockSlot), Return(0)));
 
     // Request a power transition
     smp->requestedPowerTransition(ChassisSMP::Transition::On);
@@ -0,0 +1,104 @@
+#include "chassis_smp_presence.hpp"
+
+#include <format>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace phosphor::state::manager
+{
+
+class TestChassisSMPPresence : public testing::Test
+{
+  public:
+    std::vector<std::string> serviceReads;
+    std::vector<size_t> chassisReads;
+
+    static std::string itemPath(size_t chassisId)
+    {
+        return std::format("{}{}", CHASSIS_INVENTORY_PATH_PREFIX, chassisId);
+    }
+
+    ChassisInventory collect(const InventorySubTree& subTree,
+                             const std::map<std::string, InventoryPresence>&
+                                 presenceByService)
+    {
+        return collectChassisInventory(
+            subTree, 4,
+            [this, &presenceByService](const std::string& service) {
+                serviceReads.push_back(service);
+                auto presence = presenceByService.find(service);
+                return (presence == presenceByService.end())
+                           ? InventoryPresence{}
+                           : presence->second;
+            },
+            [this](size_t chassisId) {
+                chassisReads.push_back(chassisId);
+                return true;
+            });
+    }
+};
+
+TEST_F(TestChassisSMPPresence, ReadsEachServiceOnce)
+{
+    InventorySubTree subTree = {
+        {itemPath(1), {{"inventory.a", {}}}},
+        {itemPath(2), {{"inventory.a", {}}}},
+        {itemPath(3), {{"inventory.a", {}}}},
+        {itemPath(4), {{"inventory.b", {}}}},
+    };
+
+    auto inventory =
+        collect(subTree, {{"inventory.a", {{itemPath(1), true},
+                                           {itemPath(2), false},
+                                           {itemPath(3), true}}},
+                          {"inventory.b", {{itemPath(4), true}}}});
+
+    EXPECT_EQ(serviceReads,
+              (std::vector<std::string>{"inventory.a", "inventory.b"}));
+    EXPECT_TRUE(chassisReads.empty());
+    EXPECT_EQ(inventory.members.count(), 4U);
+    EXPECT_TRUE(inventory.present.test(1));
+    EXPECT_FALSE(inventory.present.test(2));
+    EXPECT_TRUE(inventory.present.test(3));
+    EXPECT_TRUE(inventory.present.test(4));
+}
+
+TEST_F(TestChassisSMPPresence, ReadsUnresolvedChassisOnTheirOwn)
+{
+    InventorySubTree subTree = {
+        {itemPath(1), {{"inventory.a", {}}}},
+        {itemPath(2), {{"inventory.a", {}}}},
+        {itemPath(3), {{"inventory.b", {}}}},
+    };
+
+    // Chassis 2 has no Present property and inventory.b can't be read
+    auto inventory =
+        collect(subTree, {{"inventory.a", {{itemPath(1), false}}}});
+
+    EXPECT_EQ(chassisReads, (std::vector<size_t>{2, 3}));
+    EXPECT_FALSE(inventory.present.test(1));
+    EXPECT_TRUE(inventory.present.test(2));
+    EXPECT_TRUE(inventory.present.test(3));
+}
+
+TEST_F(TestChassisSMPPresence, OnlyChassisItemsAreMembers)
+{
+    InventorySubTree subTree = {
+        {itemPath(2), {{"inventory.a", {}}}},
+        {itemPath(7), {{"inventory.a", {}}}},
+        {"/xyz/openbmc_project/inventory/system/chassis2/board",
+         {{"inventory.a", {}}}},
+        {itemPath(3), {}},
+    };
+
+    auto inventory = collect(subTree, {{"inventory.a", {{itemPath(2), true}}}});
+
+    EXPECT_EQ(inventory.members.count(), 1U);
+    EXPECT_TRUE(inventory.members.test(2));
+    EXPECT_EQ(inventory.present.count(), 1U);
+    EXPECT_TRUE(chassisReads.empty());
+}
+
+} // namespace phosphor::state::manager
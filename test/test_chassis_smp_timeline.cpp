@@ -0,0 +1,125 @@
+#include "chassis_smp_timeline.hpp"
+
+#include <chrono>
+
+#include <gtest/gtest.h>
+
+namespace phosphor::state::manager
+{
+
+using namespace std::chrono_literals;
+
+namespace
+{
+
+ChassisSet<> chassis(std::initializer_list<size_t> ids)
+{
+    ChassisSet<> set;
+    for (auto id : ids)
+    {
+        set.set(id);
+    }
+    return set;
+}
+
+} // namespace
+
+TEST(TestChassisSMPTimeline, EmptyBeforeFirstTransition)
+{
+    TransitionTimelines timelines{4};
+
+    EXPECT_FALSE(timelines.reached(1));
+    EXPECT_FALSE(timelines.slowest());
+    EXPECT_EQ(timelines.spread(), 0ms);
+    EXPECT_TRUE(timelines.values().empty());
+}
+
+TEST(TestChassisSMPTimeline, FindsSlowestChassisAndSpread)
+{
+    TransitionTimelines timelines{4};
+    TransitionTimelines::Clock::time_point start{};
+
+    timelines.start(1, chassis({1, 2, 3}), start);
+    timelines.transitioning(2, start + 10ms);
+    EXPECT_FALSE(timelines.reached(2, start + 100ms));
+    EXPECT_FALSE(timelines.reached(1, start + 400ms));
+    EXPECT_TRUE(timelines.reached(3, start + 250ms));
+
+    EXPECT_EQ(timelines.slowest(), 1);
+    EXPECT_EQ(timelines.slowestTime(), 400ms);
+    EXPECT_EQ(timelines.spread(), 300ms);
+
+    auto values = timelines.values();
+    EXPECT_EQ(values["timeline0.transition"], 1);
+    EXPECT_EQ(values["timeline0.chassis"], 3);
+    EXPECT_EQ(values["timeline0.complete"], 1);
+    EXPECT_EQ(values["timeline0.slowest_chassis"], 1);
+    EXPECT_EQ(values["timeline0.slowest_ms"], 400);
+    EXPECT_EQ(values["timeline0.spread_ms"], 300);
+    EXPECT_EQ(values["timeline0.chassis2.transitioning_ms"], 10);
+    EXPECT_EQ(values["timeline0.chassis2.reached_ms"], 100);
+    EXPECT_FALSE(values.contains("timeline0.chassis1.transitioning_ms"));
+}
+
+TEST(TestChassisSMPTimeline, PublishesWallClockStart)
+{
+    TransitionTimelines timelines{2};
+    TransitionTimelines::Clock::time_point start{};
+    TransitionTimelines::WallClock::time_point wallStart{1700000000123ms};
+
+    timelines.start(1, chassis({1}), start, wallStart);
+    EXPECT_TRUE(timelines.reached(1, start + 20ms));
+
+    auto values = timelines.values();
+    EXPECT_EQ(values["timeline0.start_ms"], 1700000000123);
+    EXPECT_EQ(values["timeline0.chassis1.reached_ms"], 20);
+}
+
+TEST(TestChassisSMPTimeline, FailureCompletesTimeline)
+{
+    TransitionTimelines timelines{2};
+    TransitionTimelines::Clock::time_point start{};
+
+    timelines.start(1, chassis({1, 2}), start);
+    EXPECT_FALSE(timelines.reached(1, start + 50ms));
+    EXPECT_TRUE(timelines.failed(2, start + 80ms));
+
+    // Later changes don't alter a complete timeline
+    EXPECT_FALSE(timelines.reached(2, start + 900ms));
+
+    auto values = timelines.values();
+    EXPECT_EQ(values["timeline0.reached"], 1);
+    EXPECT_EQ(values["timeline0.failed"], 1);
+    EXPECT_EQ(values["timeline0.chassis2.failed_ms"], 80);
+    EXPECT_FALSE(values.contains("timeline0.chassis2.reached_ms"));
+    EXPECT_EQ(values["timeline0.slowest_chassis"], 1);
+}
+
+TEST(TestChassisSMPTimeline, IgnoresChassisOutsideTransition)
+{
+    TransitionTimelines timelines{2};
+    TransitionTimelines::Clock::time_point start{};
+
+    timelines.start(1, chassis({1}), start);
+    timelines.transitioning(2, start + 10ms);
+    EXPECT_FALSE(timelines.reached(2, start + 20ms));
+    EXPECT_FALSE(timelines.values().contains("timeline0.chassis2.reached_ms"));
+}
+
+TEST(TestChassisSMPTimeline, KeepsMostRecentTimelines)
+{
+    TransitionTimelines timelines{2};
+    TransitionTimelines::Clock::time_point start{};
+
+    for (uint64_t transition = 1; transition <= 3; ++transition)
+    {
+        timelines.start(transition, chassis({1}), start);
+    }
+
+    auto values = timelines.values();
+    EXPECT_EQ(values["timeline0.transition"], 3);
+    EXPECT_EQ(values["timeline1.transition"], 2);
+    EXPECT_FALSE(values.contains("timeline2.transition"));
+}
+
+} // namespace phosphor::state::manager
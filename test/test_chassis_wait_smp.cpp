@@ -5,10 +5,14 @@
 #include <sdbusplus/test/sdbus_mock.hpp>
 #include <sdeventplus/event.hpp>
 
+#include <stdexcept>
+
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
-using namespace phosphor::state::manager;
+namespace phosphor::state::manager
+{
+
 using namespace testing;
 
 class SMPChassisWaiterTest : public Test
@@ -37,6 +41,29 @@ class SMPChassisWaiterTest : public Test
             .WillRepeatedly(Return(0));
     }
 
+    // Put the waiter in the middle of a wait, without going through D-Bus
+    static void setWaitState(SMPChassisWaiter& waiter, ChassisSet<> present,
+                             ChassisSet<> poweredOn)
+    {
+        waiter.presentChassis = present;
+        waiter.poweredOnChassis = poweredOn;
+    }
+
+    static ChassisSet<> laggards(const SMPChassisWaiter& waiter)
+    {
+        return waiter.laggards();
+    }
+
+    static void expireDeadline(SMPChassisWaiter& waiter)
+    {
+        waiter.deadlineExpired();
+    }
+
+    static bool isDeadlineArmed(SMPChassisWaiter& waiter)
+    {
+        return waiter.deadlineTimer.isEnabled();
+    }
+
     // Helper to mock chassis Present property as true
     void mockChassisPresent(size_t /*chassisId*/, bool present)
     {
@@ -325,4 +352,98 @@ TEST_F(SMPChassisWaiterTest, TracksChassisStateCorrectly)
     EXPECT_NE(&waiter, nullptr);
 }
 
+// Test that waiter accepts a deadline
+TEST_F(SMPChassisWaiterTest, AcceptsDeadline)
+{
+    setupCommonMocks();
+    mockChassisPresent(1, true);
+    mockChassisPresent(2, true);
+
+    EXPECT_NO_THROW({
+        SMPChassisWaiter waiter(mockedBus, event, 2, 0, {},
+                                std::chrono::seconds{5});
+    });
+}
+
+// Test that the deadline doesn't delay the exit when nothing is waited for
+TEST_F(SMPChassisWaiterTest, ExitsSuccessfullyBeforeDeadline)
+{
+    setupCommonMocks();
+
+    // Nothing can be read, so no chassis is present
+    EXPECT_CALL(sdbusMock, sd_bus_call(_, _, _, _, _))
+        .WillRepeatedly(Return(-1));
+
+    SMPChassisWaiter waiter(mockedBus, event, 2, 0, {},
+                            std::chrono::seconds{3600});
+
+    EXPECT_EQ(waiter.run(), 0);
+    EXPECT_NE(SMPChassisWaiter::timeoutExitCode, 0);
+}
+
+// Test that only a non-zero timeout arms the deadline
+TEST_F(SMPChassisWaiterTest, ArmsDeadlineOnlyWithTimeout)
+{
+    setupCommonMocks();
+    EXPECT_CALL(sdbusMock, sd_bus_call(_, _, _, _, _))
+        .WillRepeatedly(Return(-1));
+
+    SMPChassisWaiter waiter(mockedBus, event, 2, 0, {},
+                            std::chrono::seconds{5});
+    EXPECT_TRUE(isDeadlineArmed(waiter));
+
+    SMPChassisWaiter forever(mockedBus, event, 2, 0, {},
+                             std::chrono::seconds{0});
+    EXPECT_FALSE(isDeadlineArmed(forever));
+}
+
+// Test that the chassis not powered on are the laggards at the deadline
+TEST_F(SMPChassisWaiterTest, LaggardsArePresentChassisNotOn)
+{
+    setupCommonMocks();
+    EXPECT_CALL(sdbusMock, sd_bus_call(_, _, _, _, _))
+        .WillRepeatedly(Return(-1));
+
+    SMPChassisWaiter waiter(mockedBus, event, 3);
+
+    // Chassis 1 and 3 are present, 1 and 2 are on
+    setWaitState(waiter, ChassisSet<>{0b1010}, ChassisSet<>{0b0110});
+    EXPECT_EQ(laggards(waiter), ChassisSet<>{0b1000});
+    EXPECT_EQ(chassisIdList(laggards(waiter)), "3");
+
+    setWaitState(waiter, ChassisSet<>{0b1110}, ChassisSet<>{});
+    EXPECT_EQ(chassisIdList(laggards(waiter)), "1,2,3");
+
+    setWaitState(waiter, ChassisSet<>{0b0110}, ChassisSet<>{0b0110});
+    EXPECT_TRUE(laggards(waiter).none());
+}
+
+// Test that the deadline ends the wait with the timeout exit code
+TEST_F(SMPChassisWaiterTest, DeadlineExitsWithTimeoutCode)
+{
+    setupCommonMocks();
+    EXPECT_CALL(sdbusMock, sd_bus_call(_, _, _, _, _))
+        .WillRepeatedly(Return(-1));
+
+    SMPChassisWaiter waiter(mockedBus, event, 2, 0, {},
+                            std::chrono::seconds{5});
+
+    // Chassis 2 is still off when the deadline passes, the exit code of
+    // the deadline replaces the one of the startup check
+    setWaitState(waiter, ChassisSet<>{0b110}, ChassisSet<>{0b010});
+    expireDeadline(waiter);
+
+    EXPECT_EQ(waiter.run(), SMPChassisWaiter::timeoutExitCode);
+}
+
+// Test that a host without any chassis to wait for is a configuration error
+TEST_F(SMPChassisWaiterTest, RejectsHostWithoutChassis)
+{
+    // Host 1 has no partition, so it has no chassis
+    EXPECT_THROW({ SMPChassisWaiter waiter(mockedBus, event, 2, 1); },
+                 std::invalid_argument);
+}
+
+} // namespace phosphor::state::manager
+
 // Made with Bob
@@ -0,0 +1,110 @@
+#include "hosted_instances.hpp"
+
+#include <sdeventplus/event.hpp>
+
+#include <cstddef>
+#include <cstdlib>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace phosphor::state::manager
+{
+
+/** @brief Stands for a chassis, counts the live instances */
+struct TestInstance
+{
+    explicit TestInstance(size_t& live) : live(live)
+    {
+        ++live;
+    }
+
+    ~TestInstance()
+    {
+        --live;
+    }
+
+    TestInstance(const TestInstance&) = delete;
+    TestInstance& operator=(const TestInstance&) = delete;
+    TestInstance(TestInstance&&) = delete;
+    TestInstance& operator=(TestInstance&&) = delete;
+
+    size_t& live;
+};
+
+class TestHostedInstances : public testing::Test
+{
+  public:
+    sdeventplus::Event event = sdeventplus::Event::get_new();
+
+    /** @brief Ids passed to the dropped callback */
+    std::vector<size_t> dropped;
+
+    /** @brief Number of live instances */
+    size_t live = 0;
+
+    HostedInstances<TestInstance> instances{
+        event, [this](size_t id) { dropped.push_back(id); }};
+
+    void host(size_t first, size_t last)
+    {
+        for (size_t id = first; id <= last; ++id)
+        {
+            instances.add(id, std::make_unique<TestInstance>(live));
+        }
+    }
+
+    /** @brief Dispatch the pending drop */
+    void dispatch()
+    {
+        event.run(std::nullopt);
+    }
+};
+
+TEST_F(TestHostedInstances, FailedInstanceLeavesOthersHosted)
+{
+    host(1, 3);
+
+    instances.failed(2);
+
+    // The instance is only dropped from the event loop
+    EXPECT_TRUE(instances.contains(2));
+    dispatch();
+
+    EXPECT_EQ(instances.ids(), (std::vector<size_t>{1, 3}));
+    EXPECT_EQ(dropped, std::vector<size_t>{2});
+    EXPECT_EQ(live, 2U);
+}
+
+TEST_F(TestHostedInstances, ExitsOnceNoInstanceIsLeft)
+{
+    host(1, 2);
+
+    instances.failed(1);
+    dispatch();
+    EXPECT_EQ(instances.ids(), std::vector<size_t>{2});
+
+    instances.failed(2);
+    EXPECT_EQ(event.loop(), EXIT_FAILURE);
+
+    EXPECT_TRUE(instances.empty());
+    EXPECT_EQ(dropped, (std::vector<size_t>{1, 2}));
+    EXPECT_EQ(live, 0U);
+}
+
+TEST_F(TestHostedInstances, FailuresInOneDispatchAreDroppedTogether)
+{
+    host(1, 3);
+
+    instances.failed(1);
+    instances.failed(3);
+    instances.failed(3);
+    dispatch();
+
+    EXPECT_EQ(instances.ids(), std::vector<size_t>{2});
+    EXPECT_EQ(dropped, (std::vector<size_t>{1, 3}));
+}
+
+} // namespace phosphor::state::manager
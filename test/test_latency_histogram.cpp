@@ -0,0 +1,101 @@
+#include "latency_histogram.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <string>
+
+#include <gtest/gtest.h>
+
+namespace phosphor::state::manager
+{
+
+using std::chrono::milliseconds;
+
+TEST(TestLatencyHistogram, EmptyHistogram)
+{
+    LatencyHistogram histogram;
+
+    EXPECT_EQ(histogram.count, 0U);
+    EXPECT_EQ(histogram.percentile(50), 0U);
+    EXPECT_EQ(histogram.percentile(99), 0U);
+}
+
+TEST(TestLatencyHistogram, Buckets)
+{
+    EXPECT_EQ(LatencyHistogram::bucket(0), 0U);
+    EXPECT_EQ(LatencyHistogram::bucket(1), 1U);
+    EXPECT_EQ(LatencyHistogram::bucket(2), 2U);
+    EXPECT_EQ(LatencyHistogram::bucket(3), 2U);
+    EXPECT_EQ(LatencyHistogram::bucket(4), 3U);
+    EXPECT_EQ(LatencyHistogram::bucket(1023), 10U);
+    EXPECT_EQ(LatencyHistogram::bucket(1024), 11U);
+    EXPECT_EQ(LatencyHistogram::bucket(UINT64_MAX),
+              LatencyHistogram::numBuckets - 1);
+}
+
+TEST(TestLatencyHistogram, RecordTracksMinMax)
+{
+    LatencyHistogram histogram;
+
+    histogram.record(milliseconds(300));
+    histogram.record(milliseconds(20));
+    histogram.record(milliseconds(5000));
+
+    EXPECT_EQ(histogram.count, 3U);
+    EXPECT_EQ(histogram.minMs, 20U);
+    EXPECT_EQ(histogram.maxMs, 5000U);
+    EXPECT_EQ(histogram.buckets[LatencyHistogram::bucket(20)], 1U);
+    EXPECT_EQ(histogram.buckets[LatencyHistogram::bucket(300)], 1U);
+    EXPECT_EQ(histogram.buckets[LatencyHistogram::bucket(5000)], 1U);
+}
+
+TEST(TestLatencyHistogram, NegativeLatencyIsZero)
+{
+    LatencyHistogram histogram;
+
+    histogram.record(milliseconds(-5));
+
+    EXPECT_EQ(histogram.minMs, 0U);
+    EXPECT_EQ(histogram.buckets[0], 1U);
+}
+
+TEST(TestLatencyHistogram, Percentiles)
+{
+    LatencyHistogram histogram;
+
+    // 90 fast transitions and 10 slow ones
+    for (int i = 0; i < 90; ++i)
+    {
+        histogram.record(milliseconds(100));
+    }
+    for (int i = 0; i < 10; ++i)
+    {
+        histogram.record(milliseconds(10000));
+    }
+
+    // Estimated as the upper bound of the bucket
+    EXPECT_EQ(histogram.percentile(50), 127U);
+    EXPECT_EQ(histogram.percentile(90), 127U);
+    // Clamped to the highest latency seen
+    EXPECT_EQ(histogram.percentile(99), 10000U);
+}
+
+TEST(TestLatencyHistogram, AddValues)
+{
+    LatencyHistogram histogram;
+    histogram.record(milliseconds(100));
+    histogram.record(milliseconds(200));
+
+    std::map<std::string, uint64_t> values;
+    histogram.addValues(values, "On");
+
+    EXPECT_EQ(values["On.count"], 2U);
+    EXPECT_EQ(values["On.min_ms"], 100U);
+    EXPECT_EQ(values["On.max_ms"], 200U);
+    EXPECT_EQ(values["On.lt_128_ms"], 1U);
+    EXPECT_EQ(values["On.lt_256_ms"], 1U);
+    EXPECT_FALSE(values.contains("On.lt_64_ms"));
+}
+
+} // namespace phosphor::state::manager
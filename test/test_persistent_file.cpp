@@ -0,0 +1,147 @@
+#include "persistent_file.hpp"
+
+#include <sdbusplus/test/sdbus_mock.hpp>
+#include <sdeventplus/event.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+
+#include <gtest/gtest.h>
+
+namespace phosphor::state::manager
+{
+
+using namespace std::chrono_literals;
+
+class TestPersistentFile : public testing::Test
+{
+  public:
+    sdeventplus::Event event = sdeventplus::Event::get_default();
+    fs::path dir;
+    fs::path path;
+    uint32_t value = 1;
+
+    TestPersistentFile()
+    {
+        char tmpl[] = "/tmp/test_persistent_file-XXXXXX";
+        dir = mkdtemp(tmpl);
+        path = dir / "data.journal";
+    }
+
+    ~TestPersistentFile() override
+    {
+        fs::remove_all(dir);
+    }
+
+    PersistentFile<uint32_t>::Serializer serializer()
+    {
+        return [this]() { return value; };
+    }
+
+    uint32_t read()
+    {
+        PersistentFile<uint32_t> file(event, path, 1, serializer(), 0ms);
+        uint32_t restored = 0;
+        EXPECT_TRUE(file.restore(restored));
+        return restored;
+    }
+};
+
+TEST_F(TestPersistentFile, writesEveryUpdateWithoutWindow)
+{
+    PersistentFile<uint32_t> file(event, path, 1, serializer(), 0ms);
+
+    file.update();
+    EXPECT_EQ(read(), 1U);
+
+    value = 2;
+    file.update();
+    EXPECT_EQ(read(), 2U);
+
+    EXPECT_EQ(file.requests(), 2U);
+    EXPECT_EQ(file.writes(), 2U);
+}
+
+TEST_F(TestPersistentFile, coalescesUpdatesInWindow)
+{
+    PersistentFile<uint32_t> file(event, path, 1, serializer(), 1h);
+
+    for (uint32_t i = 0; i < 10; i++)
+    {
+        value = i;
+        file.update();
+    }
+    EXPECT_FALSE(fs::exists(path));
+    EXPECT_EQ(file.requests(), 10U);
+    EXPECT_EQ(file.writes(), 0U);
+
+    file.flush();
+    EXPECT_EQ(read(), 9U);
+    EXPECT_EQ(file.writes(), 1U);
+
+    // Nothing pending so nothing to write
+    file.flush();
+    EXPECT_EQ(file.writes(), 1U);
+}
+
+TEST_F(TestPersistentFile, writesWhenWindowExpires)
+{
+    PersistentFile<uint32_t> file(event, path, 1, serializer(), 1ms);
+
+    file.update();
+    file.update();
+    for (int i = 0; (i < 100) && (file.writes() == 0); i++)
+    {
+        event.run(10ms);
+    }
+
+    EXPECT_EQ(read(), 1U);
+    EXPECT_EQ(file.requests(), 2U);
+    EXPECT_EQ(file.writes(), 1U);
+}
+
+TEST_F(TestPersistentFile, flushesOnDestruction)
+{
+    {
+        PersistentFile<uint32_t> file(event, path, 1, serializer(), 1h);
+        file.update();
+        EXPECT_FALSE(fs::exists(path));
+    }
+    EXPECT_EQ(read(), 1U);
+}
+
+TEST_F(TestPersistentFile, storeReplacesPendingUpdate)
+{
+    PersistentFile<uint32_t> file(event, path, 1, serializer(), 1h);
+
+    file.update();
+    file.store(42);
+    EXPECT_EQ(read(), 42U);
+
+    // The pending update was dropped, so destruction writes nothing
+    EXPECT_EQ(file.writes(), 1U);
+}
+
+TEST_F(TestPersistentFile, publishesCounts)
+{
+    sdbusplus::SdBusMock sdbusMock;
+    auto bus = sdbusplus::get_mocked_new(&sdbusMock);
+    utils::StatisticsInterface statistics(bus, "/test",
+                                          utils::PERSIST_STATISTICS_INTERFACE);
+
+    PersistentFile<uint32_t> file(event, path, 1, serializer(), 1h);
+    file.update();
+    file.publishTo(statistics);
+    EXPECT_EQ(statistics.values().at("data.journal.requests"), 1U);
+    EXPECT_EQ(statistics.values().at("data.journal.writes"), 0U);
+
+    file.update();
+    EXPECT_EQ(statistics.values().at("data.journal.requests"), 2U);
+
+    file.flush();
+    EXPECT_EQ(statistics.values().at("data.journal.writes"), 1U);
+}
+
+} // namespace phosphor::state::manager
@@ -0,0 +1,211 @@
+#include "power_on_time.hpp"
+
+#include <cereal/archives/json.hpp>
+#include <sdeventplus/event.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace phosphor::state::manager
+{
+
+using namespace std::chrono_literals;
+
+class TestPowerOnTime : public testing::Test
+{
+  public:
+    sdeventplus::Event event = sdeventplus::Event::get_default();
+    fs::path dir;
+    fs::path path;
+    fs::path legacyPath;
+    std::chrono::steady_clock::time_point fakeNow{};
+    std::vector<uint32_t> reported;
+
+    TestPowerOnTime()
+    {
+        char tmpl[] = "/tmp/test_power_on_time-XXXXXX";
+        dir = mkdtemp(tmpl);
+        path = dir / "POHSeconds";
+        legacyPath = dir / "POHCounter";
+    }
+
+    ~TestPowerOnTime() override
+    {
+        fs::remove_all(dir);
+    }
+
+    std::unique_ptr<PowerOnTime> make(
+        std::chrono::milliseconds interval = 1h,
+        std::chrono::milliseconds window = 1h)
+    {
+        return std::make_unique<PowerOnTime>(
+            event, path, interval, window,
+            [this](uint32_t hours) { reported.push_back(hours); },
+            [this]() { return fakeNow; });
+    }
+
+    // The persisted record is a single count of seconds
+    PersistentFile<uint64_t> persisted()
+    {
+        return {event, path, 1, []() { return uint64_t{0}; }, 0ms};
+    }
+
+    std::optional<uint64_t> read()
+    {
+        uint64_t seconds = 0;
+        if (!persisted().restore(seconds))
+        {
+            return std::nullopt;
+        }
+        return seconds;
+    }
+
+    void writeLegacy(uint32_t hours)
+    {
+        std::ofstream os(legacyPath.c_str(), std::ios::binary);
+        cereal::JSONOutputArchive oarchive(os);
+        oarchive(hours);
+    }
+};
+
+TEST_F(TestPowerOnTime, accountsPowerOnPeriods)
+{
+    auto poh = make();
+    poh->restore(legacyPath, false);
+    EXPECT_EQ(reported, std::vector<uint32_t>{0});
+
+    poh->powerChanged(true);
+    fakeNow += 90min;
+    EXPECT_EQ(poh->totalSeconds(), 5400U);
+    EXPECT_EQ(poh->hours(), 1U);
+
+    // Time powered off doesn't count
+    poh->powerChanged(false);
+    fakeNow += 1h;
+    EXPECT_EQ(poh->totalSeconds(), 5400U);
+
+    poh->powerChanged(true);
+    fakeNow += 30min;
+    EXPECT_EQ(poh->totalSeconds(), 7200U);
+
+    // The hours are reported at the power off checkpoint
+    EXPECT_EQ(reported, (std::vector<uint32_t>{0, 1}));
+}
+
+TEST_F(TestPowerOnTime, resetsTheHours)
+{
+    auto poh = make();
+    poh->restore(legacyPath, true);
+    fakeNow += 30min;
+
+    poh->reset(3);
+    EXPECT_EQ(poh->totalSeconds(), 10800U);
+    EXPECT_EQ(reported, (std::vector<uint32_t>{0, 3}));
+
+    fakeNow += 1h;
+    EXPECT_EQ(poh->hours(), 4U);
+}
+
+TEST_F(TestPowerOnTime, checkpointsWhilePoweredOn)
+{
+    auto poh = make(1ms, 0ms);
+    poh->restore(legacyPath, true);
+    fakeNow += 2h;
+
+    for (int i = 0; (i < 100) && (reported.back() != 2); i++)
+    {
+        event.run(10ms);
+    }
+
+    EXPECT_EQ(reported.back(), 2U);
+    EXPECT_EQ(read(), 7200U);
+}
+
+TEST_F(TestPowerOnTime, noCheckpointWhilePoweredOff)
+{
+    auto poh = make(1ms, 0ms);
+    poh->restore(legacyPath, false);
+
+    for (int i = 0; i < 5; i++)
+    {
+        event.run(10ms);
+    }
+
+    EXPECT_FALSE(fs::exists(path));
+    EXPECT_EQ(reported, std::vector<uint32_t>{0});
+}
+
+TEST_F(TestPowerOnTime, restoresPersistedTime)
+{
+    persisted().store(7230);
+
+    auto poh = make();
+    poh->restore(legacyPath, false);
+    EXPECT_EQ(poh->totalSeconds(), 7230U);
+    EXPECT_EQ(reported, std::vector<uint32_t>{2});
+}
+
+TEST_F(TestPowerOnTime, persistedTimeWinsOverLegacyCounter)
+{
+    persisted().store(60);
+    writeLegacy(5);
+
+    auto poh = make();
+    poh->restore(legacyPath, false);
+    EXPECT_EQ(poh->totalSeconds(), 60U);
+}
+
+TEST_F(TestPowerOnTime, migratesLegacyHourCounter)
+{
+    writeLegacy(5);
+
+    auto poh = make();
+    poh->restore(legacyPath, false);
+    EXPECT_EQ(poh->totalSeconds(), 18000U);
+    EXPECT_EQ(read(), 18000U);
+    EXPECT_FALSE(fs::exists(legacyPath));
+}
+
+TEST_F(TestPowerOnTime, dropsCorruptLegacyCounter)
+{
+    std::ofstream(legacyPath) << "not json";
+
+    auto poh = make();
+    poh->restore(legacyPath, false);
+    EXPECT_EQ(poh->totalSeconds(), 0U);
+    EXPECT_FALSE(fs::exists(legacyPath));
+}
+
+TEST_F(TestPowerOnTime, storesOnDestruction)
+{
+    {
+        auto poh = make();
+        poh->restore(legacyPath, true);
+        fakeNow += 10s;
+
+        // Nothing written within the window yet
+        EXPECT_FALSE(fs::exists(path));
+    }
+    EXPECT_EQ(read(), 10U);
+}
+
+TEST_F(TestPowerOnTime, storesNothingBeforeRestore)
+{
+    {
+        auto poh = make();
+        poh->powerChanged(true);
+        fakeNow += 1h;
+        poh->powerChanged(false);
+    }
+    EXPECT_FALSE(fs::exists(path));
+}
+
+} // namespace phosphor::state::manager
@@ -0,0 +1,75 @@
+#include "../power_supply_signals.hpp"
+
+#include <sdbusplus/test/sdbus_mock.hpp>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+using namespace phosphor::state::manager;
+using namespace testing;
+
+class PowerSupplySignalsTest : public Test
+{
+  public:
+    sdbusplus::SdBusMock sdbusMock;
+    sdbusplus::bus_t mockedBus = sdbusplus::get_mocked_new(&sdbusMock);
+
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    sd_bus_slot* mockSlot = reinterpret_cast<sd_bus_slot*>(0x1);
+
+    void SetUp() override
+    {
+        EXPECT_CALL(sdbusMock, sd_bus_slot_unref(_))
+            .WillRepeatedly(Return(nullptr));
+    }
+};
+
+TEST_F(PowerSupplySignalsTest, SharesOneSetOfMatches)
+{
+    // Three matches on the common root, however many chassis subscribe
+    EXPECT_CALL(sdbusMock,
+                sd_bus_add_match(
+                    _, _,
+                    HasSubstr("/xyz/openbmc_project/power/power_supplies"), _,
+                    _))
+        .Times(3)
+        .WillRepeatedly(DoAll(SetArgPointee<1>(mockSlot), Return(0)));
+
+    auto first = PowerSupplySignals::shared(mockedBus);
+    auto second = PowerSupplySignals::shared(mockedBus);
+    EXPECT_EQ(first, second);
+
+    first->subscribe(1, {});
+    second->subscribe(2, {});
+}
+
+TEST_F(PowerSupplySignalsTest, ChassisOfPath)
+{
+    EXPECT_EQ(PowerSupplySignals::chassisOf(
+                  "/xyz/openbmc_project/power/power_supplies/chassis0/psus"),
+              0);
+    EXPECT_EQ(
+        PowerSupplySignals::chassisOf(
+            "/xyz/openbmc_project/power/power_supplies/chassis12/psus/psu0"),
+        12);
+}
+
+TEST_F(PowerSupplySignalsTest, PathsOutsideAChassisSubtree)
+{
+    EXPECT_EQ(PowerSupplySignals::chassisOf(
+                  "/xyz/openbmc_project/power/power_supplies"),
+              std::nullopt);
+    EXPECT_EQ(PowerSupplySignals::chassisOf(
+                  "/xyz/openbmc_project/power/power_supplies/chassis/psus"),
+              std::nullopt);
+    EXPECT_EQ(PowerSupplySignals::chassisOf(
+                  "/xyz/openbmc_project/power/power_supplies/chassis1/fans"),
+              std::nullopt);
+    EXPECT_EQ(
+        PowerSupplySignals::chassisOf(
+            "/xyz/openbmc_project/power/power_supplies/chassis1/psus2/psu0"),
+        std::nullopt);
+    EXPECT_EQ(PowerSupplySignals::chassisOf(
+                  "/xyz/openbmc_project/inventory/chassis1/psus/psu0"),
+              std::nullopt);
+}
@@ -0,0 +1,144 @@
+#include "state_journal.hpp"
+
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <span>
+
+#include <gtest/gtest.h>
+
+namespace phosphor::state::manager
+{
+
+struct TestRecord
+{
+    uint64_t value;
+    FixedString<24> name;
+};
+
+class TestStateJournal : public testing::Test
+{
+  public:
+    fs::path dir;
+    fs::path path;
+
+    TestStateJournal()
+    {
+        char tmpl[] = "/tmp/test_state_journal-XXXXXX";
+        dir = mkdtemp(tmpl);
+        path = dir / "state.journal";
+    }
+
+    ~TestStateJournal() override
+    {
+        fs::remove_all(dir);
+    }
+
+    static bool restore(StateJournal& journal, TestRecord& record)
+    {
+        return journal.restore(std::as_writable_bytes(std::span(&record, 1)));
+    }
+
+    static bool append(StateJournal& journal, const TestRecord& record)
+    {
+        return journal.append(std::as_bytes(std::span(&record, 1)));
+    }
+};
+
+TEST_F(TestStateJournal, restoreWithoutFile)
+{
+    StateJournal journal(path, 1, sizeof(TestRecord));
+    TestRecord record{};
+    EXPECT_FALSE(restore(journal, record));
+    EXPECT_FALSE(fs::exists(path));
+}
+
+TEST_F(TestStateJournal, restoresLatestRecord)
+{
+    {
+        StateJournal journal(path, 1, sizeof(TestRecord), 4);
+        for (uint64_t i = 1; i <= 10; i++)
+        {
+            EXPECT_TRUE(append(journal, {i, FixedString<24>("record")}));
+        }
+    }
+
+    StateJournal journal(path, 1, sizeof(TestRecord), 4);
+    TestRecord record{};
+    ASSERT_TRUE(restore(journal, record));
+    EXPECT_EQ(record.value, 10U);
+    EXPECT_EQ(record.name.str(), "record");
+
+    // Appending continues after the restored record
+    EXPECT_TRUE(append(journal, {11, FixedString<24>("next")}));
+    StateJournal reread(path, 1, sizeof(TestRecord), 4);
+    ASSERT_TRUE(restore(reread, record));
+    EXPECT_EQ(record.value, 11U);
+    EXPECT_EQ(record.name.str(), "next");
+}
+
+TEST_F(TestStateJournal, fileSizeIsBounded)
+{
+    StateJournal journal(path, 1, sizeof(TestRecord), 4);
+    for (uint64_t i = 1; i <= 5; i++)
+    {
+        EXPECT_TRUE(append(journal, {i, FixedString<24>("record")}));
+    }
+    auto size = fs::file_size(path);
+
+    for (uint64_t i = 6; i <= 50; i++)
+    {
+        EXPECT_TRUE(append(journal, {i, FixedString<24>("record")}));
+    }
+    EXPECT_EQ(fs::file_size(path), size);
+}
+
+TEST_F(TestStateJournal, skipsCorruptRecord)
+{
+    {
+        StateJournal journal(path, 1, sizeof(TestRecord), 4);
+        EXPECT_TRUE(append(journal, {1, FixedString<24>("first")}));
+        EXPECT_TRUE(append(journal, {2, FixedString<24>("second")}));
+    }
+
+    // Corrupt the payload of the second record, in slot 1 after the 32 byte
+    // header. Records are the sequence, payload and CRC padded to 8 bytes.
+    constexpr size_t recordSize = (8 + sizeof(TestRecord) + 4 + 7) & ~7UL;
+    {
+        std::fstream f(path, std::ios::in | std::ios::out | std::ios::binary);
+        f.seekp(32 + recordSize + 12);
+        f.put('X');
+    }
+
+    StateJournal journal(path, 1, sizeof(TestRecord), 4);
+    TestRecord record{};
+    ASSERT_TRUE(restore(journal, record));
+    EXPECT_EQ(record.value, 1U);
+    EXPECT_EQ(record.name.str(), "first");
+}
+
+TEST_F(TestStateJournal, ignoresOtherPayloadVersion)
+{
+    {
+        StateJournal journal(path, 1, sizeof(TestRecord));
+        EXPECT_TRUE(append(journal, {1, FixedString<24>("v1")}));
+    }
+
+    StateJournal journal(path, 2, sizeof(TestRecord));
+    TestRecord record{};
+    EXPECT_FALSE(restore(journal, record));
+
+    // The first append replaces the old file
+    EXPECT_TRUE(append(journal, {2, FixedString<24>("v2")}));
+    ASSERT_TRUE(restore(journal, record));
+    EXPECT_EQ(record.value, 2U);
+}
+
+TEST_F(TestStateJournal, fixedStringTruncates)
+{
+    FixedString<4> str("abcdef");
+    EXPECT_EQ(str.str(), "abc");
+}
+
+} // namespace phosphor::state::manager
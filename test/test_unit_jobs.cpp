@@ -0,0 +1,64 @@
+#include "utils.hpp"
+
+#include <gtest/gtest.h>
+
+namespace phosphor::state::manager::utils
+{
+
+constexpr auto unit = "obmc-chassis-poweron@0.target";
+constexpr auto job = "/org/freedesktop/systemd1/job/42";
+
+TEST(UnitJobs, ReportsResultOfQueuedJob)
+{
+    UnitJobs jobs;
+    jobs.queued(unit, job);
+    EXPECT_TRUE(jobs.pending(unit));
+
+    auto result = jobs.removed(unit, job, "failed");
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(*result, "failed");
+    EXPECT_FALSE(jobs.pending(unit));
+
+    // Each job is only reported once
+    EXPECT_FALSE(jobs.removed(unit, job, "failed").has_value());
+}
+
+TEST(UnitJobs, IgnoresJobsQueuedByOthers)
+{
+    UnitJobs jobs;
+    jobs.queued(unit, job);
+
+    EXPECT_FALSE(
+        jobs.removed(unit, "/org/freedesktop/systemd1/job/7", "done")
+            .has_value());
+    EXPECT_FALSE(jobs.removed("obmc-chassis-poweroff@0.target", job, "done")
+                     .has_value());
+    EXPECT_TRUE(jobs.pending(unit));
+}
+
+TEST(UnitJobs, NewerJobReplacesOlder)
+{
+    UnitJobs jobs;
+    jobs.queued(unit, job);
+    jobs.queued(unit, "/org/freedesktop/systemd1/job/43");
+
+    // The replaced job is canceled by systemd, that isn't our outcome
+    EXPECT_FALSE(jobs.removed(unit, job, "canceled").has_value());
+
+    auto result =
+        jobs.removed(unit, "/org/freedesktop/systemd1/job/43", "done");
+    ASSERT_TRUE(result.has_value());
+    EXPECT_TRUE(UnitJobs::succeeded(*result));
+}
+
+TEST(UnitJobs, OnlyDoneSucceeds)
+{
+    EXPECT_TRUE(UnitJobs::succeeded("done"));
+    for (const auto* result :
+         {"canceled", "timeout", "failed", "dependency", "skipped"})
+    {
+        EXPECT_FALSE(UnitJobs::succeeded(result)) << result;
+    }
+}
+
+} // namespace phosphor::state::manager::utils
@@ -0,0 +1,105 @@
+#include "../upower_devices.hpp"
+
+#include <sdbusplus/test/sdbus_mock.hpp>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+using namespace phosphor::state::manager;
+using namespace testing;
+
+class UPowerDevicesTest : public Test
+{
+  public:
+    sdbusplus::SdBusMock sdbusMock;
+    sdbusplus::bus_t mockedBus = sdbusplus::get_mocked_new(&sdbusMock);
+
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    sd_bus_slot* mockSlot = reinterpret_cast<sd_bus_slot*>(0x1);
+
+    void SetUp() override
+    {
+        EXPECT_CALL(sdbusMock, sd_bus_add_match(_, _, _, _, _))
+            .WillRepeatedly(DoAll(SetArgPointee<1>(mockSlot), Return(0)));
+        EXPECT_CALL(sdbusMock, sd_bus_slot_unref(_))
+            .WillRepeatedly(Return(nullptr));
+    }
+
+    // A present UPS that is still charging
+    static PowerInputProperties chargingUPS()
+    {
+        return {{"Type", uint{3}},
+                {"IsPresent", true},
+                {"State", uint{1}},
+                {"BatteryLevel", uint{8}}};
+    }
+};
+
+TEST_F(UPowerDevicesTest, MatchesUPowerDeviceSignals)
+{
+    // UPower announces devices with its own signals, not the ObjectManager
+    // ones
+    EXPECT_CALL(sdbusMock,
+                sd_bus_add_match(
+                    _, _,
+                    AllOf(HasSubstr("interface='org.freedesktop.UPower'"),
+                          HasSubstr("member='DeviceAdded'")),
+                    _, _))
+        .WillOnce(DoAll(SetArgPointee<1>(mockSlot), Return(0)));
+    EXPECT_CALL(sdbusMock,
+                sd_bus_add_match(
+                    _, _,
+                    AllOf(HasSubstr("interface='org.freedesktop.UPower'"),
+                          HasSubstr("member='DeviceRemoved'")),
+                    _, _))
+        .WillOnce(DoAll(SetArgPointee<1>(mockSlot), Return(0)));
+    EXPECT_CALL(sdbusMock,
+                sd_bus_add_match(_, _, HasSubstr("member='InterfacesAdded'"),
+                                 _, _))
+        .Times(0);
+    EXPECT_CALL(sdbusMock,
+                sd_bus_add_match(_, _,
+                                 HasSubstr("member='InterfacesRemoved'"), _, _))
+        .Times(0);
+
+    UPowerDevices devices(mockedBus);
+}
+
+TEST_F(UPowerDevicesTest, CountsDegradedUPS)
+{
+    UPowerDevices devices(mockedBus);
+    const std::string path = "/org/freedesktop/UPower/devices/ups_hiddev0";
+
+    devices.update(path, chargingUPS());
+    EXPECT_EQ(devices.degradedCount(), 1);
+
+    // Only the changed properties are reported after that
+    devices.update(path, {{"State", uint{4}}});
+    EXPECT_EQ(devices.degradedCount(), 0);
+
+    devices.update(path, {{"BatteryLevel", uint{3}}});
+    EXPECT_EQ(devices.degradedCount(), 1);
+}
+
+TEST_F(UPowerDevicesTest, IgnoresDevicesOtherThanUPS)
+{
+    UPowerDevices devices(mockedBus);
+
+    auto battery = chargingUPS();
+    battery["Type"] = uint{2};
+    devices.update("/org/freedesktop/UPower/devices/battery_BAT0", battery);
+    EXPECT_EQ(devices.degradedCount(), 0);
+}
+
+TEST_F(UPowerDevicesTest, RemovedUPSNoLongerDegrades)
+{
+    UPowerDevices devices(mockedBus);
+    const std::string path = "/org/freedesktop/UPower/devices/ups_hiddev0";
+
+    devices.update(path, chargingUPS());
+    ASSERT_EQ(devices.degradedCount(), 1);
+
+    EXPECT_TRUE(devices.remove(path));
+    EXPECT_EQ(devices.degradedCount(), 0);
+    EXPECT_FALSE(devices.remove(path));
+}
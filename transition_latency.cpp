@@ -0,0 +1,145 @@
+#include "config.h"
+
+#include "transition_latency.hpp"
+
+#include <phosphor-logging/lg2.hpp>
+
+namespace phosphor::state::manager
+{
+
+PHOSPHOR_LOG2_USING;
+
+TransitionLatency::TransitionLatency(sdbusplus::bus_t& bus,
+                                     const sdeventplus::Event& event,
+                                     const std::string& objPath,
+                                     const fs::path& path) :
+    persistFile(
+        event, path, persistVersion, [this]() { return histograms; },
+        std::chrono::milliseconds(PERSIST_WRITE_WINDOW_MS)),
+    statistics(bus, objPath, TRANSITION_LATENCY_INTERFACE)
+{
+    if (!persistFile.restore(histograms))
+    {
+        histograms = {};
+    }
+    publish();
+}
+
+std::string TransitionLatency::shortName(const std::string& transition)
+{
+    auto pos = transition.rfind('.');
+    return (pos == std::string::npos) ? transition : transition.substr(pos + 1);
+}
+
+LatencyHistogram* TransitionLatency::histogram(const std::string& name)
+{
+    for (auto& entry : histograms)
+    {
+        if (entry.name.str() == name)
+        {
+            return &entry.histogram;
+        }
+    }
+
+    for (auto& entry : histograms)
+    {
+        if (entry.name.str().empty())
+        {
+            entry.name = FixedString<48>(name);
+            return &entry.histogram;
+        }
+    }
+
+    error("No room for the latency of transition {TRANSITION}", "TRANSITION",
+          name);
+    return nullptr;
+}
+
+void TransitionLatency::start(const std::string& transition)
+{
+    if (pending)
+    {
+        debug("Transition {TRANSITION} replaced by {NEW} before completing",
+              "TRANSITION", pending->transition, "NEW", transition);
+    }
+    pending.emplace(transition, std::chrono::steady_clock::now());
+}
+
+void TransitionLatency::complete(const std::string& transition)
+{
+    if (pending && (pending->transition == transition))
+    {
+        record();
+    }
+}
+
+void TransitionLatency::departed()
+{
+    if (pending)
+    {
+        pending->departed = true;
+    }
+}
+
+void TransitionLatency::completeCycle(const std::string& transition)
+{
+    if (!pending || (pending->transition != transition))
+    {
+        return;
+    }
+
+    if (!pending->departed)
+    {
+        debug("Transition {TRANSITION} never left its state, not recorded",
+              "TRANSITION", transition);
+        pending.reset();
+        return;
+    }
+    record();
+}
+
+void TransitionLatency::cancel(const std::string& transition)
+{
+    if (pending && (pending->transition == transition))
+    {
+        debug("Transition {TRANSITION} dropped without completing",
+              "TRANSITION", transition);
+        pending.reset();
+    }
+}
+
+void TransitionLatency::record()
+{
+    auto latency = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - pending->requested);
+    auto name = shortName(pending->transition);
+    pending.reset();
+
+    auto* entry = histogram(name);
+    if (entry == nullptr)
+    {
+        return;
+    }
+
+    entry->record(latency);
+    info("Transition {TRANSITION} took {LATENCY_MS} ms", "TRANSITION", name,
+         "LATENCY_MS", latency.count());
+
+    persistFile.update();
+    publish();
+}
+
+void TransitionLatency::publish()
+{
+    utils::StatisticsInterface::Values values;
+    for (const auto& entry : histograms)
+    {
+        if (!entry.name.str().empty())
+        {
+            entry.histogram.addValues(values, entry.name.str());
+        }
+    }
+    statistics.set(std::move(values));
+}
+
+} // namespace phosphor::state::manager
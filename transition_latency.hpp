@@ -0,0 +1,154 @@
+#pragma once
+
+#include "latency_histogram.hpp"
+#include "persistent_file.hpp"
+#include "state_journal.hpp"
+#include "statistics.hpp"
+
+#include <sdbusplus/bus.hpp>
+#include <sdeventplus/event.hpp>
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <optional>
+#include <string>
+
+namespace phosphor::state::manager
+{
+
+/** @brief Interface exposing the transition latencies of an object */
+constexpr auto TRANSITION_LATENCY_INTERFACE =
+    "phosphor.state_manager.Debug.TransitionLatency";
+
+/** @class TransitionLatency
+ *  @brief Latency histograms of the transitions of a state object
+ *  @details The latency of a transition runs from its request to the systemd
+ *  job signalling it is done. One histogram is kept per transition type.
+ *  They are persisted and published on TRANSITION_LATENCY_INTERFACE. The
+ *  transition in progress is not persisted, one interrupted by a restart of
+ *  the service is not recorded.
+ */
+class TransitionLatency
+{
+  public:
+    /** @brief Most transition types tracked */
+    static constexpr size_t maxTransitions = 8;
+
+    TransitionLatency() = delete;
+    TransitionLatency(const TransitionLatency&) = delete;
+    TransitionLatency& operator=(const TransitionLatency&) = delete;
+    TransitionLatency(TransitionLatency&&) = delete;
+    TransitionLatency& operator=(TransitionLatency&&) = delete;
+    ~TransitionLatency() = default;
+
+    /** @brief Restores the histograms and publishes them
+     *
+     * @param[in] bus        - The Dbus bus object
+     * @param[in] event      - The event loop running the persist timer
+     * @param[in] objPath    - Object path to publish the histograms on
+     * @param[in] path       - Path of the persisted histograms
+     */
+    TransitionLatency(sdbusplus::bus_t& bus, const sdeventplus::Event& event,
+                      const std::string& objPath, const fs::path& path);
+
+    /** @brief Record that a transition was requested
+     *
+     * Replaces any transition that didn't complete yet.
+     *
+     * @param[in] transition - The transition, as sent on D-Bus
+     */
+    void start(const std::string& transition);
+
+    /** @brief Record that a transition completed
+     *
+     * Nothing is recorded unless this transition is the one in progress.
+     *
+     * @param[in] transition - The transition, as sent on D-Bus
+     */
+    void complete(const std::string& transition);
+
+    /** @brief Record that the transition in progress left the state it was
+     *  requested from
+     */
+    void departed();
+
+    /** @brief Record that a transition back to the state it was requested
+     *  from completed
+     *
+     * Like complete(), but the sample is discarded unless the transition
+     * departed() on the way, as reaching the state again says nothing then.
+     *
+     * @param[in] transition - The transition, as sent on D-Bus
+     */
+    void completeCycle(const std::string& transition);
+
+    /** @brief Drop a transition that won't complete without recording it
+     *
+     * Nothing is dropped unless this transition is the one in progress.
+     *
+     * @param[in] transition - The transition, as sent on D-Bus
+     */
+    void cancel(const std::string& transition);
+
+    /** @brief Publish the update and write counts of the persisted histograms
+     *
+     * @param[in] persistStatistics - Interface to publish on, must outlive
+     *                                this
+     */
+    void publishWritesTo(utils::StatisticsInterface& persistStatistics)
+    {
+        persistFile.publishTo(persistStatistics);
+    }
+
+  private:
+    /** @brief A transition in progress */
+    struct Pending
+    {
+        std::string transition;
+        std::chrono::steady_clock::time_point requested;
+        bool departed = false;
+    };
+
+    /** @brief Histogram of one transition type */
+    struct Entry
+    {
+        FixedString<48> name;
+        LatencyHistogram histogram;
+    };
+
+    /** @brief The persisted histograms, unused entries have no name */
+    using Payload = std::array<Entry, maxTransitions>;
+
+    /** @brief Version of the Payload layout */
+    static constexpr uint32_t persistVersion = 1;
+
+    /** @brief Name of a transition without its enum namespace */
+    static std::string shortName(const std::string& transition);
+
+    /** @brief Find the histogram of a transition, adding it if needed
+     *
+     * @return The histogram, nullptr if there is no room for it
+     */
+    LatencyHistogram* histogram(const std::string& name);
+
+    /** @brief Record the latency of the transition in progress */
+    void record();
+
+    /** @brief Publish the histograms on D-Bus */
+    void publish();
+
+    /** @brief The histograms */
+    Payload histograms{};
+
+    /** @brief Transition in progress, only kept in memory */
+    std::optional<Pending> pending;
+
+    /** @brief The persisted histograms */
+    PersistentFile<Payload> persistFile;
+
+    /** @brief The published histograms */
+    utils::StatisticsInterface statistics;
+};
+
+} // namespace phosphor::state::manager
@@ -0,0 +1,291 @@
+#include "upower_devices.hpp"
+
+#include "utils.hpp"
+
+#include <org/freedesktop/UPower/Device/client.hpp>
+#include <phosphor-logging/lg2.hpp>
+#include <sdbusplus/exception.hpp>
+
+namespace phosphor::state::manager
+{
+
+PHOSPHOR_LOG2_USING;
+
+using UPowerDevice = sdbusplus::client::org::freedesktop::u_power::Device<>;
+
+// Details at https://upower.freedesktop.org/docs/Device.html
+constexpr uint TYPE_UPS = 3;
+constexpr uint STATE_FULLY_CHARGED = 4;
+constexpr uint BATTERY_LVL_FULL = 8;
+
+UPowerDevices::UPowerDevices(sdbusplus::bus_t& bus) :
+    bus(bus),
+    propChangedSignal(bus,
+                      sdbusplus::match_rules::propertiesChangedNamespace(
+                          UPOWER_ROOT_PATH, UPowerDevice::interface),
+                      [this](auto& msg) { propertiesChanged(msg); }),
+    addedSignal(bus,
+                sdbusplus::match_rules::type::signal() +
+                    sdbusplus::match_rules::path(UPOWER_ROOT_PATH) +
+                    sdbusplus::match_rules::interface(UPOWER_INTERFACE) +
+                    sdbusplus::match_rules::member("DeviceAdded"),
+                [this](auto& msg) { deviceAdded(msg); }),
+    removedSignal(bus,
+                  sdbusplus::match_rules::type::signal() +
+                      sdbusplus::match_rules::path(UPOWER_ROOT_PATH) +
+                      sdbusplus::match_rules::interface(UPOWER_INTERFACE) +
+                      sdbusplus::match_rules::member("DeviceRemoved"),
+                  [this](auto& msg) { deviceRemoved(msg); })
+{}
+
+std::shared_ptr<UPowerDevices> UPowerDevices::shared(sdbusplus::bus_t& bus)
+{
+    static std::weak_ptr<UPowerDevices> instance;
+
+    auto devices = instance.lock();
+    if (!devices)
+    {
+        devices = std::make_shared<UPowerDevices>(bus);
+        instance = devices;
+    }
+    return devices;
+}
+
+bool UPowerDevices::claimLoad()
+{
+    if (loadClaimed)
+    {
+        return false;
+    }
+    loadClaimed = true;
+    return true;
+}
+
+void UPowerDevices::loadComplete()
+{
+    notify();
+}
+
+void UPowerDevices::subscribe(size_t id, Listener listener)
+{
+    listeners.insert_or_assign(id, std::move(listener));
+}
+
+void UPowerDevices::unsubscribe(size_t id)
+{
+    listeners.erase(id);
+}
+
+void UPowerDevices::notify()
+{
+    for (const auto& [id, listener] : listeners)
+    {
+        listener();
+    }
+}
+
+bool UPowerDevices::degraded(const Device& device)
+{
+    return device.isUPS && device.present &&
+           ((device.state != STATE_FULLY_CHARGED) ||
+            (device.batteryLevel != BATTERY_LVL_FULL));
+}
+
+void UPowerDevices::update(const std::string& path,
+                           const PowerInputProperties& properties)
+{
+    auto& device = devices[path];
+    const bool wasDegraded = degraded(device);
+
+    for (const auto& [property, value] : properties)
+    {
+        if (property == "Type")
+        {
+            if (const auto* type = std::get_if<uint>(&value))
+            {
+                device.isUPS = (*type == TYPE_UPS);
+            }
+        }
+        else if (property == "IsPresent")
+        {
+            if (const auto* present = std::get_if<bool>(&value))
+            {
+                device.present = *present;
+            }
+        }
+        else if (property == "State")
+        {
+            if (const auto* state = std::get_if<uint>(&value))
+            {
+                device.state = *state;
+            }
+        }
+        else if (property == "BatteryLevel")
+        {
+            if (const auto* level = std::get_if<uint>(&value))
+            {
+                device.batteryLevel = *level;
+            }
+        }
+    }
+
+    const bool isDegraded = degraded(device);
+    if (isDegraded == wasDegraded)
+    {
+        return;
+    }
+
+    if (isDegraded)
+    {
+        warning("UPS {OBJ_PATH} is not fully charged or battery level is low, "
+                "state: {UPS_STATE}, battery level: {UPS_BAT_LEVEL}",
+                "OBJ_PATH", path, "UPS_STATE", device.state, "UPS_BAT_LEVEL",
+                device.batteryLevel);
+        ++degradedUPSCount;
+    }
+    else
+    {
+        info("UPS {OBJ_PATH} is no longer degraded", "OBJ_PATH", path);
+        --degradedUPSCount;
+    }
+}
+
+void UPowerDevices::propertiesChanged(sdbusplus::message_t& msg)
+{
+    debug("UPS Property Change Event Triggered");
+    std::string statusInterface;
+    PowerInputProperties msgData;
+    msg.read(statusInterface, msgData);
+
+    std::string path = msg.get_path();
+
+    auto propertyMap = msgData.find("IsPresent");
+    if (propertyMap != msgData.end())
+    {
+        if (const auto* present = std::get_if<bool>(&propertyMap->second))
+        {
+            info("UPS presence changed to {UPS_PRES_INFO}", "UPS_PRES_INFO",
+                 *present);
+        }
+    }
+
+    propertyMap = msgData.find("State");
+    if (propertyMap != msgData.end())
+    {
+        if (const auto* state = std::get_if<uint>(&propertyMap->second))
+        {
+            info("UPS State changed to {UPS_STATE}", "UPS_STATE", *state);
+        }
+    }
+
+    propertyMap = msgData.find("BatteryLevel");
+    if (propertyMap != msgData.end())
+    {
+        if (const auto* level = std::get_if<uint>(&propertyMap->second))
+        {
+            info("UPS BatteryLevel changed to {UPS_BAT_LEVEL}",
+                 "UPS_BAT_LEVEL", *level);
+        }
+    }
+
+    // A device we haven't seen yet only reports the properties that changed,
+    // so read all of them once to know what kind of device it is. The reply
+    // includes this change and any other sent before it.
+    if (!devices.contains(path))
+    {
+        if (!deviceReads.contains(path))
+        {
+            readDevice(msg.get_sender(), path);
+        }
+        return;
+    }
+
+    update(path, msgData);
+    notify();
+}
+
+bool UPowerDevices::remove(const std::string& path)
+{
+    deviceReads.cancel(path);
+
+    auto device = devices.find(path);
+    if (device == devices.end())
+    {
+        return false;
+    }
+
+    if (degraded(device->second))
+    {
+        --degradedUPSCount;
+    }
+    devices.erase(device);
+    return true;
+}
+
+void UPowerDevices::readDevice(const std::string& service,
+                               const std::string& path)
+{
+    try
+    {
+        auto method = bus.new_method_call(service.c_str(), path.c_str(),
+                                          PROPERTY_INTERFACE, "GetAll");
+        method.append(UPowerDevice::interface);
+
+        deviceReads.call(path, method,
+                         [this, path](sdbusplus::message_t& reply) {
+                             deviceRead(path, reply);
+                         });
+    }
+    catch (const sdbusplus::exception_t& e)
+    {
+        error("Error reading UPS properties, error: {ERROR}, path: {PATH}",
+              "ERROR", e, "PATH", path);
+    }
+}
+
+void UPowerDevices::deviceRead(const std::string& path,
+                               sdbusplus::message_t& reply)
+{
+    if (reply.is_method_error())
+    {
+        const auto* e = reply.get_error();
+        error("Error reading UPS properties, error: {ERROR}, path: {PATH}",
+              "ERROR", (e && e->name) ? e->name : "", "PATH", path);
+        return;
+    }
+
+    try
+    {
+        update(path, reply.unpack<PowerInputProperties>());
+    }
+    catch (const sdbusplus::exception_t& e)
+    {
+        error("Bad UPS properties reply, error: {ERROR}, path: {PATH}",
+              "ERROR", e, "PATH", path);
+        return;
+    }
+    notify();
+}
+
+void UPowerDevices::deviceAdded(sdbusplus::message_t& msg)
+{
+    sdbusplus::object_path path;
+    msg.read(path);
+
+    info("UPower device {OBJ_PATH} added", "OBJ_PATH", path.str);
+    readDevice(msg.get_sender(), path.str);
+}
+
+void UPowerDevices::deviceRemoved(sdbusplus::message_t& msg)
+{
+    sdbusplus::object_path path;
+    msg.read(path);
+
+    if (remove(path.str))
+    {
+        info("UPower device {OBJ_PATH} removed", "OBJ_PATH", path.str);
+        notify();
+    }
+}
+
+} // namespace phosphor::state::manager
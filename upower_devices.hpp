@@ -0,0 +1,183 @@
+#pragma once
+
+#include "utils.hpp"
+
+#include <sdbusplus/bus.hpp>
+#include <sdbusplus/bus/match.hpp>
+
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <variant>
+
+namespace phosphor::state::manager
+{
+
+/** @brief Root of the UPower device objects */
+constexpr auto UPOWER_ROOT_PATH = "/org/freedesktop/UPower";
+
+/** @brief UPower daemon interface, which signals devices coming and going */
+constexpr auto UPOWER_INTERFACE = "org.freedesktop.UPower";
+
+/** @brief UPower Device and PowerSystemInputs properties */
+using PowerInputProperties =
+    std::map<std::string, std::variant<uint, bool, std::string>>;
+
+/** @class UPowerDevices
+ *  @brief Model of the UPower devices on D-Bus
+ *  @details UPower devices aren't tied to a chassis, so all the Chassis
+ *  objects of a process share one model and one set of signal matches.
+ *  The model is kept up to date from the signals once it has been loaded.
+ *  UPower announces devices with its own DeviceAdded and DeviceRemoved
+ *  signals rather than the ObjectManager ones, the properties of a new
+ *  device are read asynchronously.
+ */
+class UPowerDevices
+{
+  public:
+    /** @brief Called after a UPower signal updated the model */
+    using Listener = std::function<void()>;
+
+    UPowerDevices() = delete;
+    UPowerDevices(const UPowerDevices&) = delete;
+    UPowerDevices& operator=(const UPowerDevices&) = delete;
+    UPowerDevices(UPowerDevices&&) = delete;
+    UPowerDevices& operator=(UPowerDevices&&) = delete;
+    ~UPowerDevices() = default;
+
+    /** @brief Constructs the model and starts watching UPower signals
+     *
+     * @param[in] bus       - The Dbus bus object
+     */
+    explicit UPowerDevices(sdbusplus::bus_t& bus);
+
+    /** @brief Get the model shared by this process, created on first use
+     *
+     * @param[in] bus       - The Dbus bus object
+     */
+    static std::shared_ptr<UPowerDevices> shared(sdbusplus::bus_t& bus);
+
+    /** @brief Claim loading the devices currently on D-Bus
+     *
+     * @return true for the first caller only, which must load them
+     */
+    bool claimLoad();
+
+    /** @brief Notify the listeners once the claimed load completed
+     *
+     *  Listeners registered while the devices were loading see the whole
+     *  model from then on.
+     */
+    void loadComplete();
+
+    /** @brief Update a device in the model
+     *
+     * @param[in] path       - Object path of the device
+     * @param[in] properties - Properties to update, others are kept
+     */
+    void update(const std::string& path,
+                const PowerInputProperties& properties);
+
+    /** @brief Remove a device from the model, no-op if it isn't in it
+     *
+     * @param[in] path       - Object path of the device
+     *
+     * @return true if the device was in the model
+     */
+    bool remove(const std::string& path);
+
+    /** @brief Number of present UPS devices that aren't fully charged */
+    size_t degradedCount() const
+    {
+        return degradedUPSCount;
+    }
+
+    /** @brief Register a listener for model changes
+     *
+     * @param[in] id        - Key of the listener, such as the chassis id
+     * @param[in] listener  - Called after each change
+     */
+    void subscribe(size_t id, Listener listener);
+
+    /** @brief Drop a listener registered with subscribe()
+     *
+     * @param[in] id        - Key of the listener
+     */
+    void unsubscribe(size_t id);
+
+  private:
+    /** @brief Model of a UPower device */
+    struct Device
+    {
+        bool isUPS = false;
+        bool present = false;
+        uint state = 0;
+        uint batteryLevel = 0;
+    };
+
+    /** @brief Determine if a UPS device keeps power status from being Good
+     *
+     *  @param[in] device     - The UPS device
+     *
+     *  @return true if the device is a present UPS that is not fully charged
+     *          or whose battery is not full
+     */
+    static bool degraded(const Device& device);
+
+    /** @brief Process UPS property changes */
+    void propertiesChanged(sdbusplus::message_t& msg);
+
+    /** @brief Process the UPower DeviceAdded signal */
+    void deviceAdded(sdbusplus::message_t& msg);
+
+    /** @brief Process the UPower DeviceRemoved signal */
+    void deviceRemoved(sdbusplus::message_t& msg);
+
+    /** @brief Read all the properties of a device into the model
+     *
+     * @param[in] service    - Service hosting the device
+     * @param[in] path       - Object path of the device
+     */
+    void readDevice(const std::string& service, const std::string& path);
+
+    /** @brief Process the reply to readDevice()
+     *
+     * @param[in] path       - Object path of the device
+     * @param[in] reply      - The GetAll reply or error
+     */
+    void deviceRead(const std::string& path, sdbusplus::message_t& reply);
+
+    /** @brief Call every listener */
+    void notify();
+
+    /** @brief Persistent sdbusplus DBus connection. */
+    sdbusplus::bus_t& bus;
+
+    /** @brief UPower devices keyed by object path. **/
+    std::map<std::string, Device> devices;
+
+    /** @brief Number of entries in devices that are degraded. **/
+    size_t degradedUPSCount = 0;
+
+    /** @brief A caller of claimLoad() is loading the devices. **/
+    bool loadClaimed = false;
+
+    /** @brief Listeners keyed by id. **/
+    std::map<size_t, Listener> listeners;
+
+    /** @brief Property reads of new devices keyed by object path. **/
+    utils::PendingCalls<std::string> deviceReads;
+
+    /** @brief Watch for any changes to UPS properties **/
+    sdbusplus::match propChangedSignal;
+
+    /** @brief Watch for UPower devices being added **/
+    sdbusplus::match addedSignal;
+
+    /** @brief Watch for UPower devices being removed **/
+    sdbusplus::match removedSignal;
+};
+
+} // namespace phosphor::state::manager
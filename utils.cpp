@@ -2,7 +2,8 @@
 
 #include "utils.hpp"
 
-#include <gpiod.h>
+#include "gpio_service.hpp"
+#include "statistics.hpp"
 
 #include <phosphor-logging/lg2.hpp>
 #include <xyz/openbmc_project/Dump/Create/client.hpp>
@@ -14,6 +15,8 @@
 #include <chrono>
 #include <filesystem>
 #include <format>
+#include <set>
+#include <tuple>
 
 namespace phosphor::state::manager::utils
 {
@@ -31,6 +34,15 @@ constexpr auto ACTIVATING_STATE = "activating";
 
 void subscribeToSystemdSignals(sdbusplus::bus_t& bus)
 {
+    // The subscription is per connection, so objects sharing a connection
+    // only need to subscribe once
+    static std::set<sd_bus*> subscribedBuses;
+    if (subscribedBuses.contains(bus.get()))
+    {
+        return;
+    }
+
+    auto phase = StartupTimer::instance().phase("subscribe");
     auto method = bus.new_method_call(SYSTEMD_SERVICE, SYSTEMD_OBJ_PATH,
                                       SYSTEMD_MANAGER_INTERFACE, "Subscribe");
 
@@ -48,6 +60,7 @@ void subscribeToSystemdSignals(sdbusplus::bus_t& bus)
         error("Failed to subscribe to systemd signals: {ERROR}", "ERROR", e);
         throw std::runtime_error("Unable to subscribe to systemd signals");
     }
+    subscribedBuses.insert(bus.get());
     return;
 }
 
@@ -150,26 +163,7 @@ void setProperty(sdbusplus::bus_t& bus, const std::string& path,
 
 int getGpioValue(const std::string& gpioName)
 {
-    int gpioval = -1;
-    gpiod_line* line = gpiod_line_find(gpioName.c_str());
-
-    if (nullptr != line)
-    {
-        // take ownership of gpio
-        if (0 != gpiod_line_request_input(line, "state-manager"))
-        {
-            error("Failed request for {GPIO_NAME} GPIO", "GPIO_NAME", gpioName);
-        }
-        else
-        {
-            // get gpio value
-            gpioval = gpiod_line_get_value(line);
-
-            // release ownership of gpio
-            gpiod_line_close_chip(line);
-        }
-    }
-    return gpioval;
+    return GpioService::instance().getValue(gpioName);
 }
 
 void createError(
@@ -349,4 +343,150 @@ bool stateActive(sdbusplus::bus_t& bus, const std::string& target)
            currentStateStr == ACTIVATING_STATE;
 }
 
+std::string unitObjectPath(const std::string& unit)
+{
+    // object_path's '/' operator uses sd_bus_path_encode, which is the
+    // escaping systemd uses for its unit objects
+    return (sdbusplus::object_path(SYSTEMD_OBJ_PATH) / "unit" / unit).str;
+}
+
+void UnitStateCache::track(const std::string& unit)
+{
+    if (units.contains(unit))
+    {
+        return;
+    }
+
+    auto& entry = units[unit];
+
+    // Install the match before reading the state so no change is missed
+    entry.match = std::make_unique<sdbusplus::match>(
+        bus,
+        sdbusplus::match_rules::propertiesChanged(unitObjectPath(unit),
+                                                        SYSTEMD_UNIT_INTERFACE),
+        [this, unit](sdbusplus::message_t& msg) {
+            std::string interface;
+            std::map<std::string, std::variant<std::string>> properties;
+
+            try
+            {
+                msg.read(interface, properties);
+            }
+            catch (const sdbusplus::exception_t& e)
+            {
+                error("Bad PropertiesChanged for unit {UNIT}: {ERROR}", "UNIT",
+                      unit, "ERROR", e);
+                return;
+            }
+
+            auto state = properties.find("ActiveState");
+            if ((state != properties.end()) &&
+                std::holds_alternative<std::string>(state->second))
+            {
+                units[unit].activeState =
+                    std::get<std::string>(state->second);
+            }
+        });
+
+    entry.activeState = readActiveState(unit);
+}
+
+const std::string& UnitStateCache::activeState(const std::string& unit)
+{
+    track(unit);
+    return units[unit].activeState;
+}
+
+bool UnitStateCache::stateActive(const std::string& unit)
+{
+    const auto& state = activeState(unit);
+    return state == ACTIVE_STATE || state == ACTIVATING_STATE;
+}
+
+std::string UnitStateCache::readActiveState(const std::string& unit)
+{
+    auto method = bus.new_method_call(SYSTEMD_SERVICE,
+                                      unitObjectPath(unit).c_str(),
+                                      PROPERTY_INTERFACE, "Get");
+    method.append(SYSTEMD_UNIT_INTERFACE, "ActiveState");
+
+    try
+    {
+        auto result = bus.call(method);
+        return std::get<std::string>(result.unpack<std::variant<std::string>>());
+    }
+    catch (const sdbusplus::exception_t& e)
+    {
+        // Not all units will have been loaded yet, the PropertiesChanged
+        // signal fills the state in once they are
+        debug("Unit {UNIT} state not available: {ERROR}", "UNIT", unit,
+              "ERROR", e);
+    }
+    return std::string{};
+}
+
+void SystemdJobSignals::watch(const std::string& unit)
+{
+    if (matches.contains(unit))
+    {
+        return;
+    }
+
+    namespace rules = sdbusplus::match_rules;
+    matches.emplace(
+        std::piecewise_construct, std::forward_as_tuple(unit),
+        std::forward_as_tuple(
+            bus,
+            rules::type::signal() + rules::member(member) +
+                rules::path(SYSTEMD_OBJ_PATH) +
+                rules::interface(SYSTEMD_MANAGER_INTERFACE) +
+                rules::argN(2, unit),
+            [this](sdbusplus::message_t& msg) { dispatch(msg); }));
+}
+
+void SystemdJobSignals::dispatch(sdbusplus::message_t& msg)
+{
+    ++receivedCount;
+
+    std::weak_ptr<bool> token = alive;
+    auto acted = handler(msg);
+    if (token.expired())
+    {
+        return;
+    }
+
+    if (acted)
+    {
+        ++handledCount;
+    }
+
+    debug("Systemd {MEMBER} signals received: {RECEIVED}, acted on: {HANDLED}",
+          "MEMBER", member, "RECEIVED", receivedCount, "HANDLED",
+          handledCount);
+}
+
+void UnitJobs::queued(const std::string& unit, const std::string& job)
+{
+    jobs.insert_or_assign(unit, job);
+}
+
+std::optional<std::string> UnitJobs::removed(const std::string& unit,
+                                             const std::string& job,
+                                             const std::string& result)
+{
+    auto iter = jobs.find(unit);
+    if ((iter == jobs.end()) || (iter->second != job))
+    {
+        return std::nullopt;
+    }
+
+    jobs.erase(iter);
+    return result;
+}
+
+bool UnitJobs::pending(const std::string& unit) const
+{
+    return jobs.contains(unit);
+}
+
 } // namespace phosphor::state::manager::utils
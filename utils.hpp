@@ -3,8 +3,18 @@
 #include "config.h"
 
 #include <sdbusplus/bus.hpp>
+#include <sdbusplus/bus/match.hpp>
+#include <sdbusplus/slot.hpp>
 #include <xyz/openbmc_project/Logging/Entry/server.hpp>
 
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
 constexpr auto PROPERTY_INTERFACE = "org.freedesktop.DBus.Properties";
 
 constexpr auto SYSTEMD_SERVICE = "org.freedesktop.systemd1";
@@ -16,6 +26,8 @@ namespace phosphor::state::manager::utils
 {
 
 /** @brief Tell systemd to generate d-bus events
+ *
+ * Only the first call for a bus connection sends the request.
  *
  * @param[in] bus          - The Dbus bus object
  *
@@ -60,6 +72,8 @@ void setProperty(sdbusplus::bus_t& bus, const std::string& path,
                  const std::string& value);
 
 /** @brief Return the value of the input GPIO
+ *
+ * The line is looked up through the shared GpioService cache.
  *
  * @param[in] gpioName          - The name of the GPIO to read
  *
@@ -120,4 +134,271 @@ bool isFirmwareUpdating(sdbusplus::bus_t& bus);
  */
 bool stateActive(sdbusplus::bus_t& bus, const std::string& target);
 
+/** @brief Get the systemd object path of a unit
+ *
+ * Escapes the unit name the same way systemd does, so the path can be used
+ * without a GetUnit call.
+ *
+ * @param[in] unit         - The systemd unit name
+ *
+ * @return The D-Bus object path of the unit
+ */
+std::string unitObjectPath(const std::string& unit);
+
+/** @class UnitStateCache
+ *  @brief Cache of systemd unit ActiveState values
+ *  @details The ActiveState of each tracked unit is read once and then kept
+ *  up to date from the unit PropertiesChanged signals, so state checks in
+ *  JobRemoved handlers don't need any D-Bus calls. Systemd sends pending
+ *  unit property changes before the JobRemoved signal of a job on that
+ *  unit, so the cached value is current when the JobRemoved is handled.
+ *  Requires systemd signals to be subscribed to.
+ */
+class UnitStateCache
+{
+  public:
+    /** @brief Constructs the cache
+     *
+     * @param[in] bus          - The Dbus bus object
+     */
+    explicit UnitStateCache(sdbusplus::bus_t& bus) : bus(bus) {}
+
+    /** @brief Start tracking a unit, no-op if already tracked
+     *
+     * @param[in] unit         - The systemd unit name
+     */
+    void track(const std::string& unit);
+
+    /** @brief Get the ActiveState of a unit, tracking it if not yet tracked
+     *
+     * @param[in] unit         - The systemd unit name
+     *
+     * @return The unit ActiveState, or an empty string if it is unknown
+     */
+    const std::string& activeState(const std::string& unit);
+
+    /** @brief Determine if a systemd unit is active or activating
+     *
+     * @param[in] unit         - The systemd unit name
+     *
+     * @return true when the unit ActiveState is active or activating
+     */
+    bool stateActive(const std::string& unit);
+
+  private:
+    /** @brief Cached state of a single unit */
+    struct Unit
+    {
+        std::string activeState;
+        std::unique_ptr<sdbusplus::match> match;
+    };
+
+    /** @brief Read the current ActiveState of a unit from systemd */
+    std::string readActiveState(const std::string& unit);
+
+    /** @brief The Dbus bus object */
+    sdbusplus::bus_t& bus;
+
+    /** @brief Tracked units */
+    std::map<std::string, Unit> units;
+};
+
+/** @class SystemdJobSignals
+ *  @brief Systemd JobNew/JobRemoved signal matches filtered on unit name
+ *  @details One match is installed per watched unit with an arg2 (unit name)
+ *  filter, so the bus only delivers the job signals of units the owner
+ *  cares about instead of every job in the system. Counts of received and
+ *  acted on signals are kept for debug.
+ */
+class SystemdJobSignals
+{
+  public:
+    /** @brief Signal handler, returns true if the signal was acted on */
+    using Handler = std::function<bool(sdbusplus::message_t&)>;
+
+    /** @brief Constructs the signal matcher
+     *
+     * @param[in] bus          - The Dbus bus object
+     * @param[in] member       - Systemd manager signal, JobNew or JobRemoved
+     * @param[in] handler      - Called for each delivered signal
+     */
+    SystemdJobSignals(sdbusplus::bus_t& bus, const std::string& member,
+                      Handler handler) :
+        bus(bus), member(member), handler(std::move(handler))
+    {}
+
+    /** @brief Deliver signals for a unit, no-op if already watched
+     *
+     * @param[in] unit         - The systemd unit name
+     */
+    void watch(const std::string& unit);
+
+    /** @brief Number of signals delivered by the bus */
+    uint64_t received() const
+    {
+        return receivedCount;
+    }
+
+    /** @brief Number of signals the handler acted on */
+    uint64_t handled() const
+    {
+        return handledCount;
+    }
+
+  private:
+    /** @brief Count and dispatch a delivered signal */
+    void dispatch(sdbusplus::message_t& msg);
+
+    /** @brief The Dbus bus object */
+    sdbusplus::bus_t& bus;
+
+    /** @brief Systemd manager signal name */
+    const std::string member;
+
+    /** @brief Signal handler */
+    Handler handler;
+
+    /** @brief Matches keyed by unit name */
+    std::map<std::string, sdbusplus::match> matches;
+
+    /** @brief Number of signals delivered by the bus */
+    uint64_t receivedCount = 0;
+
+    /** @brief Number of signals the handler acted on */
+    uint64_t handledCount = 0;
+
+    /** @brief Expires when this object is destroyed, the handler is allowed
+     *         to destroy its owner */
+    std::shared_ptr<bool> alive = std::make_shared<bool>(true);
+};
+
+/** @class PendingCalls
+ *  @brief Asynchronous method calls waiting for their reply
+ *  @details Owns the slot of each call, so destroying the owner cancels the
+ *  calls it still waits on. A call is removed before its reply handler runs,
+ *  which is safe as sd-bus holds its own reference to the slot while the
+ *  handler runs.
+ */
+template <typename Key>
+class PendingCalls
+{
+  public:
+    /** @brief Reply handler, called with the reply or error */
+    using Handler = std::function<void(sdbusplus::message_t&)>;
+
+    /** @brief Send a call, cancelling any pending call with the same key
+     *
+     * @param[in] key          - Key of the call
+     * @param[in] method       - The method call to send
+     * @param[in] handler      - Reply handler
+     *
+     * @return void, will throw exception if the call can't be sent
+     */
+    void call(const Key& key, sdbusplus::message_t& method, Handler handler)
+    {
+        auto slot = method.call_async(
+            [this, key, handler = std::move(handler)](
+                sdbusplus::message_t reply) {
+                calls.erase(key);
+                handler(reply);
+            });
+        calls.insert_or_assign(key, std::move(slot));
+    }
+
+    /** @brief Cancel a pending call, no-op if there is none */
+    void cancel(const Key& key)
+    {
+        calls.erase(key);
+    }
+
+    /** @brief Cancel all pending calls */
+    void clear()
+    {
+        calls.clear();
+    }
+
+    /** @brief Determine if a call with the key is pending */
+    bool contains(const Key& key) const
+    {
+        return calls.contains(key);
+    }
+
+    /** @brief Determine if no call is pending */
+    bool empty() const
+    {
+        return calls.empty();
+    }
+
+    /** @brief Number of pending calls */
+    size_t size() const
+    {
+        return calls.size();
+    }
+
+    /** @brief Keys of the pending calls, in order */
+    std::vector<Key> keys() const
+    {
+        std::vector<Key> pending;
+        pending.reserve(calls.size());
+        for (const auto& [key, slot] : calls)
+        {
+            pending.push_back(key);
+        }
+        return pending;
+    }
+
+  private:
+    /** @brief Slots of the pending calls */
+    std::map<Key, sdbusplus::slot_t> calls;
+};
+
+/** @class UnitJobs
+ *  @brief Systemd jobs queued by this object, keyed by unit name
+ *  @details Correlates the JobRemoved signals with the jobs that were
+ *  queued, so only the outcome of the object's own job on a unit is acted
+ *  on. A newer job on the same unit replaces the older one.
+ */
+class UnitJobs
+{
+  public:
+    /** @brief Record the job queued for a unit
+     *
+     * @param[in] unit         - The systemd unit name
+     * @param[in] job          - The job object path
+     */
+    void queued(const std::string& unit, const std::string& job);
+
+    /** @brief Handle the removal of a job
+     *
+     * @param[in] unit         - The systemd unit name
+     * @param[in] job          - The job object path
+     * @param[in] result       - The job result from JobRemoved
+     *
+     * @return The result if the job is the one queued for the unit,
+     *         std::nullopt otherwise
+     */
+    std::optional<std::string> removed(const std::string& unit,
+                                       const std::string& job,
+                                       const std::string& result);
+
+    /** @brief Determine if a job queued for the unit didn't finish yet
+     *
+     * @param[in] unit         - The systemd unit name
+     */
+    bool pending(const std::string& unit) const;
+
+    /** @brief Determine if a job result means the job succeeded
+     *
+     * @param[in] result       - The job result from JobRemoved
+     */
+    static bool succeeded(const std::string& result)
+    {
+        return result == "done";
+    }
+
+  private:
+    /** @brief Job object paths keyed by unit name */
+    std::map<std::string, std::string> jobs;
+};
+
 } // namespace phosphor::state::manager::utils